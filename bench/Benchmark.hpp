@@ -0,0 +1,216 @@
+#pragma once
+
+/**
+ * @file Benchmark.hpp
+ * @brief Minimal host benchmark harness
+ * @details Times a callable over a number of samples, tracks heap allocations made while it
+ * runs and prints one table row per benchmark. A benchmark fails when it exceeds its own
+ * budget, derived from a baseline file, or the ns/sample budget given on the command line,
+ * so the suite can gate a release.
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    // Heap usage, maintained by the global operator new/delete in main.cpp
+    extern size_t allocatedBytes;
+    extern size_t peakAllocatedBytes;
+
+    struct Result
+    {
+        char const *name;
+        uint64_t samples;
+        uint64_t events;
+        double seconds;
+        size_t bytesPerButton;
+    };
+
+    inline std::vector<Result> &results()
+    {
+        static std::vector<Result> all;
+        return all;
+    }
+
+    // ns/sample of one benchmark on the reference machine, read from the baseline file
+    struct Baseline
+    {
+        std::string name;
+        double nsPerSample;
+    };
+
+    struct Options
+    {
+        double maxNsPerSample = 0;            // Budget of every benchmark, 0 disables it
+        std::vector<Baseline> baselines;      // Budget of each benchmark, empty without a baseline file
+        double tolerance = 2;                 // Slowdown allowed against the baseline
+        char const *baselineOutput = nullptr; // File receiving the results as a new baseline, if any
+    };
+
+    inline Options &options()
+    {
+        static Options all;
+        return all;
+    }
+
+    /**
+     * @brief Keeps a value, and the work it depends on, from being optimized out.
+     *
+     * @details The compiler must assume the empty assembly reads the value and any memory, so
+     * neither the stores leading to it nor the loops computing it can be dropped or moved past
+     * the clock reads.
+     */
+    template <typename T>
+    inline void doNotOptimize(T const &value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * @brief Runs and reports one benchmark.
+     *
+     * @param name Name of the benchmark.
+     * @param buttons Number of button instances the callable drives, used to report memory per button.
+     * @param stateBytes Bytes of state owned by each button instance.
+     * @param run Callable returning the number of samples processed and storing the number of events.
+     */
+    template <typename Run>
+    void run(char const *name, size_t buttons, size_t stateBytes, Run run)
+    {
+        size_t heapBefore = allocatedBytes;
+        peakAllocatedBytes = allocatedBytes;
+
+        uint64_t events = 0;
+        auto start = std::chrono::steady_clock::now();
+        doNotOptimize(events);
+        uint64_t samples = run(events);
+        doNotOptimize(samples);
+        doNotOptimize(events);
+        auto end = std::chrono::steady_clock::now();
+
+        Result result;
+        result.name = name;
+        result.samples = samples;
+        result.events = events;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        result.bytesPerButton = stateBytes + (peakAllocatedBytes - heapBefore) / (buttons ? buttons : 1);
+        results().push_back(result);
+
+        printf("%-36s %10.2f ns/sample %10.2f Msample/s %12.0f events/s %6zu B/button\n",
+               result.name,
+               result.seconds * 1e9 / result.samples,
+               result.samples / result.seconds / 1e6,
+               result.events / result.seconds,
+               result.bytesPerButton);
+    }
+
+    /**
+     * @brief Reads the baseline file, one `<name> <ns/sample>` line per benchmark.
+     *
+     * @return true if the file was read.
+     */
+    inline bool readBaseline(char const *path)
+    {
+        FILE *file = fopen(path, "r");
+        if (file == nullptr)
+            return false;
+        char line[160];
+        char name[128];
+        double nsPerSample;
+        while (fgets(line, sizeof(line), file) != nullptr)
+            if (line[0] != '#' && sscanf(line, "%127s %lf", name, &nsPerSample) == 2)
+                options().baselines.push_back(Baseline{name, nsPerSample});
+        fclose(file);
+        return true;
+    }
+
+    /**
+     * @brief Parses the command line options shared by all benchmarks.
+     *
+     * @details
+     * - `--baseline=<file>` fails the run if any benchmark is slower than its baseline times
+     *   the tolerance, or has no baseline.
+     * - `--tolerance=<x>` sets that tolerance, 2 by default.
+     * - `--write-baseline=<file>` writes the results of this run as a new baseline.
+     * - `--max-ns=<n>` fails the run if any benchmark takes more than n ns/sample.
+     */
+    inline void parseArguments(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strncmp(argv[i], "--max-ns=", 9) == 0)
+                options().maxNsPerSample = atof(argv[i] + 9);
+            else if (strncmp(argv[i], "--tolerance=", 12) == 0)
+                options().tolerance = atof(argv[i] + 12);
+            else if (strncmp(argv[i], "--write-baseline=", 17) == 0)
+                options().baselineOutput = argv[i] + 17;
+            else if (strncmp(argv[i], "--baseline=", 11) == 0 && !readBaseline(argv[i] + 11))
+            {
+                printf("Cannot read baseline %s\n", argv[i] + 11);
+                exit(1);
+            }
+        }
+    }
+
+    /**
+     * @brief Checks every result against its budget, and writes the new baseline if asked.
+     *
+     * @details A benchmark may take its baseline times the tolerance, and at least 1 ns/sample
+     * more than its baseline so that the sub-nanosecond rows do not fail on timer noise.
+     *
+     * @return 0 if all benchmarks are within budget, 1 otherwise.
+     */
+    inline int checkBudget()
+    {
+        Options const &budget = options();
+        FILE *output = budget.baselineOutput != nullptr ? fopen(budget.baselineOutput, "w") : nullptr;
+        if (output != nullptr)
+            fprintf(output, "# <benchmark> <ns/sample>, written by --write-baseline\n");
+
+        int status = 0;
+        for (Result const &result : results())
+        {
+            double nsPerSample = result.seconds * 1e9 / result.samples;
+            if (output != nullptr)
+                fprintf(output, "%s %.2f\n", result.name, nsPerSample);
+            if (budget.maxNsPerSample > 0 && nsPerSample > budget.maxNsPerSample)
+            {
+                printf("FAILED %s: %.2f ns/sample exceeds budget of %.2f\n", result.name, nsPerSample, budget.maxNsPerSample);
+                status = 1;
+            }
+            if (budget.baselines.empty())
+                continue;
+
+            Baseline const *baseline = nullptr;
+            for (Baseline const &candidate : budget.baselines)
+                if (candidate.name == result.name)
+                    baseline = &candidate;
+            if (baseline == nullptr)
+            {
+                printf("FAILED %s: no baseline\n", result.name);
+                status = 1;
+                continue;
+            }
+            double limit = baseline->nsPerSample * budget.tolerance;
+            if (limit < baseline->nsPerSample + 1)
+                limit = baseline->nsPerSample + 1;
+            if (nsPerSample > limit)
+            {
+                printf("FAILED %s: %.2f ns/sample exceeds budget of %.2f, baseline %.2f\n",
+                       result.name, nsPerSample, limit, baseline->nsPerSample);
+                status = 1;
+            }
+        }
+        if (output != nullptr)
+            fclose(output);
+        return status;
+    }
+} // namespace bench
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonBank.hpp"
+#include "ButtonGroup.hpp"
+#include "ButtonStateMachine.hpp"
+
+#define BANK_BENCH_BUTTONS 4096
+#define BANK_BENCH_WORDS (BANK_BENCH_BUTTONS / 32)
+
+// Pressed levels of every tick, one bit per button, each button replaying the trace at its own offset
+inline std::vector<uint32_t> bankBatches(Trace const &trace)
+{
+    std::vector<uint32_t> batches(trace.size() * BANK_BENCH_WORDS, 0);
+    for (size_t tick = 0; tick < trace.size(); tick++)
+        for (uint32_t button = 0; button < BANK_BENCH_BUTTONS; button++)
+            batches[tick * BANK_BENCH_WORDS + button / 32] |= uint32_t(trace[(tick + button * 37) % trace.size()]) << (button % 32);
+    return batches;
+}
+
+struct BankEventCounter
+{
+    uint64_t *events;
+
+    void operator()(uint16_t, ButtonStateMachine::Event) { (*events)++; }
+};
+
+inline uint64_t runStateMachineBatches(std::vector<uint32_t> const &batches, uint64_t &events)
+{
+    std::vector<ButtonStateMachine> stateMachines(BANK_BENCH_BUTTONS);
+    ButtonTimings timings;
+    size_t const ticks = batches.size() / BANK_BENCH_WORDS;
+
+    for (uint32_t now = 0; now < ticks; now++)
+    {
+        uint32_t const *pressed = &batches[now * BANK_BENCH_WORDS];
+        for (uint32_t button = 0; button < BANK_BENCH_BUTTONS; button++)
+            if (stateMachines[button].update(now, (pressed[button / 32] >> (button % 32)) & 1, timings, 0x07) != ButtonStateMachine::Event::NONE)
+                events++;
+    }
+    bench::doNotOptimize(stateMachines);
+    return uint64_t(ticks) * BANK_BENCH_BUTTONS;
+}
+
+inline uint64_t runGroupBatches(std::vector<uint32_t> const &batches, uint64_t &events)
+{
+    StaticButtonGroup<BANK_BENCH_BUTTONS> *group = new StaticButtonGroup<BANK_BENCH_BUTTONS>();
+    group->onEvent(BankEventCounter{&events});
+    size_t const ticks = batches.size() / BANK_BENCH_WORDS;
+
+    for (uint32_t now = 0; now < ticks; now++)
+        group->update(now, &batches[now * BANK_BENCH_WORDS]);
+
+    delete group;
+    return uint64_t(ticks) * BANK_BENCH_BUTTONS;
+}
+
+inline uint64_t runBankBatches(std::vector<uint32_t> const &batches, uint64_t &events)
+{
+    StaticButtonBank<BANK_BENCH_BUTTONS> *bank = new StaticButtonBank<BANK_BENCH_BUTTONS>();
+    bank->onEvent(BankEventCounter{&events});
+    size_t const ticks = batches.size() / BANK_BENCH_WORDS;
+
+    for (uint32_t now = 0; now < ticks; now++)
+        bank->update(now, &batches[now * BANK_BENCH_WORDS]);
+
+    delete bank;
+    return uint64_t(ticks) * BANK_BENCH_BUTTONS;
+}
+
+// Every sample batch is one timestamp and the levels of all 4096 buttons
+inline void benchmarkBank()
+{
+    struct
+    {
+        char const *name;
+        std::vector<uint32_t> batches;
+    } const workloads[] = {
+        {"idle", bankBatches(Trace(1450, 0))},
+        {"double", bankBatches(doublePressTrace())},
+        {"bounce", bankBatches(bouncePressTrace())},
+    };
+
+    for (auto const &workload : workloads)
+    {
+        static char names[3][3][48];
+        size_t const index = &workload - workloads;
+        snprintf(names[index][0], sizeof(names[index][0]), "ButtonStateMachine/4096/%s", workload.name);
+        snprintf(names[index][1], sizeof(names[index][1]), "ButtonGroup/4096/%s", workload.name);
+        snprintf(names[index][2], sizeof(names[index][2]), "ButtonBank/4096/%s", workload.name);
+
+        bench::run(names[index][0], BANK_BENCH_BUTTONS, 0,
+                   [&](uint64_t &events)
+                   { return runStateMachineBatches(workload.batches, events); });
+        bench::run(names[index][1], BANK_BENCH_BUTTONS, 0,
+                   [&](uint64_t &events)
+                   { return runGroupBatches(workload.batches, events); });
+        bench::run(names[index][2], BANK_BENCH_BUTTONS, 0,
+                   [&](uint64_t &events)
+                   { return runBankBatches(workload.batches, events); });
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "BitParallelDebouncer.hpp"
+#include "VerticalCounterDebouncer.hpp"
+
+#define DEBOUNCE_BENCH_LANES 32
+#define DEBOUNCE_BENCH_REPEATS 2000
+
+// One word per millisecond, every lane replaying the trace at its own offset
+inline std::vector<uint32_t> packTrace(Trace const &trace)
+{
+    std::vector<uint32_t> words(trace.size());
+    for (size_t tick = 0; tick < trace.size(); tick++)
+        for (uint8_t lane = 0; lane < DEBOUNCE_BENCH_LANES; lane++)
+            words[tick] |= uint32_t(trace[(tick + lane * 37) % trace.size()]) << lane;
+    return words;
+}
+
+// Events are the debounced level changes of all lanes
+template <typename Debouncer>
+inline uint64_t runDebouncer(Debouncer &debouncer, std::vector<uint32_t> const &words, uint64_t &events)
+{
+    for (uint32_t repeat = 0; repeat < DEBOUNCE_BENCH_REPEATS; repeat++)
+        for (uint32_t word : words)
+            events += __builtin_popcount(debouncer.update(word));
+    bench::doNotOptimize(debouncer);
+    return uint64_t(DEBOUNCE_BENCH_REPEATS) * words.size() * DEBOUNCE_BENCH_LANES;
+}
+
+inline void benchmarkDebounce()
+{
+    std::vector<uint32_t> const words = packTrace(bouncePressTrace());
+
+    bench::run("BitParallelDebouncer/bounce/2", DEBOUNCE_BENCH_LANES, sizeof(BitParallelDebouncer<uint32_t, 2>) / DEBOUNCE_BENCH_LANES,
+               [&](uint64_t &events)
+               {
+                   BitParallelDebouncer<uint32_t, 2> debouncer;
+                   return runDebouncer(debouncer, words, events);
+               });
+    bench::run("BitParallelDebouncer/bounce/8", DEBOUNCE_BENCH_LANES, sizeof(BitParallelDebouncer<uint32_t, 8>) / DEBOUNCE_BENCH_LANES,
+               [&](uint64_t &events)
+               {
+                   BitParallelDebouncer<uint32_t, 8> debouncer;
+                   return runDebouncer(debouncer, words, events);
+               });
+    bench::run("VerticalCounterDebouncer/bounce/8", DEBOUNCE_BENCH_LANES, sizeof(VerticalCounterDebouncer<uint32_t>) / DEBOUNCE_BENCH_LANES,
+               [&](uint64_t &events)
+               {
+                   VerticalCounterDebouncer<uint32_t> debouncer(8);
+                   return runDebouncer(debouncer, words, events);
+               });
+    bench::run("VerticalCounterDebouncer/bounce/15", DEBOUNCE_BENCH_LANES, sizeof(VerticalCounterDebouncer<uint32_t>) / DEBOUNCE_BENCH_LANES,
+               [&](uint64_t &events)
+               {
+                   VerticalCounterDebouncer<uint32_t> debouncer(15);
+                   return runDebouncer(debouncer, words, events);
+               });
+}
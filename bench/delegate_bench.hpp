@@ -0,0 +1,104 @@
+#pragma once
+
+#include <functional>
+
+#include "Benchmark.hpp"
+
+#include "ButtonDelegate.hpp"
+
+#define DELEGATE_BENCH_CALLBACKS 64
+#define DELEGATE_BENCH_REPEATS 100000
+
+// The context of every callback: a counter and how much to add to it
+struct DelegateBenchContext
+{
+    uint64_t *counter;
+    uint32_t step;
+};
+
+inline void delegateBenchAdd(void *parameter)
+{
+    DelegateBenchContext *context = static_cast<DelegateBenchContext *>(parameter);
+    *context->counter += context->step;
+}
+
+// Calls every callback of the table in turn, half of them through another target
+template <typename Callback, typename Call>
+inline uint64_t runCallbacks(Callback const *callbacks, Call call)
+{
+    for (uint32_t repeat = 0; repeat < DELEGATE_BENCH_REPEATS; repeat++)
+        for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+            call(callbacks[i]);
+    return uint64_t(DELEGATE_BENCH_REPEATS) * DELEGATE_BENCH_CALLBACKS;
+}
+
+// Cost of storing and calling a callback with a two word context: the raw function pointer and
+// parameter pair, whose context lives elsewhere, usually on the heap; a ButtonDelegate holding
+// it inline; and a std::function, which allocates once the context exceeds its small buffer
+inline void benchmarkDelegate()
+{
+    bench::run("callback/pointer+parameter", DELEGATE_BENCH_CALLBACKS,
+               sizeof(void (*)(void *)) + sizeof(void *),
+               [](uint64_t &events)
+               {
+                   struct RawCallback
+                   {
+                       void (*function)(void *);
+                       void *parameter;
+                   } callbacks[DELEGATE_BENCH_CALLBACKS];
+                   for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+                       callbacks[i] = {delegateBenchAdd, new DelegateBenchContext{&events, uint32_t(i & 1)}};
+
+                   uint64_t samples = runCallbacks(callbacks, [](RawCallback const &callback)
+                                                   { callback.function(callback.parameter); });
+                   for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+                       delete static_cast<DelegateBenchContext *>(callbacks[i].parameter);
+                   return samples;
+               });
+
+    bench::run("callback/ButtonDelegate", DELEGATE_BENCH_CALLBACKS, sizeof(ButtonCallback),
+               [](uint64_t &events)
+               {
+                   ButtonCallback callbacks[DELEGATE_BENCH_CALLBACKS];
+                   uint64_t *counter = &events;
+                   for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+                   {
+                       uint32_t step = i & 1;
+                       callbacks[i] = [counter, step]
+                       { *counter += step; };
+                   }
+                   return runCallbacks(callbacks, [](ButtonCallback const &callback)
+                                       { callback(); });
+               });
+
+    bench::run("callback/std::function", DELEGATE_BENCH_CALLBACKS, sizeof(std::function<void()>),
+               [](uint64_t &events)
+               {
+                   std::function<void()> callbacks[DELEGATE_BENCH_CALLBACKS];
+                   uint64_t *counter = &events;
+                   for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+                   {
+                       uint32_t step = i & 1;
+                       callbacks[i] = [counter, step]
+                       { *counter += step; };
+                   }
+                   return runCallbacks(callbacks, [](std::function<void()> const &callback)
+                                       { callback(); });
+               });
+
+    bench::run("callback/std::function/large", DELEGATE_BENCH_CALLBACKS, sizeof(std::function<void()>),
+               [](uint64_t &events)
+               {
+                   std::function<void()> callbacks[DELEGATE_BENCH_CALLBACKS];
+                   uint64_t *counter = &events;
+                   for (size_t i = 0; i < DELEGATE_BENCH_CALLBACKS; i++)
+                   {
+                       // One word over the small buffer of libstdc++
+                       uint64_t step = i & 1, unused = 0, spare = 0;
+                       callbacks[i] = [counter, step, unused, spare]
+                       { *counter += step + unused + spare; };
+                   }
+                   return runCallbacks(callbacks, [](std::function<void()> const &callback)
+                                       { callback(); });
+               });
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "GestureEngine.hpp"
+
+#define GESTURE_BENCH_BUTTONS 64
+#define GESTURE_BENCH_REPEATS 200
+
+// Feeds the trace to every button, each one starting at a different offset
+inline uint64_t runGestureTrace(GestureTable const &table, Trace const &trace, uint64_t &events)
+{
+    GestureEngine engines[GESTURE_BENCH_BUTTONS];
+    size_t const length = trace.size();
+    uint32_t now = 0;
+
+    for (uint32_t repeat = 0; repeat < GESTURE_BENCH_REPEATS; repeat++)
+    {
+        for (size_t i = 0; i < length; i++, now++)
+        {
+            for (size_t button = 0; button < GESTURE_BENCH_BUTTONS; button++)
+            {
+                bool pressed = trace[(i + button * 37) % length];
+                if (engines[button].update(now, pressed, table) != GestureTable::NO_GESTURE)
+                    events++;
+            }
+        }
+    }
+    bench::doNotOptimize(engines);
+    return uint64_t(GESTURE_BENCH_REPEATS) * length * GESTURE_BENCH_BUTTONS;
+}
+
+// The cost per sample must not grow with the number of gestures in the table
+inline void benchmarkGesture()
+{
+    GestureDefinition const oneGesture[] = {
+        {GestureDefinition::Type::TAPS, 1},
+    };
+    GestureDefinition const manyGestures[] = {
+        {GestureDefinition::Type::TAPS, 1},
+        {GestureDefinition::Type::TAPS, 2},
+        {GestureDefinition::Type::TAPS, 3},
+        {GestureDefinition::Type::TAPS, 4},
+        {GestureDefinition::Type::TAPS_THEN_HOLD, 0},
+        {GestureDefinition::Type::TAPS_THEN_HOLD, 1},
+        {GestureDefinition::Type::TAPS_THEN_HOLD, 2},
+        {GestureDefinition::Type::REPEAT_WHILE_HELD, 3},
+    };
+    GestureTable const tables[] = {
+        GestureTable(oneGesture, 1),
+        GestureTable(manyGestures, 8),
+    };
+    Trace const doubleTrace = doublePressTrace();
+    Trace const longTrace = longPressTrace();
+
+    bench::run("GestureEngine/double/1", GESTURE_BENCH_BUTTONS, sizeof(GestureEngine),
+               [&](uint64_t &events)
+               { return runGestureTrace(tables[0], doubleTrace, events); });
+    bench::run("GestureEngine/double/8", GESTURE_BENCH_BUTTONS, sizeof(GestureEngine),
+               [&](uint64_t &events)
+               { return runGestureTrace(tables[1], doubleTrace, events); });
+    bench::run("GestureEngine/long/8", GESTURE_BENCH_BUTTONS, sizeof(GestureEngine),
+               [&](uint64_t &events)
+               { return runGestureTrace(tables[1], longTrace, events); });
+}
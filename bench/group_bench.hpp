@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "scanner_bench.hpp" // PanelButtonHal
+
+#include "ButtonGroup.hpp"
+#include "ButtonModule.hpp"
+
+#define GROUP_BENCH_BUTTONS 1024
+#define GROUP_BENCH_TICKS 2000
+
+struct GroupEventCounter
+{
+    uint64_t *events;
+
+    void operator()(uint16_t, ButtonStateMachine::Event) { (*events)++; }
+};
+
+// Button i reads pin i % 64, so every pin is shared by 16 buttons
+inline uint64_t runModules(PanelButtonHal &hal, uint64_t &events)
+{
+    std::vector<ButtonModule *> buttons;
+    for (uint16_t i = 0; i < GROUP_BENCH_BUTTONS; i++)
+    {
+        ButtonModule *button = new ButtonModule(i % 64, true, nullptr, &hal);
+        button->onSinglePress(countScannerEvent, &events);
+        button->onDoublePress(countScannerEvent, &events);
+        button->onLongPress(countScannerEvent, &events);
+        buttons.push_back(button);
+    }
+
+    // Ticks are 1 ms apart, like the traces
+    for (hal.time = 0; hal.time < GROUP_BENCH_TICKS; hal.time++)
+        for (ButtonModule *button : buttons)
+            button->poll();
+
+    for (ButtonModule *button : buttons)
+        delete button;
+    return uint64_t(GROUP_BENCH_TICKS) * GROUP_BENCH_BUTTONS;
+}
+
+// The group is allocated inside the run, so its size is part of the heap reported per button
+inline uint64_t runGroup(PanelButtonHal &hal, uint64_t &events)
+{
+    StaticButtonGroup<GROUP_BENCH_BUTTONS> *group = new StaticButtonGroup<GROUP_BENCH_BUTTONS>(nullptr, &hal);
+    for (uint16_t i = 0; i < GROUP_BENCH_BUTTONS; i++)
+        group->setPin(i, i % 64);
+    group->onEvent(GroupEventCounter{&events});
+
+    for (hal.time = 0; hal.time < GROUP_BENCH_TICKS; hal.time++)
+        group->scan();
+
+    delete group;
+    return uint64_t(GROUP_BENCH_TICKS) * GROUP_BENCH_BUTTONS;
+}
+
+inline void benchmarkGroup()
+{
+    PanelButtonHal hal;
+
+    bench::run("ButtonModule/1024/pressing", GROUP_BENCH_BUTTONS, 0,
+               [&](uint64_t &events)
+               { return runModules(hal, events); });
+    bench::run("ButtonGroup/1024/pressing", GROUP_BENCH_BUTTONS, 0,
+               [&](uint64_t &events)
+               { return runGroup(hal, events); });
+
+    hal.levels.assign(1, 0);
+    bench::run("ButtonModule/1024/idle", GROUP_BENCH_BUTTONS, 0,
+               [&](uint64_t &events)
+               { return runModules(hal, events); });
+    bench::run("ButtonGroup/1024/idle", GROUP_BENCH_BUTTONS, 0,
+               [&](uint64_t &events)
+               { return runGroup(hal, events); });
+
+    printf("\n%-36s %12s\n", "Per-button state", "bytes");
+    printf("%-36s %12zu\n", "sizeof(ButtonModule)", sizeof(ButtonModule));
+    printf("%-36s %12zu\n", "sizeof(PackedButtonStateMachine)", sizeof(PackedButtonStateMachine));
+    printf("%-36s %12.2f\n", "ButtonGroup per button",
+           double(sizeof(StaticButtonGroup<GROUP_BENCH_BUTTONS>)) / GROUP_BENCH_BUTTONS);
+}
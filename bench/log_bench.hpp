@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdio>
+
+#include "Benchmark.hpp"
+
+#include "ButtonLogRing.hpp"
+
+#define LOG_BENCH_MESSAGES 2000000
+
+// Cost of one event message on the polling task: formatted text, as the logger does, against
+// a binary record in a ButtonLogRing. A message elided by BUTTON_LOG_LEVEL costs nothing.
+inline void benchmarkLog()
+{
+    bench::run("log/formatted", 1, 0,
+               [](uint64_t &events)
+               {
+                   char text[96];
+                   for (uint32_t i = 0; i < LOG_BENCH_MESSAGES; i++)
+                       events += snprintf(text, sizeof(text), "[%lu] Button %u: single press detected, latency %lu us",
+                                          (unsigned long)i, 5u, (unsigned long)(i * 7)) > 0;
+                   return uint64_t(LOG_BENCH_MESSAGES);
+               });
+
+    bench::run("log/ring", 1, 0,
+               [](uint64_t &events)
+               {
+                   StaticButtonLogRing<64> ring;
+                   ButtonLogRecord record;
+                   for (uint32_t i = 0; i < LOG_BENCH_MESSAGES; i++)
+                   {
+                       events += ring.push({i, ButtonLogRecord::Id::SINGLE_PRESS, 5, i * 7});
+                       // The consumer keeps up; it runs on another task in practice
+                       if ((i & 31) == 31)
+                           while (ring.pop(record))
+                               bench::doNotOptimize(record);
+                   }
+                   return uint64_t(LOG_BENCH_MESSAGES);
+               });
+}
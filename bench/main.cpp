@@ -0,0 +1,85 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "Benchmark.hpp"
+
+#include "stateMachine_bench.hpp"
+#include "staticButton_bench.hpp"
+#include "scanner_bench.hpp"
+#include "debounce_bench.hpp"
+#include "wakeup_bench.hpp"
+#include "log_bench.hpp"
+#include "gesture_bench.hpp"
+#include "matrix_bench.hpp"
+#include "delegate_bench.hpp"
+#include "subscribers_bench.hpp"
+#include "group_bench.hpp"
+#include "bank_bench.hpp"
+#include "trace_bench.hpp"
+
+size_t bench::allocatedBytes = 0;
+size_t bench::peakAllocatedBytes = 0;
+
+// Track heap usage so every benchmark can report the memory it allocates per button. The
+// size and the header length sit right before the returned pointer; the header is padded to
+// the alignment, so over-aligned types and vector loads get correctly aligned storage.
+static void *trackedAllocate(size_t size, size_t alignment)
+{
+    size_t header = alignment > alignof(std::max_align_t) ? alignment : alignof(std::max_align_t);
+    size_t total = (size + header + header - 1) / header * header;
+    char *base = static_cast<char *>(aligned_alloc(header, total));
+    if (base == nullptr)
+        throw std::bad_alloc();
+    size_t *fields = reinterpret_cast<size_t *>(base + header) - 2;
+    fields[0] = header;
+    fields[1] = size;
+    bench::allocatedBytes += size;
+    if (bench::allocatedBytes > bench::peakAllocatedBytes)
+        bench::peakAllocatedBytes = bench::allocatedBytes;
+    return base + header;
+}
+
+static void trackedFree(void *pointer)
+{
+    if (pointer == nullptr)
+        return;
+    size_t *fields = static_cast<size_t *>(pointer) - 2;
+    bench::allocatedBytes -= fields[1];
+    free(static_cast<char *>(pointer) - fields[0]);
+}
+
+void *operator new(size_t size) { return trackedAllocate(size, alignof(std::max_align_t)); }
+void *operator new[](size_t size) { return trackedAllocate(size, alignof(std::max_align_t)); }
+void *operator new(size_t size, std::align_val_t alignment) { return trackedAllocate(size, size_t(alignment)); }
+void *operator new[](size_t size, std::align_val_t alignment) { return trackedAllocate(size, size_t(alignment)); }
+
+void operator delete(void *pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept { trackedFree(pointer); }
+
+int main(int argc, char **argv)
+{
+    bench::parseArguments(argc, argv);
+
+    benchmarkStateMachine();
+    benchmarkStaticButton();
+    benchmarkScanner();
+    benchmarkDebounce();
+    benchmarkLog();
+    benchmarkGesture();
+    benchmarkMatrix();
+    benchmarkDelegate();
+    benchmarkSubscribers();
+    benchmarkGroup();
+    benchmarkBank();
+    benchmarkTraceRecorder();
+    benchmarkWakeups();
+
+    return bench::checkBudget();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonMatrix.hpp"
+
+#define MATRIX_BENCH_TICKS 20000
+
+// Keypad with diodes, columns on pins 0 to 7 and rows on pins 8 to 15
+class KeypadBenchHal : public ButtonHalInterface
+{
+public:
+    std::vector<uint64_t> keys; // Pressed keys of every tick, one bit per key
+    uint8_t columnCount = 8;
+    uint8_t lowRow = 0xFF;      // Row driven low, 0xFF for none
+    uint32_t time = 0;
+
+    // One key at a time replays the double press trace, moving to the next key every trace
+    void type(uint8_t keyCount)
+    {
+        Trace const trace = doublePressTrace();
+        keys.assign(trace.size() * keyCount, 0);
+        for (size_t tick = 0; tick < keys.size(); tick++)
+            keys[tick] = uint64_t(trace[tick % trace.size()]) << (tick / trace.size());
+    }
+
+    uint32_t now() override { return time; }
+    void setupPin(uint8_t) override {}
+    bool readPin(uint8_t pin) override { return (readPins() >> pin) & 1; }
+    uint64_t readPins() override
+    {
+        if (lowRow == 0xFF)
+            return 0xFF;
+        uint64_t columns = (keys[time % keys.size()] >> (lowRow * columnCount)) & ((1 << columnCount) - 1);
+        return 0xFF & ~columns;
+    }
+    void writePin(uint8_t pin, bool level) override
+    {
+        if (!level)
+            lowRow = pin - 8;
+        else if (lowRow == pin - 8)
+            lowRow = 0xFF;
+    }
+    void attachPinInterrupt(uint8_t, void (*)(void *), void *) override {}
+    void detachPinInterrupt(uint8_t) override {}
+};
+
+inline void countMatrixEvent(uint8_t, ButtonStateMachine::Event, void *events)
+{
+    (*static_cast<uint64_t *>(events))++;
+}
+
+// One sample is one key of one scan, a full scan costs keys times the reported time
+inline uint64_t runMatrix(KeypadBenchHal &hal, uint8_t rows, uint8_t columns, uint64_t &events)
+{
+    uint8_t const rowPins[] = {8, 9, 10, 11, 12, 13, 14, 15};
+    uint8_t const columnPins[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    hal.columnCount = columns;
+    ButtonMatrix matrix(rowPins, rows, columnPins, columns, nullptr, &hal);
+    matrix.onKeyEvent(countMatrixEvent, &events);
+
+    // Ticks are 1 ms apart, like the traces
+    for (hal.time = 0; hal.time < MATRIX_BENCH_TICKS; hal.time++)
+        matrix.scan();
+    return uint64_t(MATRIX_BENCH_TICKS) * rows * columns;
+}
+
+inline void benchmarkMatrix()
+{
+    KeypadBenchHal hal;
+
+    hal.keys.assign(1, 0);
+    bench::run("ButtonMatrix/4x4/idle", 16, sizeof(PackedButtonStateMachine),
+               [&](uint64_t &events)
+               { return runMatrix(hal, 4, 4, events); });
+    bench::run("ButtonMatrix/8x8/idle", 64, sizeof(PackedButtonStateMachine),
+               [&](uint64_t &events)
+               { return runMatrix(hal, 8, 8, events); });
+
+    hal.type(16);
+    bench::run("ButtonMatrix/4x4/typing", 16, sizeof(PackedButtonStateMachine),
+               [&](uint64_t &events)
+               { return runMatrix(hal, 4, 4, events); });
+    hal.type(64);
+    bench::run("ButtonMatrix/8x8/typing", 64, sizeof(PackedButtonStateMachine),
+               [&](uint64_t &events)
+               { return runMatrix(hal, 8, 8, events); });
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonModule.hpp"
+#include "ButtonScanner.hpp"
+
+#define SCANNER_BENCH_TICKS 20000
+
+// A panel of buttons on pins 0 to 63, each replaying the double press trace at its own offset
+class PanelButtonHal : public ButtonHalInterface
+{
+public:
+    std::vector<uint64_t> levels; // GPIO levels of every tick
+    uint32_t time = 0;
+
+    PanelButtonHal()
+    {
+        Trace const trace = doublePressTrace();
+        levels.resize(trace.size());
+        for (size_t tick = 0; tick < trace.size(); tick++)
+            for (uint8_t pin = 0; pin < 64; pin++)
+                levels[tick] |= uint64_t(trace[(tick + pin * 37) % trace.size()]) << pin;
+    }
+
+    uint32_t now() override { return time; }
+    void setupPin(uint8_t) override {}
+    bool readPin(uint8_t pin) override { return (levels[time % levels.size()] >> pin) & 1; }
+    uint64_t readPins() override { return levels[time % levels.size()]; }
+    void attachPinInterrupt(uint8_t, void (*)(void *), void *) override {}
+    void detachPinInterrupt(uint8_t) override {}
+};
+
+inline void countScannerEvent(void *events)
+{
+    (*static_cast<uint64_t *>(events))++;
+}
+
+// Buttons are allocated inside the run, so their size is part of the heap reported per button
+inline uint64_t runScanner(PanelButtonHal &hal, uint8_t buttonCount, ButtonScanner::ScanMode mode, uint64_t &events)
+{
+    ButtonScanner scanner(nullptr, &hal);
+    std::vector<ButtonModule *> buttons;
+    for (uint8_t pin = 0; pin < buttonCount; pin++)
+    {
+        ButtonModule *button = new ButtonModule(pin, true, nullptr, &hal);
+        button->onSinglePress(countScannerEvent, &events);
+        button->onDoublePress(countScannerEvent, &events);
+        button->onLongPress(countScannerEvent, &events);
+        scanner.addButton(button);
+        buttons.push_back(button);
+    }
+    scanner.setScanMode(mode);
+
+    // Ticks are 1 ms apart, like the traces
+    for (hal.time = 0; hal.time < SCANNER_BENCH_TICKS; hal.time++)
+        scanner.scan();
+
+    scanner.stopScanning();
+    for (ButtonModule *button : buttons)
+        delete button;
+    return uint64_t(SCANNER_BENCH_TICKS) * buttonCount;
+}
+
+inline void benchmarkScanner()
+{
+    static char names[2][7][40];
+    PanelButtonHal hal;
+    uint8_t const counts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    for (uint8_t i = 0; i < 7; i++)
+    {
+        snprintf(names[0][i], sizeof(names[0][i]), "ButtonScanner/per-button/%u", counts[i]);
+        bench::run(names[0][i], counts[i], 0,
+                   [&](uint64_t &events)
+                   { return runScanner(hal, counts[i], ButtonScanner::ScanMode::PER_BUTTON, events); });
+
+        snprintf(names[1][i], sizeof(names[1][i]), "ButtonScanner/batched/%u", counts[i]);
+        bench::run(names[1][i], counts[i], 0,
+                   [&](uint64_t &events)
+                   { return runScanner(hal, counts[i], ButtonScanner::ScanMode::BATCHED, events); });
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonStateMachine.hpp"
+
+#define STATE_MACHINE_BENCH_BUTTONS 64
+#define STATE_MACHINE_BENCH_REPEATS 200
+
+// Feeds the trace to every button, each one starting at a different offset
+inline uint64_t runStateMachineTrace(Trace const &trace, uint64_t &events)
+{
+    ButtonStateMachine stateMachines[STATE_MACHINE_BENCH_BUTTONS];
+    ButtonTimings timings;
+    uint8_t const enabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED |
+                                  ButtonStateMachine::DOUBLE_PRESS_ENABLED |
+                                  ButtonStateMachine::LONG_PRESS_ENABLED;
+    size_t const length = trace.size();
+    uint32_t now = 0;
+
+    for (uint32_t repeat = 0; repeat < STATE_MACHINE_BENCH_REPEATS; repeat++)
+    {
+        for (size_t i = 0; i < length; i++, now++)
+        {
+            for (size_t button = 0; button < STATE_MACHINE_BENCH_BUTTONS; button++)
+            {
+                bool pressed = trace[(i + button * 37) % length];
+                if (stateMachines[button].update(now, pressed, timings, enabledEvents) != ButtonStateMachine::Event::NONE)
+                    events++;
+            }
+        }
+    }
+    bench::doNotOptimize(stateMachines);
+    return uint64_t(STATE_MACHINE_BENCH_REPEATS) * length * STATE_MACHINE_BENCH_BUTTONS;
+}
+
+inline void benchmarkStateMachine()
+{
+    struct
+    {
+        char const *name;
+        Trace trace;
+    } const traces[] = {
+        {"ButtonStateMachine/idle", Trace(1450, 0)},
+        {"ButtonStateMachine/single", singlePressTrace()},
+        {"ButtonStateMachine/double", doublePressTrace()},
+        {"ButtonStateMachine/long", longPressTrace()},
+        {"ButtonStateMachine/bounce", bouncePressTrace()},
+    };
+
+    for (auto const &trace : traces)
+        bench::run(trace.name, STATE_MACHINE_BENCH_BUTTONS, sizeof(ButtonStateMachine),
+                   [&](uint64_t &events)
+                   { return runStateMachineTrace(trace.trace, events); });
+}
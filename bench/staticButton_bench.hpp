@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonModule.hpp"
+#include "StaticButton.hpp"
+
+#define STATIC_BUTTON_BENCH_REPEATS 20000
+
+// Replays a trace through ButtonHalInterface, one sample per step
+class TraceButtonHal : public ButtonHalInterface
+{
+public:
+    Trace const *trace = nullptr;
+    uint32_t time = 0;
+
+    uint32_t now() override { return time; }
+    void setupPin(uint8_t) override {}
+    bool readPin(uint8_t) override { return (*trace)[time % trace->size()]; }
+    void attachPinInterrupt(uint8_t, void (*)(void *), void *) override {}
+    void detachPinInterrupt(uint8_t) override {}
+};
+
+struct CountingHandler
+{
+    uint64_t *events;
+
+    void operator()(ButtonStateMachine::Event) { (*events)++; }
+};
+
+inline void countEvent(void *events)
+{
+    (*static_cast<uint64_t *>(events))++;
+}
+
+inline void benchmarkStaticButton()
+{
+    Trace const trace = doublePressTrace();
+    uint64_t const samples = uint64_t(STATIC_BUTTON_BENCH_REPEATS) * trace.size();
+
+    bench::run("ButtonModule/poll", 1, sizeof(ButtonModule),
+               [&](uint64_t &events)
+               {
+                   TraceButtonHal hal;
+                   hal.trace = &trace;
+                   ButtonModule buttonModule(5, true, nullptr, &hal);
+                   buttonModule.onSinglePress(countEvent, &events);
+                   buttonModule.onDoublePress(countEvent, &events);
+                   buttonModule.onLongPress(countEvent, &events);
+                   for (hal.time = 0; hal.time < samples; hal.time++)
+                       buttonModule.poll();
+                   return samples;
+               });
+
+    bench::run("StaticButton/sample", 1, sizeof(StaticButton<5, true, DefaultStaticButtonTimings, CountingHandler>),
+               [&](uint64_t &events)
+               {
+                   StaticButton<5, true, DefaultStaticButtonTimings, CountingHandler> button(CountingHandler{&events});
+                   size_t const length = trace.size();
+                   for (uint32_t time = 0; time < samples; time++)
+                       button.sample(time, trace[time % length]);
+                   return samples;
+               });
+}
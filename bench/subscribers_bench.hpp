@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Benchmark.hpp"
+
+#include "ButtonSubscribers.hpp"
+
+#define SUBSCRIBERS_BENCH_DISPATCHES 1000000
+
+// Dispatches single presses to a number of subscribers, half of them subscribed to long press only
+inline uint64_t runSubscribers(uint8_t count, uint64_t &events)
+{
+    StaticButtonSubscribers<32> subscribers;
+    uint64_t *counter = &events;
+    for (uint8_t i = 0; i < count; i++)
+        subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [counter](ButtonStateMachine::Event)
+                              { (*counter)++; });
+    for (uint8_t i = 0; i < count; i++)
+        subscribers.subscribe(ButtonStateMachine::LONG_PRESS_ENABLED, [counter](ButtonStateMachine::Event)
+                              { (*counter)++; });
+
+    for (uint32_t i = 0; i < SUBSCRIBERS_BENCH_DISPATCHES; i++)
+        subscribers.dispatch(ButtonStateMachine::Event::SINGLE_PRESS);
+    return SUBSCRIBERS_BENCH_DISPATCHES;
+}
+
+// Cost of one event dispatch, growing with the subscribers of that event only
+inline void benchmarkSubscribers()
+{
+    static char const *const names[] = {
+        "ButtonSubscribers/0", "ButtonSubscribers/1", "ButtonSubscribers/2",
+        "ButtonSubscribers/4", "ButtonSubscribers/8", "ButtonSubscribers/16"};
+    uint8_t const counts[] = {0, 1, 2, 4, 8, 16};
+
+    for (size_t i = 0; i < sizeof(counts); i++)
+    {
+        uint8_t count = counts[i];
+        bench::run(names[i], 1, sizeof(ButtonSubscribers) + 2 * count * sizeof(ButtonSubscriber),
+                   [count](uint64_t &events)
+                   { return runSubscribers(count, events); });
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "traces.hpp"
+
+#include "ButtonModule.hpp"
+#include "ButtonTraceRecorder.hpp"
+#include "SimulatedButtonHal.hpp"
+
+#define TRACE_BENCH_REPEATS 200
+
+inline void countTraceEvent(void *events)
+{
+    (*static_cast<uint64_t *>(events))++;
+}
+
+// poll() every millisecond over idle, double press and bouncing press traces, with or without
+// a trace recorder; samples without an edge only compare the raw level
+inline uint64_t pollTraces(std::vector<Trace> const &traces, ButtonTraceRecorder *recorder, uint64_t &events)
+{
+    SimulatedButtonHal hal;
+    ButtonModule button(5, true, nullptr, &hal);
+    button.onSinglePress(countTraceEvent, &events);
+    button.onDoublePress(countTraceEvent, &events);
+    button.onLongPress(countTraceEvent, &events);
+    ButtonDiagnostics diagnostics;
+    diagnostics.traceRecorder = recorder;
+    button.setDiagnostics(&diagnostics);
+
+    uint64_t samples = 0;
+    for (uint32_t repeat = 0; repeat < TRACE_BENCH_REPEATS; repeat++)
+        for (Trace const &trace : traces)
+            for (uint8_t level : trace)
+            {
+                hal.setLevel(5, level);
+                button.poll();
+                hal.advance(1);
+                samples++;
+            }
+    return samples;
+}
+
+inline void benchmarkTraceRecorder()
+{
+    std::vector<Trace> const traces = {singlePressTrace(), doublePressTrace(), bouncePressTrace()};
+
+    bench::run("ButtonTraceRecorder/off", 1, 0,
+               [&](uint64_t &events)
+               { return pollTraces(traces, nullptr, events); });
+
+    bench::run("ButtonTraceRecorder/on", 1, 512,
+               [&](uint64_t &events)
+               {
+                   StaticButtonTraceRecorder<512> recorder(5);
+                   return pollTraces(traces, &recorder, events);
+               });
+}
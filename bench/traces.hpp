@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file traces.hpp
+ * @brief Synthetic button traces for the benchmarks
+ * @details Traces are button levels sampled every millisecond.
+ */
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using Trace = std::vector<uint8_t>;
+
+inline void appendLevel(Trace &trace, bool pressed, uint32_t ms)
+{
+    trace.insert(trace.end(), ms, pressed);
+}
+
+// Contact bounce settling on the given level
+inline void appendBounce(Trace &trace, bool pressed, uint32_t ms, std::mt19937 &random)
+{
+    for (uint32_t i = 0; i < ms; i++)
+        trace.push_back(random() & 1);
+    trace.push_back(pressed);
+}
+
+inline Trace singlePressTrace()
+{
+    Trace trace;
+    appendLevel(trace, false, 600);
+    appendLevel(trace, true, 150);
+    appendLevel(trace, false, 700);
+    return trace;
+}
+
+inline Trace doublePressTrace()
+{
+    Trace trace;
+    appendLevel(trace, false, 600);
+    appendLevel(trace, true, 150);
+    appendLevel(trace, false, 150);
+    appendLevel(trace, true, 150);
+    appendLevel(trace, false, 700);
+    return trace;
+}
+
+inline Trace longPressTrace()
+{
+    Trace trace;
+    appendLevel(trace, false, 600);
+    appendLevel(trace, true, 1500);
+    appendLevel(trace, false, 700);
+    return trace;
+}
+
+inline Trace bouncePressTrace()
+{
+    std::mt19937 random(42);
+    Trace trace;
+    appendLevel(trace, false, 600);
+    appendBounce(trace, true, 10, random);
+    appendLevel(trace, true, 150);
+    appendBounce(trace, false, 10, random);
+    appendLevel(trace, false, 700);
+    return trace;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+#define WAKEUP_BENCH_MINUTES 10
+#define WAKEUP_BENCH_CHECK_INTERVAL 30
+#define WAKEUP_BENCH_IDLE_CHECK_INTERVAL 200
+
+struct LevelChange
+{
+    uint32_t time;
+    bool pressed;
+};
+
+// A single, double or long press every 3 seconds
+inline std::vector<LevelChange> activeWorkload(uint32_t duration)
+{
+    std::vector<LevelChange> changes;
+    for (uint32_t start = 1000, i = 0; start + 3000 <= duration; start += 3000, i++)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            changes.push_back({start, true});
+            changes.push_back({start + 150, false});
+            break;
+        case 1:
+            changes.push_back({start, true});
+            changes.push_back({start + 150, false});
+            changes.push_back({start + 300, true});
+            changes.push_back({start + 450, false});
+            break;
+        default:
+            changes.push_back({start, true});
+            changes.push_back({start + 1500, false});
+            break;
+        }
+    }
+    return changes;
+}
+
+inline void countWakeupEvent(void *events)
+{
+    (*static_cast<uint64_t *>(events))++;
+}
+
+// Replays the listening task on a virtual clock: poll, then sleep getPollDelay() or, in
+// INTERRUPT mode, until the next pin change plus the settle time
+inline uint64_t simulateWakeups(
+    ButtonModule::ListeningMode mode, uint16_t idleCheckInterval,
+    std::vector<LevelChange> const &changes, uint32_t duration, uint64_t &events)
+{
+    SimulatedButtonHal hal;
+    ButtonModule button(5, true, nullptr, &hal);
+    button.onSinglePress(countWakeupEvent, &events);
+    button.onDoublePress(countWakeupEvent, &events);
+    button.onLongPress(countWakeupEvent, &events);
+    button.setListeningMode(mode);
+    button.setIdleCheckInterval(idleCheckInterval);
+    button.startListening(3000, nullptr, WAKEUP_BENCH_CHECK_INTERVAL);
+
+    uint64_t wakeups = 0;
+    size_t next = 0;
+    uint32_t time = 0;
+    while (time < duration)
+    {
+        hal.setTime(time);
+        for (; next < changes.size() && changes[next].time <= time; next++)
+            hal.setLevel(5, changes[next].pressed);
+
+        button.poll();
+        wakeups++;
+
+        uint32_t delay = button.getPollDelay();
+        uint32_t wake = delay == ButtonStateMachine::NO_DEADLINE ? duration : time + (delay > 0 ? delay : 1);
+        if (mode == ButtonModule::ListeningMode::INTERRUPT && next < changes.size() && changes[next].time < wake)
+            wake = changes[next].time + WAKEUP_BENCH_CHECK_INTERVAL;
+        time = wake;
+    }
+    return wakeups;
+}
+
+inline void benchmarkWakeups()
+{
+    struct
+    {
+        char const *name;
+        ButtonModule::ListeningMode mode;
+        uint16_t idleCheckInterval;
+    } const schedulers[] = {
+        {"fixed", ButtonModule::ListeningMode::POLLING, 0},
+        {"adaptive", ButtonModule::ListeningMode::POLLING, WAKEUP_BENCH_IDLE_CHECK_INTERVAL},
+        {"interrupt", ButtonModule::ListeningMode::INTERRUPT, 0},
+    };
+    uint32_t const duration = WAKEUP_BENCH_MINUTES * 60000;
+    std::vector<LevelChange> const active = activeWorkload(duration);
+
+    printf("\n%-36s %12s %12s %12s\n", "Listening task", "idle/min", "active/min", "events");
+    for (auto const &scheduler : schedulers)
+    {
+        uint64_t idleEvents = 0;
+        uint64_t activeEvents = 0;
+        uint64_t idle = simulateWakeups(scheduler.mode, scheduler.idleCheckInterval, {}, duration, idleEvents);
+        uint64_t busy = simulateWakeups(scheduler.mode, scheduler.idleCheckInterval, active, duration, activeEvents);
+
+        char name[48];
+        snprintf(name, sizeof(name), "ButtonModule/wakeups/%s", scheduler.name);
+        printf("%-36s %12.1f %12.1f %12llu\n", name,
+               double(idle) / WAKEUP_BENCH_MINUTES,
+               double(busy) / WAKEUP_BENCH_MINUTES,
+               (unsigned long long)activeEvents);
+    }
+}
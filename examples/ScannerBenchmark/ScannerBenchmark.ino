@@ -0,0 +1,84 @@
+/**
+ * @file ScannerBenchmark.ino
+ * @brief Compares one listening task per ButtonModule against a shared ButtonScanner
+ * @details For 1 to 64 buttons, measures the heap consumed and the task wakeups per second
+ * of both designs. Wakeups are counted by overriding isPressed(), which is sampled once per
+ * button per tick.
+ */
+#include <Arduino.h>
+
+#include <ButtonModule.hpp>
+#include <ButtonScanner.hpp>
+
+#define BENCHMARK_PIN 5
+#define BENCHMARK_MAX_BUTTONS 64
+#define BENCHMARK_WINDOW_MS 2000
+
+volatile uint32_t samples = 0;
+
+class CountingButton : public ButtonModule
+{
+public:
+    CountingButton() : ButtonModule(BENCHMARK_PIN) {}
+
+    bool const isPressed() const override
+    {
+        samples++;
+        return ButtonModule::isPressed();
+    }
+};
+
+CountingButton *buttons[BENCHMARK_MAX_BUTTONS];
+
+uint32_t measureSamplesPerSecond()
+{
+    samples = 0;
+    delay(BENCHMARK_WINDOW_MS);
+    return samples * 1000 / BENCHMARK_WINDOW_MS;
+}
+
+void benchmark(uint8_t count)
+{
+    uint32_t heapBefore = ESP.getFreeHeap();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buttons[i] = new CountingButton();
+        buttons[i]->startListening();
+    }
+    uint32_t perTaskHeap = heapBefore - ESP.getFreeHeap();
+    // Every button task wakes up once per sample
+    uint32_t perTaskWakeups = measureSamplesPerSecond();
+    for (uint8_t i = 0; i < count; i++)
+        delete buttons[i];
+
+    heapBefore = ESP.getFreeHeap();
+    ButtonScanner *scanner = new ButtonScanner();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buttons[i] = new CountingButton();
+        scanner->addButton(buttons[i]);
+    }
+    scanner->startScanning();
+    uint32_t scannerHeap = heapBefore - ESP.getFreeHeap();
+    // The scanner task wakes up once per sample of all buttons
+    uint32_t scannerWakeups = measureSamplesPerSecond() / count;
+    delete scanner;
+    for (uint8_t i = 0; i < count; i++)
+        delete buttons[i];
+
+    Serial.printf("%7u | %13u | %17u | %12u | %16u\n",
+                  count, perTaskHeap, perTaskWakeups, scannerHeap, scannerWakeups);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println("buttons | per-task heap | per-task wakeup/s | scanner heap | scanner wakeup/s");
+    for (uint8_t count = 1; count <= BENCHMARK_MAX_BUTTONS; count *= 2)
+        benchmark(count);
+}
+
+void loop()
+{
+    delay(1000);
+}
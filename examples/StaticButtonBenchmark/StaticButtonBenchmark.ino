@@ -0,0 +1,57 @@
+/**
+ * @file StaticButtonBenchmark.ino
+ * @brief Compares StaticButton against ButtonModule on the device
+ * @details Prints RAM per instance and CPU cycles per poll of both. For code size, build once
+ * with BENCHMARK_BUTTON_MODULE set to 1 and once to 0 and compare `pio run -t size`.
+ */
+#include <Arduino.h>
+
+#include <ButtonModule.hpp>
+#include <StaticButton.hpp>
+
+#define BENCHMARK_PIN 5
+#define BENCHMARK_POLLS 10000
+#define BENCHMARK_BUTTON_MODULE 1
+
+volatile uint32_t events = 0;
+
+struct CountingHandler
+{
+    void operator()(ButtonStateMachine::Event) { events++; }
+};
+
+StaticButton<BENCHMARK_PIN, HIGH, DefaultStaticButtonTimings, CountingHandler> staticButton;
+
+void countEvent(void *)
+{
+    events++;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    staticButton.begin();
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCHMARK_POLLS; i++)
+        staticButton.poll();
+    uint32_t staticCycles = (ESP.getCycleCount() - start) / BENCHMARK_POLLS;
+    Serial.printf("StaticButton: %u bytes, %u cycles/poll\n", sizeof(staticButton), staticCycles);
+
+#if BENCHMARK_BUTTON_MODULE
+    ButtonModule buttonModule(BENCHMARK_PIN);
+    buttonModule.onSinglePress(countEvent);
+    buttonModule.onDoublePress(countEvent);
+    buttonModule.onLongPress(countEvent);
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCHMARK_POLLS; i++)
+        buttonModule.poll();
+    uint32_t moduleCycles = (ESP.getCycleCount() - start) / BENCHMARK_POLLS;
+    Serial.printf("ButtonModule: %u bytes (+ task stack when listening), %u cycles/poll\n", sizeof(buttonModule), moduleCycles);
+#endif
+}
+
+void loop()
+{
+    delay(1000);
+}
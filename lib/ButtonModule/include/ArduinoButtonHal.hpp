@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file ArduinoButtonHal.hpp
+ * @brief Defines the ArduinoButtonHal class
+ * @details Header file declaring the Arduino implementation of ButtonHalInterface
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include "ButtonHalInterface.hpp"
+
+/**
+ * @brief ButtonHalInterface on top of the Arduino core: millis(), pinMode(), digitalRead(),
+ * digitalWrite() and pin change interrupts. It is the default backend of ButtonModule. On the ESP32,
+ * readPins() reads both GPIO input registers instead of every pin, micros() reads the
+ * esp_timer, and the sleep wakeup sources are configured through esp_sleep: GPIO wakeup for
+ * light sleep, EXT1 (any high) or EXT0 (one low pin) for deep sleep.
+ */
+class ArduinoButtonHal : public ButtonHalInterface
+{
+public:
+    /**
+     * @brief Gets the shared instance.
+     *
+     * @return The shared instance.
+     */
+    static ArduinoButtonHal &getInstance();
+
+    uint32_t now() override;
+    uint32_t micros() override;
+    void setupPin(uint8_t pin) override;
+    bool readPin(uint8_t pin) override;
+    uint64_t readPins() override;
+    void setupOutputPin(uint8_t pin) override;
+    void writePin(uint8_t pin, bool level) override;
+    void delayMicroseconds(uint32_t microseconds) override;
+    bool enableWakeup(uint8_t pin, bool level, bool deepSleep) override;
+    void disableWakeup(uint8_t pin) override;
+    bool wasWakeupSource(uint8_t pin) override;
+    void attachPinInterrupt(uint8_t pin, void (*handler)(void *), void *arg) override;
+    void detachPinInterrupt(uint8_t pin) override;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file BitParallelDebouncer.hpp
+ * @brief Defines the BitParallelDebouncer class template
+ * @details Header-only debounce filter for up to 32 or 64 inputs packed in one word
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t
+
+/**
+ * @brief Debounces every bit of a word at once.
+ *
+ * @details Each bit is one input, or lane. A lane changes its debounced state only after the
+ * last `Samples` raw samples agree, which takes a handful of bitwise operations per update for
+ * all lanes together: the AND of the history gives the lanes stable high, the OR the lanes
+ * that are not stable low.
+ *
+ * @tparam Word Unsigned integer type holding one bit per lane, e.g. uint32_t or uint64_t.
+ * @tparam Samples Number of consecutive equal samples needed to change state, 1 disables filtering.
+ */
+template <typename Word, uint8_t Samples>
+class BitParallelDebouncer
+{
+    static_assert(Samples > 0, "Samples must be at least 1");
+
+private:
+    Word _history[Samples]; // Last raw samples, a ring indexed by _index
+    uint8_t _index = 0;     // Slot of the oldest sample
+    Word _state;            // Debounced state of every lane
+
+    static Word moveBit(Word word, uint8_t from, uint8_t to)
+    {
+        Word bit = (word >> from) & 1;
+        word &= ~(Word(1) << from);
+        return (word & ~(Word(1) << to)) | (bit << to);
+    }
+
+public:
+    /**
+     * @brief Constructor for BitParallelDebouncer.
+     *
+     * @param state Initial state of every lane.
+     */
+    explicit BitParallelDebouncer(Word state = 0) { reset(state); }
+
+    /**
+     * @brief Sets the state and the whole history of every lane.
+     *
+     * @param state The new state of every lane.
+     */
+    void reset(Word state)
+    {
+        for (uint8_t i = 0; i < Samples; i++)
+            _history[i] = state;
+        _state = state;
+    }
+
+    /**
+     * @brief Feeds one raw sample of every lane.
+     *
+     * @param sample Raw level of every lane.
+     * @return Mask of the lanes whose debounced state changed.
+     */
+    Word update(Word sample)
+    {
+        _history[_index] = sample;
+        _index = _index + 1 == Samples ? 0 : _index + 1;
+
+        Word allHigh = sample;
+        Word anyHigh = sample;
+        for (uint8_t i = 0; i < Samples; i++)
+        {
+            allHigh &= _history[i];
+            anyHigh |= _history[i];
+        }
+
+        Word previous = _state;
+        _state = (_state | allHigh) & anyHigh;
+        return _state ^ previous;
+    }
+
+    /**
+     * @brief Moves the state and history of one lane to another.
+     *
+     * @details Used when the input of a lane is reassigned, e.g. a button is removed from a
+     * group and the last one takes its place.
+     *
+     * @param from Lane to move.
+     * @param to Lane receiving the state and history, its own are overwritten.
+     */
+    void moveLane(uint8_t from, uint8_t to)
+    {
+        for (uint8_t i = 0; i < Samples; i++)
+            _history[i] = moveBit(_history[i], from, to);
+        _state = moveBit(_state, from, to);
+    }
+
+    /**
+     * @brief Sets the state and the whole history of one lane.
+     *
+     * @param lane The lane to set.
+     * @param state The new state of the lane.
+     */
+    void resetLane(uint8_t lane, bool state)
+    {
+        Word bit = Word(1) << lane;
+        for (uint8_t i = 0; i < Samples; i++)
+            _history[i] = state ? _history[i] | bit : _history[i] & ~bit;
+        _state = state ? _state | bit : _state & ~bit;
+    }
+
+    /**
+     * @brief Gets the debounced state of every lane.
+     *
+     * @return The debounced state of every lane.
+     */
+    Word state() const { return _state; }
+};
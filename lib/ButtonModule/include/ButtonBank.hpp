@@ -0,0 +1,161 @@
+#pragma once
+
+/**
+ * @file ButtonBank.hpp
+ * @brief Defines the ButtonBank class
+ * @details Header file declaring the ButtonStateMachine classification of many buttons stored as parallel arrays
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#include "ButtonDelegate.hpp"
+#include "ButtonStateMachine.hpp"
+
+#ifndef BUTTON_BANK_LANES
+#if defined(__AVX2__)
+#define BUTTON_BANK_LANES 8 // Buttons updated together by one vector operation, 8 fill the 256 bit registers of AVX2
+#else
+#define BUTTON_BANK_LANES 4 // Buttons updated together by one vector operation, 4 fill the 128 bit registers of SSE2 and NEON
+#endif
+#endif
+
+/**
+ * @brief Callback of a ButtonBank, taking the button index and the event.
+ */
+typedef ButtonDelegate<uint16_t, ButtonStateMachine::Event> ButtonBankCallback;
+
+/**
+ * @brief ButtonStateMachine of many buttons, updated together.
+ *
+ * @details The fields of ButtonStateMachine are kept as three parallel arrays: press times,
+ * release times, and the press count with the level and trigger flags. Every sample batch
+ * carries one timestamp and the pressed level of all buttons, and runs one loop over the
+ * arrays in which every branch of ButtonStateMachine::update() became a lane mask, so the
+ * compiler emits vector instructions for BUTTON_BANK_LANES buttons at a time; SSE2, AVX2 or NEON
+ * on a host, scalar code elsewhere. Like ButtonGroup, a bit per button marks the presses in
+ * progress, and lanes of released, idle buttons are skipped. The events are the same as
+ * those of a ButtonStateMachine fed the same samples, including the 8 bit press count. No
+ * time source, pin or task is involved, the samples come from the owner, e.g. a gateway
+ * replaying remote panels.
+ *
+ * The storage is provided by the caller, rounded up to a multiple of BUTTON_BANK_LANES, see
+ * StaticButtonBank.
+ */
+class ButtonBank
+{
+public:
+    static_assert(BUTTON_BANK_LANES > 0 && BUTTON_BANK_LANES <= 32 && (BUTTON_BANK_LANES & (BUTTON_BANK_LANES - 1)) == 0,
+                  "BUTTON_BANK_LANES must be a power of two up to 32");
+
+    /**
+     * @brief Gets the number of array entries needed for a number of buttons.
+     *
+     * @param buttonCount Number of buttons.
+     * @return buttonCount rounded up to a multiple of BUTTON_BANK_LANES.
+     */
+    static constexpr uint32_t storageSize(uint32_t buttonCount)
+    {
+        return (buttonCount + BUTTON_BANK_LANES - 1) / BUTTON_BANK_LANES * BUTTON_BANK_LANES;
+    }
+
+private:
+    uint32_t *const _pressTimes;   // Timestamp of the last press of every button
+    uint32_t *const _releaseTimes; // Timestamp of the last release of every button
+    uint32_t *const _states;       // Press count in bits 0 to 7, level and trigger flags of every button
+    uint32_t *const _activeWords;  // Buttons with a press in progress, one bit per button
+    uint16_t const _buttonCount;   // Number of buttons
+
+    ButtonBankCallback _callback;  // Callback for the events of every button
+    ButtonTimings _timings;        // Debounce, long press and double press timings of every button
+    uint8_t _enabledEvents = 0x07; // Mask of the reported events, all by default
+
+protected:
+    /**
+     * @brief Constructor for ButtonBank.
+     *
+     * @param pressTimes Storage for the press times, storageSize(buttonCount) entries.
+     * @param releaseTimes Storage for the release times, storageSize(buttonCount) entries.
+     * @param states Storage for the counts and flags, storageSize(buttonCount) entries.
+     * @param activeWords Storage for one bit per button, (buttonCount + 31) / 32 words.
+     * @param buttonCount Number of buttons.
+     */
+    ButtonBank(uint32_t *pressTimes, uint32_t *releaseTimes, uint32_t *states, uint32_t *activeWords, uint16_t buttonCount);
+
+public:
+    ButtonBank(ButtonBank const &) = delete;
+    ButtonBank &operator=(ButtonBank const &) = delete;
+
+    /**
+     * @brief Sets the callback for the events of every button.
+     *
+     * @details Called from update(), once the state of the buttons of the event is stored.
+     *
+     * @param callback The callback, taking the button index and the event.
+     */
+    void onEvent(ButtonBankCallback const &callback);
+
+    /**
+     * @brief Sets the timings shared by all buttons.
+     *
+     * @param debounceTime The debounce time for button triggers.
+     * @param longPressTime The long press time for button triggers.
+     * @param timeBetweenDoublePress The time between double presses for button triggers.
+     */
+    void setTimings(uint16_t debounceTime = 90, uint16_t longPressTime = 1000, uint16_t timeBetweenDoublePress = 500);
+
+    /**
+     * @brief Sets the events reported for every button.
+     *
+     * @param events Mask of ButtonStateMachine::EnabledEvent bits.
+     */
+    void setEnabledEvents(uint8_t events);
+
+    /**
+     * @brief Gets the number of buttons.
+     *
+     * @return The number of buttons.
+     */
+    uint16_t getButtonCount() const;
+
+    /**
+     * @brief Checks if a button has no press in progress.
+     *
+     * @param button The button index.
+     * @return true if the button is idle, like ButtonStateMachine::isIdle(), false otherwise.
+     */
+    bool isIdle(uint16_t button) const;
+
+    /**
+     * @brief Forgets the presses in progress of every button.
+     */
+    void reset();
+
+    /**
+     * @brief Feeds one sample batch.
+     *
+     * @param now Timestamp of the batch in milliseconds, wrapping around like millis().
+     * @param pressed Pressed level of every button, bit i % 32 of word i / 32 for button i.
+     */
+    void update(uint32_t now, uint32_t const *pressed);
+};
+
+/**
+ * @brief ButtonBank with statically sized storage.
+ *
+ * @tparam ButtonCount Number of buttons.
+ */
+template <uint16_t ButtonCount>
+class StaticButtonBank : public ButtonBank
+{
+    static_assert(ButtonCount > 0, "A bank needs at least one button");
+
+private:
+    uint32_t _pressStorage[storageSize(ButtonCount)];   // Press time of every button
+    uint32_t _releaseStorage[storageSize(ButtonCount)]; // Release time of every button
+    uint32_t _stateStorage[storageSize(ButtonCount)];   // Count and flags of every button
+    uint32_t _activeStorage[(ButtonCount + 31) / 32];   // One bit per button
+
+public:
+    StaticButtonBank() : ButtonBank(_pressStorage, _releaseStorage, _stateStorage, _activeStorage, ButtonCount) {}
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ * @file ButtonChordDetector.hpp
+ * @brief Defines the ButtonChordDetector class
+ * @details Header file declaring a detector of chords and sequences over a group of ButtonModule instances
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <MultiPrinterLoggerInterface.hpp> // MultiPrinterLoggerInterface
+#include <TaskTracker.hpp>
+
+#include "ButtonModule.hpp"
+#include "ButtonStateMachine.hpp"
+
+#ifndef BUTTON_CHORD_MAX_MEMBERS
+#define BUTTON_CHORD_MAX_MEMBERS 8 // Maximum number of buttons in a chord detector
+#endif
+
+#ifndef BUTTON_CHORD_MAX_CHORDS
+#define BUTTON_CHORD_MAX_CHORDS 8 // Maximum number of chords and sequences in a chord detector
+#endif
+
+#ifndef BUTTON_CHORD_MAX_STEPS
+#define BUTTON_CHORD_MAX_STEPS 4 // Maximum number of presses in a sequence
+#endif
+
+#ifndef BUTTON_CHORD_HELD_EVENTS
+#define BUTTON_CHORD_HELD_EVENTS 8 // Member events held back while a chord may still match
+#endif
+
+static_assert(BUTTON_CHORD_MAX_MEMBERS <= 8, "A chord detector holds one bit per member in a byte");
+
+/**
+ * @brief Detects chords and sequences over a group of buttons.
+ *
+ * @details A chord is a set of member buttons pressed together, every press within the chord
+ * window of the first one, and held for the hold time of the chord. A sequence is an ordered
+ * list of presses, each within the sequence window of the previous one. The detector is fed
+ * by the ButtonScanner polling the members, from the same scan, so it adds no task.
+ *
+ * While a chord or a sequence may still match, the events of the members are held back. When
+ * it matches, the held events are dropped and the members forget their pending presses, so a
+ * chord never also reports the single, double or long press of its members; otherwise the
+ * held events are dispatched in order. Gestures of members are not held back.
+ */
+class ButtonChordDetector
+{
+private:
+    /**
+     * @brief A chord or a sequence.
+     */
+    struct Chord
+    {
+        uint8_t mask;                             // Members of the chord or sequence, one bit per member
+        uint8_t steps[BUTTON_CHORD_MAX_STEPS];    // Members in press order, for a sequence
+        uint8_t fallback[BUTTON_CHORD_MAX_STEPS]; // Longest proper prefix of steps 0..i that is also their suffix, for a sequence
+        uint8_t length;                           // Number of steps of a sequence, 0 for a chord
+        uint8_t progress;                         // Steps of a sequence matched so far
+        uint16_t holdTime;                        // Time all members of a chord are held before it is reported
+        void (*callback)(void *);                 // Callback function reporting the chord
+        void *parameter;                          // Parameter for the callback function
+    };
+
+    /**
+     * @brief A member event held back.
+     */
+    struct HeldEvent
+    {
+        uint32_t time;                   // Time the event was detected, in milliseconds
+        uint8_t member;                  // Member index of the button
+        ButtonStateMachine::Event event; // The event
+    };
+
+    MultiPrinterLoggerInterface *const _logger; // Logger for logging
+    StaticSemaphore_t _mutexStorage;            // Storage of the mutex, nothing comes from the FreeRTOS heap
+    SemaphoreHandle_t _mutex = nullptr;         // Guards the members and chords against the scanner task
+
+    ButtonModule *_members[BUTTON_CHORD_MAX_MEMBERS] = {}; // Member buttons, indexed by member index, nullptr for a free index
+    Chord _chords[BUTTON_CHORD_MAX_CHORDS];                // Chords and sequences, indexed by chord index
+    uint8_t _chordCount = 0;                               // Number of chords and sequences
+    uint16_t _chordWindow;                                 // Longest time between the first and last press of a chord
+    uint16_t _sequenceWindow;                              // Longest time between two presses of a sequence
+
+    uint8_t _pressed = 0;          // Members pressed in the previous update, one bit per member
+    uint8_t _groupMask = 0;        // Members pressed since the chord window opened
+    uint32_t _groupStart = 0;      // Time the chord window opened
+    bool _groupOpen = false;       // The chord window is open
+    int8_t _engaged = -1;          // Chord whose members are all held, waiting for its hold time, or -1
+    uint32_t _engagedAt = 0;       // Time the engaged chord was pressed
+    bool _engagedReported = false; // The engaged chord was reported
+    bool _sequencePending = false; // A sequence has matched some steps
+    uint32_t _lastStep = 0;        // Time of the last press of a member
+
+    HeldEvent _held[BUTTON_CHORD_HELD_EVENTS]; // Member events held back, oldest first
+    uint8_t _heldCount = 0;                    // Number of held events
+
+    int8_t addDefinition(Chord const &chord);
+    bool updateChords(uint32_t now, uint8_t pressedEdges);
+    void updateSequences(uint32_t now, uint8_t pressedEdges);
+    void match(Chord const &chord);
+    void dispatchHeld();
+    void dropHeld(uint8_t mask);
+
+public:
+    /**
+     * @brief Constructor for ButtonChordDetector.
+     *
+     * @param logger Logger for logging.
+     * @param chordWindow Longest time between the first and the last press of a chord, in milliseconds.
+     * @param sequenceWindow Longest time between two presses of a sequence, in milliseconds.
+     */
+    ButtonChordDetector(MultiPrinterLoggerInterface *const logger = nullptr, uint16_t chordWindow = 80, uint16_t sequenceWindow = 600);
+
+    /**
+     * @brief Destructor for ButtonChordDetector.
+     *
+     * @details Removes all members. Detach the detector from its scanner first.
+     */
+    ~ButtonChordDetector();
+
+    /**
+     * @brief Adds a button to the group.
+     *
+     * @details The button must also be registered with the ButtonScanner the detector is
+     * attached to; the scanner reports its level and the detector holds back its events.
+     *
+     * @param button The button to add.
+     * @return The member index of the button, used by addChord() and addSequence(), or -1 if the group is full.
+     */
+    int8_t addMember(ButtonModule *button);
+
+    /**
+     * @brief Removes a button from the group.
+     *
+     * @details Its held events are dropped and the chords using it can no longer match, until
+     * addMember() hands its member index to the next button added.
+     *
+     * @param button The button to remove.
+     * @return true if the button was a member, false otherwise.
+     */
+    bool removeMember(ButtonModule *button);
+
+    /**
+     * @brief Adds a chord of members pressed together.
+     *
+     * @details When several chords match the same presses, the one with the most members wins.
+     *
+     * @param memberMask The members of the chord, bit i for member index i; at least two.
+     * @param holdTime Time all members must be held before the chord is reported, 0 to report it at once.
+     * @param callback The callback function reporting the chord.
+     * @param _pParameter The void pointer parameter for the callback function.
+     * @return The chord index, or -1 if the detector is full or the chord is invalid.
+     */
+    int8_t addChord(uint8_t memberMask, uint16_t holdTime, void (*callback)(void *), void *_pParameter = nullptr);
+
+    /**
+     * @brief Adds a sequence of member presses.
+     *
+     * @param members Member indexes in press order.
+     * @param length Number of presses, 2 to BUTTON_CHORD_MAX_STEPS.
+     * @param callback The callback function reporting the sequence.
+     * @param _pParameter The void pointer parameter for the callback function.
+     * @return The chord index, or -1 if the detector is full or the sequence is invalid.
+     */
+    int8_t addSequence(uint8_t const *members, uint8_t length, void (*callback)(void *), void *_pParameter = nullptr);
+
+    /**
+     * @brief Feeds the pressed level of every member.
+     *
+     * @details Called by the ButtonScanner once per scan, before the members process the
+     * same samples.
+     *
+     * @param now Current time in milliseconds.
+     * @param pressed Pressed level of every member, bit i for member index i.
+     */
+    void update(uint32_t now, uint8_t pressed);
+
+    /**
+     * @brief Holds back an event of a member while a chord or sequence may still match.
+     *
+     * @details Called by the members when they detect an event.
+     *
+     * @param member Member index of the button.
+     * @param now Time the event was detected, in milliseconds.
+     * @param event The event.
+     * @return true if the event was held back, false if the member dispatches it now.
+     */
+    bool holdBack(uint8_t member, uint32_t now, ButtonStateMachine::Event event);
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * @file ButtonDelegate.hpp
+ * @brief Defines the ButtonDelegate class
+ * @details Header-only callback object storing a small callable inline, without heap allocation
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <new>         // placement new
+#include <stddef.h>    // size_t, nullptr_t
+#include <type_traits> // aligned_storage, enable_if, is_trivially_copyable
+#include <utility>     // declval
+
+#ifndef BUTTON_DELEGATE_CAPACITY
+#define BUTTON_DELEGATE_CAPACITY (2 * sizeof(void *)) // Bytes of captured context stored inline by a ButtonDelegate
+#endif
+
+/**
+ * @brief Callback holding its context inline.
+ *
+ * @details Stores a lambda with captures, a bound member function or a function pointer with
+ * its void pointer parameter in BUTTON_DELEGATE_CAPACITY bytes inside the object, next to one
+ * function pointer that invokes it. Nothing is allocated and calling it costs one indirect
+ * call, like the function pointer it replaces. Callables must be trivially copyable and fit
+ * the capacity, both checked at compile time: capture pointers or references to larger
+ * contexts rather than the contexts themselves.
+ *
+ * @tparam Args Types of the arguments passed to the callback.
+ */
+template <typename... Args>
+class ButtonDelegate
+{
+private:
+    typedef void (*Invoker)(void *, Args...);
+    typedef void (*Function)(Args..., void *);
+
+    /**
+     * @brief A function pointer with its void pointer parameter.
+     */
+    struct FunctionWithParameter
+    {
+        Function function; // The function
+        void *parameter;   // Its parameter
+    };
+
+    mutable typename std::aligned_storage<BUTTON_DELEGATE_CAPACITY, alignof(void *)>::type _storage; // Captured context of the callable
+    Invoker _invoke = nullptr;                                                                       // Invokes the stored callable, nullptr when empty
+
+    template <typename Callable>
+    static void invokeCallable(void *storage, Args... args)
+    {
+        (*static_cast<Callable *>(storage))(args...);
+    }
+
+    static void invokeFunction(void *storage, Args... args)
+    {
+        FunctionWithParameter const *stored = static_cast<FunctionWithParameter const *>(storage);
+        stored->function(args..., stored->parameter);
+    }
+
+    template <typename Object, void (Object::*Method)(Args...)>
+    static void invokeMethod(void *storage, Args... args)
+    {
+        (*static_cast<Object **>(storage)->*Method)(args...);
+    }
+
+    template <typename Callable>
+    void store(Callable const &callable, Invoker invoke)
+    {
+        static_assert(sizeof(Callable) <= BUTTON_DELEGATE_CAPACITY, "Callable context exceeds BUTTON_DELEGATE_CAPACITY, capture a pointer to it instead");
+        static_assert(alignof(Callable) <= alignof(void *), "Callable context is over-aligned");
+        static_assert(std::is_trivially_copyable<Callable>::value, "Callable must be trivially copyable, capture pointers or references only");
+        new (&_storage) Callable(callable);
+        _invoke = invoke;
+    }
+
+public:
+    /**
+     * @brief Constructs an empty delegate.
+     */
+    ButtonDelegate() = default;
+
+    /**
+     * @brief Constructs an empty delegate.
+     */
+    ButtonDelegate(std::nullptr_t) {}
+
+    /**
+     * @brief Constructs a delegate from a function pointer and its void pointer parameter.
+     *
+     * @param function The function, taking the arguments then the parameter, or nullptr for an empty delegate.
+     * @param parameter The void pointer parameter for the function.
+     */
+    ButtonDelegate(Function function, void *parameter)
+    {
+        if (function != nullptr)
+            store(FunctionWithParameter{function, parameter}, &invokeFunction);
+    }
+
+    /**
+     * @brief Constructs a delegate from a callable, typically a lambda with captures.
+     *
+     * @param callable The callable, copied into the delegate.
+     */
+    template <typename Callable,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, ButtonDelegate>::value>::type,
+              typename = decltype(std::declval<Callable &>()(std::declval<Args>()...))>
+    ButtonDelegate(Callable const &callable)
+    {
+        store(callable, &invokeCallable<Callable>);
+    }
+
+    /**
+     * @brief Makes a delegate calling a member function of an object.
+     *
+     * @details Only the object pointer is stored, the member function is part of the type of
+     * the invoker. Usage: ButtonDelegate<>::bind<Light, &Light::toggle>(&light).
+     *
+     * @tparam Object Class of the object.
+     * @tparam Method The member function.
+     * @param object The object, which must outlive the delegate.
+     * @return The delegate.
+     */
+    template <typename Object, void (Object::*Method)(Args...)>
+    static ButtonDelegate bind(Object *object)
+    {
+        ButtonDelegate delegate;
+        delegate.store(object, &invokeMethod<Object, Method>);
+        return delegate;
+    }
+
+    /**
+     * @brief Checks if the delegate holds a callable.
+     *
+     * @return true if the delegate holds a callable, false if it is empty.
+     */
+    explicit operator bool() const { return _invoke != nullptr; }
+
+    /**
+     * @brief Invokes the callable, which must not be empty.
+     *
+     * @param args The arguments passed to the callable.
+     */
+    void operator()(Args... args) const { _invoke(&_storage, args...); }
+};
+
+/**
+ * @brief Callback of the single, double and long press events.
+ */
+typedef ButtonDelegate<> ButtonCallback;
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file ButtonEventQueue.hpp
+ * @brief Defines the ButtonEventQueue class
+ * @details Header-only lock-free single producer, single consumer ring of button events
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint32_t
+
+#include "ButtonStateMachine.hpp"
+#include "SpscRing.hpp"
+
+/**
+ * @brief Compact record of a detected button event.
+ */
+struct ButtonEvent
+{
+    uint32_t timestamp;             // Time of the sample that completed the event, in milliseconds
+    uint8_t buttonId;               // Identifier given to the button when the queue was set
+    ButtonStateMachine::Event type; // Single, double or long press
+    uint32_t captureMicros;         // Time of the last pin edge before the event, in microseconds
+    uint32_t dispatchMicros;        // Time the event was queued, in microseconds
+};
+
+/**
+ * @brief Fixed-size lock-free ring of button events.
+ *
+ * @details Events are pushed by exactly one producer task, either the listening task of a
+ * ButtonModule or a ButtonScanner polling several buttons, and popped by exactly one consumer
+ * task. Neither side ever blocks: when the ring is full new events are dropped and counted,
+ * see SpscRing. The storage is provided by the caller, see StaticButtonEventQueue.
+ */
+class ButtonEventQueue : public SpscRing<ButtonEvent>
+{
+public:
+    /**
+     * @brief Constructor for ButtonEventQueue.
+     *
+     * @param buffer Storage for the ring.
+     * @param capacity Number of events the storage holds, must be a power of two.
+     */
+    ButtonEventQueue(ButtonEvent *buffer, uint32_t capacity)
+        : SpscRing<ButtonEvent>(buffer, capacity) {}
+};
+
+/**
+ * @brief ButtonEventQueue with inline storage.
+ *
+ * @tparam Capacity Number of events the queue holds, must be a power of two.
+ */
+template <uint32_t Capacity>
+class StaticButtonEventQueue : public ButtonEventQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    ButtonEvent _storage[Capacity]; // Ring storage
+
+public:
+    StaticButtonEventQueue() : ButtonEventQueue(_storage, Capacity) {}
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+/**
+ * @file ButtonGroup.hpp
+ * @brief Defines the ButtonGroup class
+ * @details Header file declaring a group of buttons with packed per-button state and central callbacks
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <MultiPrinterLoggerInterface.hpp> // MultiPrinterLoggerInterface
+#include <TaskTracker.hpp>
+
+#include "ButtonDelegate.hpp"
+#include "ButtonHalInterface.hpp"
+#include "ButtonStateMachine.hpp"
+#include "PackedButtonStateMachine.hpp"
+
+/**
+ * @brief Callback of a ButtonGroup, taking the button index and the event.
+ */
+typedef ButtonDelegate<uint16_t, ButtonStateMachine::Event> ButtonGroupCallback;
+
+/**
+ * @brief Many buttons sharing timings, a callback and one scan.
+ *
+ * @details Where a ButtonModule holds its own callbacks, timings, logger, timestamps and
+ * task, a group holds those once and keeps 5 bytes per button: a PackedButtonStateMachine,
+ * whose phase, press count and flags fit one byte next to a 16 bit relative timestamp, and
+ * the pin. A bit per button marks the presses in progress, so a scan only runs the buttons
+ * that are pressed or active; released, idle buttons cost nothing. The storage is provided
+ * by the caller, see StaticButtonGroup.
+ *
+ * Buttons are either wired to GPIOs, read once per scan with ButtonHalInterface::readPins(),
+ * or fed by the owner as bitmaps of pressed levels, e.g. replayed from remote panels.
+ */
+class ButtonGroup
+{
+public:
+    static uint8_t const NO_PIN = 0xFF; // Pin of a button fed through update() only
+
+private:
+    MultiPrinterLoggerInterface *const _logger; // Logger for logging
+    ButtonHalInterface *const _hal;             // Time source and pin access
+
+    PackedButtonStateMachine *const _states; // Press detection state of every button
+    uint8_t *const _pins;                    // Pin of every button, bit 7 set for buttons pressed low, or NO_PIN
+    uint32_t *const _activeWords;            // Buttons with a press in progress, one bit per button
+    uint16_t const _buttonCount;             // Number of buttons
+
+    ButtonGroupCallback _callback; // Callback for the events of every button
+    ButtonTimings _timings;        // Debounce, long press and double press timings of every button
+    uint8_t _enabledEvents = 0x07; // Mask of the reported events, all by default
+
+    uint8_t _checkInterval = 30;               // Check interval of the scanner task
+    TaskHandle_t _scannerTaskHandle = nullptr; // Task handle for the scanner task
+
+    /**
+     * @brief Scanner task.
+     *
+     * @details This task scans the pins of the group once per check interval.
+     */
+    void scannerTask();
+    void updateWord(uint32_t now, uint16_t word, uint32_t pressed, uint8_t enabledEvents);
+
+protected:
+    /**
+     * @brief Constructor for ButtonGroup.
+     *
+     * @param states Storage for the state of every button.
+     * @param pins Storage for the pin of every button.
+     * @param activeWords Storage for one bit per button, (buttonCount + 31) / 32 words.
+     * @param buttonCount Number of buttons.
+     * @param logger Logger for logging.
+     * @param hal Time source and pin access, defaults to the Arduino GPIOs.
+     */
+    ButtonGroup(
+        PackedButtonStateMachine *states, uint8_t *pins, uint32_t *activeWords, uint16_t buttonCount,
+        MultiPrinterLoggerInterface *const logger, ButtonHalInterface *const hal);
+
+public:
+    ButtonGroup(ButtonGroup const &) = delete;
+    ButtonGroup &operator=(ButtonGroup const &) = delete;
+
+    /**
+     * @brief Destructor for ButtonGroup.
+     *
+     * @details Stops scanning.
+     */
+    ~ButtonGroup();
+
+    /**
+     * @brief Wires a button to a GPIO read by scan().
+     *
+     * @param button The button index.
+     * @param pin The pin, 0 to 63, or NO_PIN.
+     * @param onRaising Flag indicating whether the button triggers on raising or falling edge.
+     */
+    void setPin(uint16_t button, uint8_t pin, bool onRaising = true);
+
+    /**
+     * @brief Sets the callback for the events of every button.
+     *
+     * @param callback The callback, taking the button index and the event.
+     */
+    void onEvent(ButtonGroupCallback const &callback);
+
+    /**
+     * @brief Sets the timings shared by all buttons.
+     *
+     * @param debounceTime The debounce time for button triggers.
+     * @param longPressTime The long press time for button triggers.
+     * @param timeBetweenDoublePress The time between double presses for button triggers.
+     */
+    void setTimings(uint8_t debounceTime = 90, uint16_t longPressTime = 1000, uint16_t timeBetweenDoublePress = 500);
+
+    /**
+     * @brief Sets the events reported for every button.
+     *
+     * @param events Mask of ButtonStateMachine::EnabledEvent bits.
+     */
+    void setEnabledEvents(uint8_t events);
+
+    /**
+     * @brief Gets the number of buttons.
+     *
+     * @return The number of buttons.
+     */
+    uint16_t getButtonCount() const;
+
+    /**
+     * @brief Checks if a button has a press in progress.
+     *
+     * @param button The button index.
+     * @return true if the button is pressed or waits for its double press window, false otherwise.
+     */
+    bool isActive(uint16_t button) const;
+
+    /**
+     * @brief Feeds one sample of every button.
+     *
+     * @param now Timestamp of the sample in milliseconds.
+     * @param pressed Pressed level of every button, bit i % 32 of word i / 32 for button i.
+     */
+    void update(uint32_t now, uint32_t const *pressed);
+
+    /**
+     * @brief Samples the pins of the group once and feeds them.
+     *
+     * @details Called by the scanner task every check interval, or directly by an owner that
+     * drives the group from its own loop instead of starting the task.
+     */
+    void scan();
+
+    /**
+     * @brief Starts the scanner task.
+     *
+     * @param usStackDepth Stack depth for the task.
+     * @param taskName The name of the task.
+     * @param checkInterval The check interval for button triggers.
+     */
+    void startScanning(uint16_t usStackDepth = 3000, char const *taskName = nullptr, uint8_t checkInterval = 30);
+
+    /**
+     * @brief Stops the scanner task.
+     */
+    void stopScanning();
+};
+
+/**
+ * @brief ButtonGroup with statically sized storage.
+ *
+ * @tparam ButtonCount Number of buttons.
+ */
+template <uint16_t ButtonCount>
+class StaticButtonGroup : public ButtonGroup
+{
+    static_assert(ButtonCount > 0, "A group needs at least one button");
+
+private:
+    PackedButtonStateMachine _stateStorage[ButtonCount]; // State of every button
+    uint8_t _pinStorage[ButtonCount];                    // Pin of every button
+    uint32_t _activeStorage[(ButtonCount + 31) / 32];    // One bit per button
+
+public:
+    /**
+     * @brief Constructor for StaticButtonGroup.
+     *
+     * @param logger Logger for logging.
+     * @param hal Time source and pin access, defaults to the Arduino GPIOs.
+     */
+    StaticButtonGroup(MultiPrinterLoggerInterface *const logger = nullptr, ButtonHalInterface *const hal = nullptr)
+        : ButtonGroup(_stateStorage, _pinStorage, _activeStorage, ButtonCount, logger, hal) {}
+};
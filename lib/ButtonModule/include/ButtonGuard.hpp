@@ -0,0 +1,177 @@
+#pragma once
+
+/**
+ * @file ButtonGuard.hpp
+ * @brief Defines the ButtonGuard class
+ * @details Header file declaring the rate limiting, storm and stuck input quarantine of a button
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <atomic>
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#include "ButtonDelegate.hpp"
+#include "ButtonSeqlock.hpp"
+
+/**
+ * @brief Summary of a quarantine, reported when it starts and when it ends.
+ */
+struct ButtonGuardReport
+{
+    /**
+     * @brief Why the button was quarantined.
+     */
+    enum class Reason : uint8_t
+    {
+        STORM, // More events than the rate limit allows
+        STUCK, // Pressed for longer than the stuck time
+    };
+
+    Reason reason;             // Why the button was quarantined
+    bool quarantined;          // true when the quarantine starts, false when the button recovered
+    uint32_t suppressedEvents; // Events coalesced into this report since the quarantine started
+    uint32_t duration;         // Milliseconds since the quarantine started
+};
+
+/**
+ * @brief Callback of a ButtonGuard, taking the report.
+ */
+typedef ButtonDelegate<ButtonGuardReport const &> ButtonGuardCallback;
+
+/**
+ * @brief Counters of a ButtonGuard.
+ */
+struct ButtonGuardCounters
+{
+    uint32_t admittedEvents;   // Events passed to the callbacks
+    uint32_t suppressedEvents; // Events over the rate limit or during a quarantine
+    uint32_t storms;           // Quarantines for exceeding the rate limit
+    uint32_t stuckInputs;      // Quarantines for a stuck input
+    uint32_t quarantineTime;   // Milliseconds spent in ended quarantines
+};
+
+/**
+ * @brief Rate limiting and quarantine of a noisy or stuck button.
+ *
+ * @details Events pass a token bucket refilled with maxEventsPerSecond tokens per second and
+ * holding at most burst of them. The first event finding the bucket empty starts a STORM
+ * quarantine: detection goes on, but the events are counted instead of dispatched. A button
+ * held pressed for stuckTime starts a STUCK quarantine: its samples are ignored and the
+ * detection forgets the press, so the polling task stops following it and nothing repeats.
+ * A storm turning into a stuck input becomes a STUCK quarantine. Either quarantine ends once
+ * the button has been released for recoveryTime. Instead of the suppressed events, the
+ * callback receives one report when a quarantine starts and one when it ends, with the
+ * number of events coalesced meanwhile.
+ *
+ * The guard is fed by the task polling the button, see ButtonModule::setGuard(); any task
+ * reads the counters and isQuarantined(). A zero limit disables that check.
+ */
+class ButtonGuard
+{
+private:
+    uint8_t _maxEventsPerSecond;   // Rate the bucket refills at, 0 for no rate limit
+    uint8_t _burst;                // Events the bucket holds
+    uint32_t _stuckTime;           // Milliseconds pressed before a STUCK quarantine, 0 for no stuck detection
+    uint16_t _recoveryTime;        // Milliseconds released to end a quarantine
+    ButtonGuardCallback _callback; // Callback for the quarantine reports
+
+    uint32_t _tokens = 0;                                                 // Events left in the bucket, in thousandths
+    uint32_t _refillTime = 0;                                             // Time of the last refill, in milliseconds
+    bool _pressed = false;                                                // Level of the last sample
+    uint32_t _levelTime = 0;                                              // Time the level of the last sample started, in milliseconds
+    bool _quarantined = false;                                            // A quarantine is in progress
+    ButtonGuardReport::Reason _reason = ButtonGuardReport::Reason::STORM; // Why, while quarantined
+    uint32_t _quarantineStart = 0;                                        // Time the quarantine started, in milliseconds
+    uint32_t _quarantineEvents = 0;                                       // Events suppressed since the quarantine started
+
+    std::atomic<bool> _quarantinedFlag{false};  // _quarantined, for other tasks
+    ButtonSeqlock _sequence;                    // Brackets the updates of the counters
+    std::atomic<uint32_t> _admittedEvents{0};   // ButtonGuardCounters::admittedEvents
+    std::atomic<uint32_t> _suppressedEvents{0}; // ButtonGuardCounters::suppressedEvents
+    std::atomic<uint32_t> _storms{0};           // ButtonGuardCounters::storms
+    std::atomic<uint32_t> _stuckInputs{0};      // ButtonGuardCounters::stuckInputs
+    std::atomic<uint32_t> _quarantineTime{0};   // ButtonGuardCounters::quarantineTime
+
+    void startQuarantine(uint32_t now, ButtonGuardReport::Reason reason);
+    void endQuarantine(uint32_t now);
+
+public:
+    /**
+     * @brief Constructor for ButtonGuard.
+     *
+     * @param maxEventsPerSecond Events per second refilling the bucket, 0 for no rate limit.
+     * @param burst Events the bucket holds, passed at once after a quiet period.
+     * @param stuckTime Milliseconds pressed before the input counts as stuck, 0 for no stuck detection.
+     * @param recoveryTime Milliseconds released to end a quarantine.
+     */
+    ButtonGuard(uint8_t maxEventsPerSecond = 5, uint8_t burst = 10, uint32_t stuckTime = 30000, uint16_t recoveryTime = 2000);
+
+    ButtonGuard(ButtonGuard const &) = delete;
+    ButtonGuard &operator=(ButtonGuard const &) = delete;
+
+    /**
+     * @brief Changes the limits. Set them before the guard is attached to a button.
+     *
+     * @param maxEventsPerSecond Events per second refilling the bucket, 0 for no rate limit.
+     * @param burst Events the bucket holds, passed at once after a quiet period.
+     * @param stuckTime Milliseconds pressed before the input counts as stuck, 0 for no stuck detection.
+     * @param recoveryTime Milliseconds released to end a quarantine.
+     */
+    void setLimits(uint8_t maxEventsPerSecond = 5, uint8_t burst = 10, uint32_t stuckTime = 30000, uint16_t recoveryTime = 2000);
+
+    /**
+     * @brief Sets the callback for the quarantine reports.
+     *
+     * @details Called on the task polling the button. Set it before the guard is attached.
+     *
+     * @param callback The callback, taking the report.
+     */
+    void onReport(ButtonGuardCallback const &callback);
+
+    /**
+     * @brief Feeds the debounced level of a sample. Must only be called by the polling task.
+     *
+     * @param now Time of the sample in milliseconds.
+     * @param pressed The debounced level, true for pressed.
+     * @return true if the sample goes on to the detection, false during a STUCK quarantine.
+     */
+    bool admitSample(uint32_t now, bool pressed);
+
+    /**
+     * @brief Takes a token for an event. Must only be called by the polling task.
+     *
+     * @param now Time of the event in milliseconds.
+     * @return true if the event is dispatched, false if it is suppressed.
+     */
+    bool admitEvent(uint32_t now);
+
+    /**
+     * @brief Gets the time until a stuck input or a recovery is due, without a pin change.
+     *
+     * @param now The current time in milliseconds.
+     * @return Milliseconds until the next check is due, 0 if it is, or ButtonStateMachine::NO_DEADLINE.
+     */
+    uint32_t timeToDeadline(uint32_t now) const;
+
+    /**
+     * @brief Checks if a quarantine is in progress. Safe from any task.
+     *
+     * @return true between the start and end reports of a quarantine, false otherwise.
+     */
+    bool isQuarantined() const;
+
+    /**
+     * @brief Copies all counters at once. Safe from any task.
+     *
+     * @details Retries a copy overlapping an update, yielding to the polling task in between.
+     *
+     * @param counters Receives the counters.
+     * @return true if the counters are consistent, false if the polling task kept updating them.
+     */
+    bool getCounters(ButtonGuardCounters &counters) const;
+
+    /**
+     * @brief Ends any quarantine without a report and refills the bucket. Must not run while the button is polled.
+     */
+    void reset();
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+/**
+ * @file ButtonHalInterface.hpp
+ * @brief Defines the ButtonHalInterface class
+ * @details Header file declaring the abstract time source and pin access used by ButtonModule
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint32_t, uint64_t
+
+/**
+ * @brief Interface for the hardware used by button modules.
+ *
+ * @details ButtonModule reads time and pin levels only through this interface, so it can run
+ * on the GPIOs of the board (ArduinoButtonHal) or on a simulated backend stepped in virtual
+ * time (SimulatedButtonHal).
+ */
+class ButtonHalInterface
+{
+public:
+    /**
+     * @brief Virtual destructor for ButtonHalInterface.
+     */
+    virtual ~ButtonHalInterface() = default;
+
+    /**
+     * @brief Gets the current time.
+     *
+     * @return Milliseconds since start, wrapping around like millis().
+     */
+    virtual uint32_t now() = 0;
+
+    /**
+     * @brief Gets the current time in microseconds.
+     *
+     * @details Used to timestamp pin edges and event dispatch. Backends with a microsecond
+     * timer override this; the default scales now(). On the ESP32 the pin interrupt reads
+     * esp_timer_get_time() itself rather than calling this, so backends used there must
+     * count from the same time base, as ArduinoButtonHal does.
+     *
+     * @return Microseconds since start, wrapping around like micros().
+     */
+    virtual uint32_t micros() { return now() * 1000; }
+
+    /**
+     * @brief Configures a pin as a button input.
+     *
+     * @param pin The pin to configure.
+     */
+    virtual void setupPin(uint8_t pin) = 0;
+
+    /**
+     * @brief Reads the level of a pin.
+     *
+     * @param pin The pin to read.
+     * @return true if the pin is high, false otherwise.
+     */
+    virtual bool readPin(uint8_t pin) = 0;
+
+    /**
+     * @brief Reads the level of all pins at once.
+     *
+     * @details Backends that can read the GPIO input registers directly override this; the
+     * default reads pin by pin.
+     *
+     * @return Bit n is set if pin n is high, for pins 0 to 63.
+     */
+    virtual uint64_t readPins()
+    {
+        uint64_t levels = 0;
+        for (uint8_t pin = 0; pin < 64; pin++)
+            if (readPin(pin))
+                levels |= uint64_t(1) << pin;
+        return levels;
+    }
+
+    /**
+     * @brief Configures a pin as an output driving a row of a ButtonMatrix.
+     *
+     * @details Only needed by ButtonMatrix; the default does nothing.
+     *
+     * @param pin The pin to configure.
+     */
+    virtual void setupOutputPin(uint8_t pin) { (void)pin; }
+
+    /**
+     * @brief Drives an output pin.
+     *
+     * @details Only needed by ButtonMatrix; the default does nothing.
+     *
+     * @param pin The pin to drive.
+     * @param level true for high, false for low.
+     */
+    virtual void writePin(uint8_t pin, bool level)
+    {
+        (void)pin;
+        (void)level;
+    }
+
+    /**
+     * @brief Busy-waits for the levels to settle after driving a pin.
+     *
+     * @details Only needed by ButtonMatrix; the default returns at once, as simulated
+     * backends have nothing to settle.
+     *
+     * @param microseconds The time to wait, in microseconds.
+     */
+    virtual void delayMicroseconds(uint32_t microseconds) { (void)microseconds; }
+
+    /**
+     * @brief Configures a pin to wake the chip from sleep.
+     *
+     * @details Only needed by ButtonModule::enableWakeup(); the default supports no sleep.
+     *
+     * @param pin The pin of the button.
+     * @param level The level that wakes the chip, true for high.
+     * @param deepSleep true to wake from deep sleep, false to wake from light sleep.
+     * @return true if the pin can wake the chip from that sleep, false otherwise.
+     */
+    virtual bool enableWakeup(uint8_t pin, bool level, bool deepSleep)
+    {
+        (void)pin;
+        (void)level;
+        (void)deepSleep;
+        return false;
+    }
+
+    /**
+     * @brief Stops a pin from waking the chip from either sleep.
+     *
+     * @details Only needed by ButtonModule::disableWakeup(); the default does nothing.
+     *
+     * @param pin The pin of the button.
+     */
+    virtual void disableWakeup(uint8_t pin) { (void)pin; }
+
+    /**
+     * @brief Checks if a pin woke the chip from its last sleep.
+     *
+     * @details Only needed by ButtonModule::handleWakeup(); the default reports no wakeup.
+     *
+     * @param pin The pin of the button.
+     * @return true if the last wakeup was caused by the pin, false otherwise.
+     */
+    virtual bool wasWakeupSource(uint8_t pin)
+    {
+        (void)pin;
+        return false;
+    }
+
+    /**
+     * @brief Calls a handler on every level change of a pin.
+     *
+     * @param pin The pin to watch.
+     * @param handler The handler, called from interrupt context.
+     * @param arg The parameter for the handler.
+     */
+    virtual void attachPinInterrupt(uint8_t pin, void (*handler)(void *), void *arg) = 0;
+
+    /**
+     * @brief Stops calling the handler attached to a pin.
+     *
+     * @param pin The pin to stop watching.
+     */
+    virtual void detachPinInterrupt(uint8_t pin) = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file ButtonLog.hpp
+ * @brief Compile-time log level of the ButtonModule library
+ * @details Wraps the MultiPrinterLogger macros so that calls below BUTTON_LOG_LEVEL are
+ * removed by the preprocessor, together with their format strings and the logger check.
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <MultiPrinterLoggerInterface.hpp> // Log_Error, Log_Warning, Log_Info, Log_Debug, Log_Verbose
+
+#define BUTTON_LOG_LEVEL_NONE 0
+#define BUTTON_LOG_LEVEL_ERROR 1
+#define BUTTON_LOG_LEVEL_WARNING 2
+#define BUTTON_LOG_LEVEL_INFO 3
+#define BUTTON_LOG_LEVEL_DEBUG 4
+#define BUTTON_LOG_LEVEL_VERBOSE 5
+
+#ifndef BUTTON_LOG_LEVEL
+#define BUTTON_LOG_LEVEL BUTTON_LOG_LEVEL_VERBOSE // Most detailed level compiled in, e.g. -D BUTTON_LOG_LEVEL=0 for none
+#endif
+
+#if BUTTON_LOG_LEVEL >= BUTTON_LOG_LEVEL_ERROR
+#define BUTTON_LOG_ERROR(logger, ...) Log_Error(logger, __VA_ARGS__)
+#else
+#define BUTTON_LOG_ERROR(logger, ...) ((void)0)
+#endif
+
+#if BUTTON_LOG_LEVEL >= BUTTON_LOG_LEVEL_WARNING
+#define BUTTON_LOG_WARNING(logger, ...) Log_Warning(logger, __VA_ARGS__)
+#else
+#define BUTTON_LOG_WARNING(logger, ...) ((void)0)
+#endif
+
+#if BUTTON_LOG_LEVEL >= BUTTON_LOG_LEVEL_INFO
+#define BUTTON_LOG_INFO(logger, ...) Log_Info(logger, __VA_ARGS__)
+#else
+#define BUTTON_LOG_INFO(logger, ...) ((void)0)
+#endif
+
+#if BUTTON_LOG_LEVEL >= BUTTON_LOG_LEVEL_DEBUG
+#define BUTTON_LOG_DEBUG(logger, ...) Log_Debug(logger, __VA_ARGS__)
+#else
+#define BUTTON_LOG_DEBUG(logger, ...) ((void)0)
+#endif
+
+#if BUTTON_LOG_LEVEL >= BUTTON_LOG_LEVEL_VERBOSE
+#define BUTTON_LOG_VERBOSE(logger, ...) Log_Verbose(logger, __VA_ARGS__)
+#else
+#define BUTTON_LOG_VERBOSE(logger, ...) ((void)0)
+#endif
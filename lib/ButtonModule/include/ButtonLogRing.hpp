@@ -0,0 +1,117 @@
+#pragma once
+
+/**
+ * @file ButtonLogRing.hpp
+ * @brief Defines the ButtonLogRing class
+ * @details Header-only lock-free ring of binary log records, formatted off the hot path
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint8_t, uint32_t
+#include <stdio.h>  // snprintf
+
+#include "SpscRing.hpp"
+
+/**
+ * @brief Binary log record: a message identifier and its arguments, no text.
+ */
+struct ButtonLogRecord
+{
+    /**
+     * @brief Message of a record, each with a fixed format.
+     */
+    enum class Id : uint8_t
+    {
+        SINGLE_PRESS,  // Single press detected, arg is the latency in microseconds
+        DOUBLE_PRESS,  // Double press detected, arg is the latency in microseconds
+        LONG_PRESS,    // Long press detected, arg is the latency in microseconds
+        EVENT_DROPPED, // Event queue full, arg is the number of dropped events
+        GESTURE,       // Gesture detected, arg is the index of the gesture
+    };
+
+    uint32_t timestamp; // Time of the record, in milliseconds
+    Id id;              // Message
+    uint8_t pin;        // Pin of the button
+    uint32_t arg;       // Argument of the message
+};
+
+/**
+ * @brief Fixed-size lock-free ring of binary log records.
+ *
+ * @details The polling task pushes a few bytes per message instead of formatting text; any
+ * other single task pops and formats them later with popFormatted(). Like ButtonEventQueue,
+ * it is a SpscRing: one producer and one consumer, never blocking, counting the records
+ * dropped while it is full. The storage is provided by the caller, see StaticButtonLogRing.
+ */
+class ButtonLogRing : public SpscRing<ButtonLogRecord>
+{
+public:
+    /**
+     * @brief Constructor for ButtonLogRing.
+     *
+     * @param buffer Storage for the ring.
+     * @param capacity Number of records the storage holds, must be a power of two.
+     */
+    ButtonLogRing(ButtonLogRecord *buffer, uint32_t capacity)
+        : SpscRing<ButtonLogRecord>(buffer, capacity) {}
+
+    /**
+     * @brief Removes the oldest record and formats it as text. Must only be called by the consumer.
+     *
+     * @param text Receives the message, truncated to the size.
+     * @param size Size of the text buffer.
+     * @return true if a record was removed, false if the ring was empty.
+     */
+    bool popFormatted(char *text, size_t size)
+    {
+        ButtonLogRecord record;
+        if (!pop(record))
+            return false;
+        format(record, text, size);
+        return true;
+    }
+
+    /**
+     * @brief Formats a record as text.
+     *
+     * @param record The record.
+     * @param text Receives the message, truncated to the size.
+     * @param size Size of the text buffer.
+     */
+    static void format(ButtonLogRecord const &record, char *text, size_t size)
+    {
+        static char const *const formats[] = {
+            "[%lu] Button %u: single press detected, latency %lu us",
+            "[%lu] Button %u: double press detected, latency %lu us",
+            "[%lu] Button %u: long press detected, latency %lu us",
+            "[%lu] Button %u: event queue full, %lu events dropped",
+            "[%lu] Button %u: gesture %lu detected",
+        };
+        uint8_t id = static_cast<uint8_t>(record.id);
+        if (id >= sizeof(formats) / sizeof(formats[0]))
+        {
+            snprintf(text, size, "[%lu] Button %u: unknown message %u", (unsigned long)record.timestamp, record.pin, id);
+            return;
+        }
+        snprintf(text, size, formats[id], (unsigned long)record.timestamp, record.pin, (unsigned long)record.arg);
+    }
+};
+
+/**
+ * @brief ButtonLogRing with inline storage.
+ *
+ * @tparam Capacity Number of records the ring holds, must be a power of two.
+ */
+template <uint32_t Capacity>
+class StaticButtonLogRing : public ButtonLogRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    ButtonLogRecord _storage[Capacity]; // Ring storage
+
+public:
+    StaticButtonLogRing() : ButtonLogRing(_storage, Capacity) {}
+};
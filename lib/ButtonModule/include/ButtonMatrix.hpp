@@ -0,0 +1,180 @@
+#pragma once
+
+/**
+ * @file ButtonMatrix.hpp
+ * @brief Defines the ButtonMatrix class
+ * @details Header file declaring a keypad scanner running the ButtonModule classification for every key
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <MultiPrinterLoggerInterface.hpp> // MultiPrinterLoggerInterface
+#include <TaskTracker.hpp>
+
+#include "BitParallelDebouncer.hpp"
+#include "ButtonHalInterface.hpp"
+#include "ButtonStateMachine.hpp"
+#include "PackedButtonStateMachine.hpp"
+
+#define BUTTON_MATRIX_MAX_LINES 8 // Maximum number of rows and of columns
+
+#ifndef BUTTON_MATRIX_FILTER_SAMPLES
+#define BUTTON_MATRIX_FILTER_SAMPLES 2 // Equal samples needed to change the filtered level of a key
+#endif
+
+#ifndef BUTTON_MATRIX_SETTLE_MICROS
+#define BUTTON_MATRIX_SETTLE_MICROS 5 // Default wait between driving a row and reading the columns, in microseconds
+#endif
+
+/**
+ * @brief Row and column scanning of a keypad.
+ *
+ * @details The rows are outputs, idle high and driven low one at a time; the columns are
+ * inputs with pull-up resistors, so a pressed key pulls its column low while its row is
+ * driven. Every scan reads the columns once per row, filters all keys together with a
+ * BitParallelDebouncer, and runs a PackedButtonStateMachine per key, 4 bytes each, with the
+ * single, double and long press classification of ButtonModule. Keys that are released and
+ * idle cost nothing. One task scans the whole matrix, up to 8x8 keys.
+ *
+ * Without a diode per key, three pressed corners of a rectangle make the fourth look pressed.
+ * Anti-ghosting, on by default, detects such rectangles and keeps the keys involved in their
+ * previous state until the reading is unambiguous again.
+ */
+class ButtonMatrix
+{
+private:
+    MultiPrinterLoggerInterface *const _logger; // Logger for logging
+    ButtonHalInterface *const _hal;             // Time source and pin access
+
+    uint8_t _rowPins[BUTTON_MATRIX_MAX_LINES];    // Pins of the rows, driven by the matrix
+    uint8_t _columnPins[BUTTON_MATRIX_MAX_LINES]; // Pins of the columns, read by the matrix
+    uint8_t _rowCount;                            // Number of rows
+    uint8_t _columnCount;                         // Number of columns
+
+    void (*_keyCallback)(uint8_t, ButtonStateMachine::Event, void *) = nullptr; // Callback function for key events
+    void *_keyCallbackParameter = nullptr;                                      // Parameter for the callback function for key events
+
+    ButtonTimings _timings;                                                    // Debounce, long press and double press timings of every key
+    uint8_t _enabledEvents = 0x07;                                             // Mask of the reported events, all by default
+    bool _antiGhosting = true;                                                 // Keep keys of ambiguous readings in their previous state
+    uint8_t _settleMicros = BUTTON_MATRIX_SETTLE_MICROS;                       // Wait between driving a row and reading the columns, in microseconds
+    BitParallelDebouncer<uint64_t, BUTTON_MATRIX_FILTER_SAMPLES> _levelFilter; // Filtered pressed level, one bit per key
+
+    PackedButtonStateMachine _keys[BUTTON_MATRIX_MAX_LINES * BUTTON_MATRIX_MAX_LINES]; // Press detection state of every key
+    uint64_t _activeKeys = 0;                                                          // Keys with a press in progress, one bit per key
+
+    uint8_t _checkInterval = 30;               // Check interval of the scanner task
+    TaskHandle_t _scannerTaskHandle = nullptr; // Task handle for the scanner task
+
+    /**
+     * @brief Scanner task.
+     *
+     * @details This task scans the matrix once per check interval.
+     */
+    void scannerTask();
+    uint64_t readKeys();
+    uint64_t ambiguousKeys(uint64_t pressed) const;
+
+public:
+    /**
+     * @brief Constructor for ButtonMatrix.
+     *
+     * @param rowPins Pins of the rows.
+     * @param rowCount Number of rows, at most BUTTON_MATRIX_MAX_LINES.
+     * @param columnPins Pins of the columns.
+     * @param columnCount Number of columns, at most BUTTON_MATRIX_MAX_LINES.
+     * @param logger Logger for logging.
+     * @param hal Time source and pin access, defaults to the Arduino GPIOs.
+     */
+    ButtonMatrix(
+        uint8_t const *rowPins, uint8_t rowCount, uint8_t const *columnPins, uint8_t columnCount,
+        MultiPrinterLoggerInterface *const logger = nullptr, ButtonHalInterface *const hal = nullptr);
+
+    /**
+     * @brief Destructor for ButtonMatrix.
+     *
+     * @details Stops scanning.
+     */
+    ~ButtonMatrix();
+
+    /**
+     * @brief Sets the callback function for key events.
+     *
+     * @param callback The callback function, taking the key index (row * column count + column), the event and a void pointer.
+     * @param _pParameter The void pointer parameter for the callback function.
+     */
+    void onKeyEvent(void (*callback)(uint8_t, ButtonStateMachine::Event, void *), void *_pParameter = nullptr);
+
+    /**
+     * @brief Sets the timings shared by all keys.
+     *
+     * @param debounceTime The debounce time for key triggers.
+     * @param longPressTime The long press time for key triggers.
+     * @param timeBetweenDoublePress The time between double presses for key triggers.
+     */
+    void setTimings(uint8_t debounceTime = 90, uint16_t longPressTime = 1000, uint16_t timeBetweenDoublePress = 500);
+
+    /**
+     * @brief Sets the events reported for every key.
+     *
+     * @details Like ButtonModule, a press is classified depending on the events reported, e.g.
+     * a single press is reported on release when double press is not.
+     *
+     * @param events Mask of ButtonStateMachine::EnabledEvent bits.
+     */
+    void setEnabledEvents(uint8_t events);
+
+    /**
+     * @brief Enables or disables anti-ghosting.
+     *
+     * @param enabled false for keypads with a diode per key, where every combination of keys reads correctly.
+     */
+    void setAntiGhosting(bool enabled);
+
+    /**
+     * @brief Sets the wait between driving a row low and reading the columns.
+     *
+     * @details The columns take a moment to follow the row through the pull-up resistors and
+     * the wiring capacitance; reading them too early misses keys of the row or sees keys of the
+     * previous one. Every scan waits this long once per row.
+     *
+     * @param microseconds The settle time, 0 to read the columns at once.
+     */
+    void setSettleTime(uint8_t microseconds);
+
+    /**
+     * @brief Gets the number of keys.
+     *
+     * @return The number of rows times the number of columns.
+     */
+    uint8_t getKeyCount() const;
+
+    /**
+     * @brief Checks if a key is pressed, after filtering and anti-ghosting.
+     *
+     * @param key The key index.
+     * @return true if the key is pressed, false otherwise.
+     */
+    bool isKeyPressed(uint8_t key) const;
+
+    /**
+     * @brief Starts the scanner task.
+     *
+     * @param usStackDepth Stack depth for the task.
+     * @param taskName The name of the task.
+     * @param checkInterval The check interval for key triggers.
+     */
+    void startScanning(uint16_t usStackDepth = 3000, char const *taskName = nullptr, uint8_t checkInterval = 30);
+
+    /**
+     * @brief Stops the scanner task.
+     */
+    void stopScanning();
+
+    /**
+     * @brief Runs a single scan of the whole matrix.
+     *
+     * @details Called by the scanner task every check interval, or directly by an owner that
+     * drives the matrix from its own loop instead of starting the task.
+     */
+    void scan();
+};
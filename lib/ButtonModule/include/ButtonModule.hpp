@@ -8,46 +8,134 @@
  * @copyright MetaHouse LTD.
  */
 #include <MultiPrinterLoggerInterface.hpp> // MultiPrinterLoggerInterface
-#include <esp32-hal-gpio.h>                // pinMode, digitalRead
 #include <TaskTracker.hpp>
+#include <atomic>
 
+#include "ButtonEventQueue.hpp"
+#include "ButtonGuard.hpp"
+#include "ButtonHalInterface.hpp"
+#include "ButtonLogRing.hpp"
 #include "ButtonModuleInterface.hpp"
+#include "ButtonStateMachine.hpp"
+#include "ButtonStats.hpp"
+#include "ButtonSubscribers.hpp"
+#include "ButtonTraceRecorder.hpp"
+#include "GestureEngine.hpp"
+#include "LatencyHistogram.hpp"
+#include "VerticalCounterDebouncer.hpp"
+
+class ButtonChordDetector;
+class ButtonScanner;
+
+/**
+ * @brief Optional diagnostics of a ButtonModule, attached with ButtonModule::setDiagnostics().
+ *
+ * @details Each member is optional and recorded on the polling task, nothing is formatted there:
+ * - latencyHistogram: the latency of every dispatched event, from the last pin edge before it,
+ *   timed by the interrupt in INTERRUPT mode or by the sample that saw the change otherwise, to
+ *   the call of the callback or the push to the queue. It includes the long press time and the
+ *   double press window where those apply.
+ * - stats: detection steps, raw edges, bounces rejected by the debounce, dispatched events and
+ *   gestures, and the duration of every press and callback; read them from any task with
+ *   ButtonStats::getSnapshot().
+ * - logRing: every event and gesture, with its latency, as a binary record drained by another
+ *   task with ButtonLogRing::popFormatted(). A full event queue is recorded as well. Unlike
+ *   the logger, the ring works whatever BUTTON_LOG_LEVEL the library is built with.
+ * - traceRecorder: every change of the raw pin level, before the debounce, and every
+ *   dispatched event as a ButtonTrace record of a few bytes, overwriting the oldest ones when
+ *   the ring is full. Dump it with ButtonTraceRecorder::dump() and replay it on the host with
+ *   tools/replay.
+ *
+ * Raw edges and vertical counter rejections are seen by poll() only, not by a batched
+ * ButtonScanner; the events are recorded either way. Buttons may share one ButtonDiagnostics
+ * only when they are meant to share every object it points to.
+ */
+struct ButtonDiagnostics
+{
+    LatencyHistogram *latencyHistogram = nullptr; // Histogram of capture to dispatch latencies, if any
+    ButtonStats *stats = nullptr;                 // Counters and histograms, if any
+    ButtonLogRing *logRing = nullptr;             // Ring receiving binary records of the events, if any
+    ButtonTraceRecorder *traceRecorder = nullptr; // Ring receiving the raw edges and events, if any
+};
+
+/**
+ * @brief Timings and callbacks of a ButtonModule, published to its polling task as a whole.
+ */
+struct ButtonConfig
+{
+    ButtonTimings timings;                                                                             // Debounce, long press and double press timings
+    uint8_t checkInterval = 30;                                                                        // Check interval for button trigger
+    ButtonModuleInterface::DebounceMode debounceMode = ButtonModuleInterface::DebounceMode::TIMESTAMP; // How the pin level is debounced
+    ButtonCallback singlePressCallback;                                                                // Callback for single press
+    ButtonCallback doublePressCallback;                                                                // Callback for double press
+    ButtonCallback longPressCallback;                                                                  // Callback for long press
+    GestureTable const *gestureTable = nullptr;                                                        // Gestures recognized instead of single, double and long press, if any
+    ButtonDelegate<uint8_t> gestureCallback;                                                           // Callback for gestures, taking the gesture index
+};
 
 /**
  * @brief Implementation of the ButtonModule class.
  *
  * @details The ButtonModule class is responsible for managing the button module,
  * detecting button status changes, and invoking callback functions for single press,
- * double press, and long press events.
+ * double press, and long press events. The classification itself is done by a
+ * ButtonStateMachine; this class feeds it with GPIO samples and dispatches its events.
  */
 class ButtonModule : public ButtonModuleInterface
 {
+public:
+    /**
+     * @brief How the listening task waits between detection steps.
+     */
+    enum class ListeningMode : uint8_t
+    {
+        POLLING,   // Sample the pin every check interval, or every idle check interval while idle
+        INTERRUPT, // Block on a pin change interrupt while idle, wake on the next deadline or pin change while a press is in progress
+    };
+
 private:
+    // Grouped by size rather than by feature, so that sizeof(ButtonModule) has no padding to spare
     MultiPrinterLoggerInterface *const _logger; // Logger for logging
+    ButtonHalInterface *const _hal;             // Time source and pin access
 
-    uint8_t _pin = 0;       // Pin of the button module
-    bool _onRaising = true; // Flag indicating whether the button module triggers on raising or falling edge
+    ButtonConfig _config;                      // Timings and callbacks in use by the polling task
+    ButtonConfig _publishedConfig;             // Timings and callbacks published for the polling task
+    std::atomic<uint32_t> _configSequence{0};  // Seqlock of the published config, odd while it is written
+    uint32_t _appliedSequence = 0;             // Sequence of the config in use
+    SemaphoreHandle_t _configMutex = nullptr;  // Serializes the writers of the published config
+    ButtonSubscribers *_subscribers = nullptr; // Further subscribers to the events, if any
+    GestureEngine _gestureEngine;              // Gesture recognition state
 
-    void (*_singlePressCallback)(void *) = nullptr; // Callback function for single press
-    void *_singlePressCallbackParameter = nullptr;  // Parameter for the callback function for single press
+    ButtonStateMachine _stateMachine;                // Press detection state
+    VerticalCounterDebouncer<uint8_t> _levelFilter;  // Pressed level filter for DebounceMode::VERTICAL_COUNTER
+    uint16_t _idleCheckInterval = 0;                 // Check interval while idle in POLLING mode, 0 for the check interval
+    TaskHandle_t _buttonTriggerTaskHandle = nullptr; // Task handle for the button trigger task
+    ButtonScanner *_scanner = nullptr;               // Shared scanner polling this button, if any
+    ButtonEventQueue *_eventQueue = nullptr;         // Queue receiving the events instead of the callbacks, if any
 
-    void (*_doublePressCallback)(void *) = nullptr; // Callback function for double press
-    void *_doublePressCallbackParameter = nullptr;  // Parameter for the callback function for double press
+    ButtonDiagnostics const *_diagnostics;         // Optional diagnostics, never nullptr: an empty ButtonDiagnostics when none are attached
+    ButtonGuard *_guard = nullptr;                 // Rate limit and quarantine of the events, if any
+    ButtonChordDetector *_chordDetector = nullptr; // Chord detector this button is a member of, if any
 
-    void (*_longPressCallback)(void *) = nullptr; // Callback function for long press
-    void *_longPressCallbackParameter = nullptr;  // Parameter for the callback function for long press
+    std::atomic<uint32_t> _edgeMicros{0}; // Time of the last pin edge seen by the interrupt, in microseconds
+    uint32_t _captureMicros = 0;          // Time of the last level change, in microseconds
+    uint32_t _dispatchMicros = 0;         // Time the last event was dispatched, in microseconds
+    uint32_t _pressStartTime = 0;         // Time of the last press fed to the state machine, in milliseconds
 
-    uint8_t _checkInterval;                          // Check interval for button trigger
-    uint8_t _debounceTime;                           // Debounce time for button trigger
-    uint16_t _longPressTime;                         // Long press time for button trigger
-    uint16_t _timeBetweenDoublePress;                // Time between double press for button trigger
-    TaskHandle_t _buttonTriggerTaskHandle = nullptr; // Task handle for the button trigger task
+    uint8_t _pin = 0;                                      // Pin of the button module
+    bool _onRaising = true;                                // Flag indicating whether the button module triggers on raising or falling edge
+    ListeningMode _listeningMode = ListeningMode::POLLING; // How the button trigger task waits between detection steps
+    uint8_t _eventQueueButtonId = 0;                       // Button identifier written in the queued events
+    uint8_t _queuedEvents = 0;                             // Mask of the events pushed to the queue
+    bool _lastLevel = false;                               // Level of the previous sample fed to the state machine
+    bool _lastRawLevel = false;                            // Pressed level of the previous sample, before the debounce filter
+    uint8_t _chordMember = 0;                              // Member index of this button in the chord detector
+    bool _chordCancelled = false;                          // A chord took over the current press, ignore it until released
 
-    bool wasPressed;
-    unsigned long lastPressTime;
-    unsigned long lastReleaseTime;
-    bool triggerFired;
-    uint8_t countPress;
+    std::atomic<bool> _paused{false};           // Listening is paused, the task and its state are kept
+    std::atomic<bool> _restartDetection{false}; // Listening was resumed, the polling task starts the detection over
+    std::atomic<bool> _wakePress{false};        // The button woke the chip, the polling task reports the press
+    bool _wakeupEnabled = false;                // enableWakeup() armed the pin as a wakeup source
 
     /**
      * @brief Button trigger task.
@@ -55,10 +143,22 @@ private:
      * @details This task detects button triggers and invokes the appropriate callback functions.
      */
     void buttonTriggerTask();
-    void resetButtonState();
-    void handleButtonPress();
-    void handleButtonRelease();
-    void handleSingleOrDoublePress();
+    static void edgeInterruptHandler(void *thisPointer);
+    ButtonConfig &beginConfigUpdate();
+    void endConfigUpdate();
+    void applyConfig();
+    uint8_t enabledEvents() const;
+    uint32_t detectionDelay();
+    bool sampleLevel();
+    void processSample(uint32_t now, bool pressed);
+    void processGesture(uint32_t now, bool pressed);
+    void dispatchEvent(uint32_t now, ButtonStateMachine::Event event, bool held = false);
+    bool isDetectionIdle() const;
+    void resetDetection();
+    void cancelPress(bool pressed);
+
+    friend class ButtonChordDetector;
+    friend class ButtonScanner;
 
 public:
     /**
@@ -66,10 +166,13 @@ public:
      *
      * @param pin The pin of the button module.
      * @param onRaising Flag indicating whether the button module triggers on raising or falling edge.
+     * @param logger Logger for logging.
+     * @param hal Time source and pin access, defaults to the Arduino GPIOs.
      */
     ButtonModule(
         uint8_t const pin, bool const onRaising = true,
-        MultiPrinterLoggerInterface *const logger = nullptr);
+        MultiPrinterLoggerInterface *const logger = nullptr,
+        ButtonHalInterface *const hal = nullptr);
 
     /**
      * @brief Destructor for ButtonModule.
@@ -91,6 +194,13 @@ public:
      */
     void onSinglePress(void (*callback)(void *), void *_pParameter = nullptr) override;
 
+    /**
+     * @brief Sets the callback for a single press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    void onSinglePress(ButtonCallback const &callback) override;
+
     /**
      * @brief Sets the callback function for a double press event.
      *
@@ -99,6 +209,13 @@ public:
      */
     void onDoublePress(void (*callback)(void *), void *_pParameter = nullptr) override;
 
+    /**
+     * @brief Sets the callback for a double press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    void onDoublePress(ButtonCallback const &callback) override;
+
     /**
      * @brief Sets the callback function for a long press event.
      *
@@ -107,6 +224,76 @@ public:
      */
     void onLongPress(void (*callback)(void *), void *_pParameter = nullptr) override;
 
+    /**
+     * @brief Sets the callback for a long press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    void onLongPress(ButtonCallback const &callback) override;
+
+    /**
+     * @brief Delivers the events to several subscribers as well.
+     *
+     * @details Every event is dispatched to the callback set with onSinglePress(),
+     * onDoublePress() or onLongPress(), then to the subscribers of that event, on the task
+     * polling the button. Events with subscribers take part in the classification like events
+     * with a callback. Subscribers may come and go while the button is listening. Not used
+     * while an event queue or a gesture table is set.
+     *
+     * @param subscribers The subscribers, or nullptr to only call the callbacks.
+     */
+    void setSubscribers(ButtonSubscribers *subscribers);
+
+    /**
+     * @brief Recognizes custom gestures instead of single, double and long press.
+     *
+     * @details While a table is set, samples go through a GestureEngine: N taps, taps then
+     * hold and repeat while held, as compiled into the table. The callback receives the index
+     * of the recognized gesture in the definitions of the table. The single, double and long
+     * press callbacks and the event queue are not used. The table must outlive its use.
+     *
+     * @param table The gestures, or nullptr to go back to single, double and long press.
+     * @param callback The callback function, taking the gesture index and a void pointer.
+     * @param _pParameter The void pointer parameter for the callback function.
+     */
+    void onGesture(GestureTable const *table, void (*callback)(uint8_t, void *), void *_pParameter = nullptr);
+
+    /**
+     * @brief Recognizes custom gestures, with the context of the callback stored inline.
+     *
+     * @param table The gestures, or nullptr to go back to single, double and long press.
+     * @param callback The callback, taking the gesture index.
+     */
+    void onGesture(GestureTable const *table, ButtonDelegate<uint8_t> const &callback);
+
+    /**
+     * @brief Gets the published timings and callbacks.
+     *
+     * @return The config, including changes the polling task has not picked up yet.
+     */
+    ButtonConfig getConfig() const;
+
+    /**
+     * @brief Replaces the timings and callbacks without stopping the listening task.
+     *
+     * @details The config is published with a seqlock: the polling task picks it up as a
+     * whole on its next detection step and never sees half of it. A press in progress is kept
+     * and classified with the new timings. May be called from any task, and from a callback.
+     * The callback setters and setTimings() publish the same way.
+     *
+     * @param config The timings and callbacks.
+     */
+    void reconfigure(ButtonConfig const &config);
+
+    /**
+     * @brief Changes the timings without stopping the listening task.
+     *
+     * @param debounceTime The debounce time for button triggers.
+     * @param longPressTime The long press time for button triggers.
+     * @param timeBetweenDoublePress The time between double presses for button triggers.
+     */
+    void setTimings(uint8_t debounceTime = 90, uint16_t longPressTime = 1000, uint16_t timeBetweenDoublePress = 500);
+
     /**
      * @brief Starts listening for button triggers.
      *
@@ -116,14 +303,185 @@ public:
      * @param debounceTime The debounce time for button triggers.
      * @param longPressTime The long press time for button triggers.
      * @param timeBetweenDoublePress The time between double presses for button triggers.
+     * @param debounceMode How the pin level is debounced. VERTICAL_COUNTER only accepts a level
+     * change after debounceTime / checkInterval consecutive samples, rejecting shorter glitches;
+     * at most 15 samples, a longer debounceTime is shortened with a warning.
      */
     void startListening(
         uint16_t usStackDepth = 3000, char const *taskName = nullptr, uint8_t checkInterval = 30,
         uint8_t debounceTime = 90, uint16_t longPressTime = 1000,
-        uint16_t timeBetweenDoublePress = 500) override;
+        uint16_t timeBetweenDoublePress = 500, DebounceMode debounceMode = DebounceMode::TIMESTAMP) override;
 
     /**
      * @brief Stops listening for button triggers.
      */
     void stopListening() override;
+
+    /**
+     * @brief Pauses listening, keeping the task.
+     *
+     * @details The listening task blocks until resumeListening(), without deleting its stack,
+     * and the button is ignored by the task or ButtonScanner polling it. The config,
+     * callbacks and statistics are kept. Use around sleep instead of stopListening() and
+     * startListening(), which free and allocate the task.
+     */
+    void pauseListening();
+
+    /**
+     * @brief Resumes listening after pauseListening().
+     *
+     * @details The pin was not watched meanwhile, so the detection starts over: a press in
+     * progress before the pause is forgotten.
+     */
+    void resumeListening();
+
+    /**
+     * @brief Checks if listening is paused.
+     *
+     * @return true between pauseListening() and resumeListening(), false otherwise.
+     */
+    bool isPaused() const;
+
+    /**
+     * @brief Configures the button to wake the chip from sleep.
+     *
+     * @details The pin wakes the chip at the pressed level. On the ESP32 any GPIO wakes it
+     * from light sleep; only RTC GPIOs wake it from deep sleep, any number of them for buttons
+     * triggering on raising edge and a single one for buttons triggering on falling edge.
+     * The pin stays a wakeup source, also across deep sleep, until disableWakeup(),
+     * stopListening() or the destructor; pause the button around sleep instead of stopping it.
+     *
+     * @param deepSleep true to wake from deep sleep, false to wake from light sleep.
+     * @return true if the pin can wake the chip from that sleep, false otherwise.
+     */
+    bool enableWakeup(bool deepSleep = false);
+
+    /**
+     * @brief Stops the button from waking the chip from either sleep.
+     *
+     * @details The other buttons enabled as a wakeup source keep waking the chip.
+     */
+    void disableWakeup();
+
+    /**
+     * @brief Reports the press that woke the chip as a normal event.
+     *
+     * @details Call after waking: when esp_light_sleep_start() returns, after resumeListening(),
+     * or from setup() after deep sleep. If this button woke the chip, the polling task treats
+     * its next sample as the continuation of that press; a press released before that sample
+     * is replayed as a press and a release, so a short tap is still reported.
+     *
+     * @return true if this button woke the chip, false otherwise.
+     */
+    bool handleWakeup();
+
+    /**
+     * @brief Sets how the listening task waits between detection steps.
+     *
+     * @details In INTERRUPT mode a pin change interrupt wakes the listening task, which polls
+     * only while a press, long press or double press window is in progress and otherwise blocks
+     * without waking up. Stops the running listening task, if any; the mode takes effect on
+     * the next call to startListening.
+     *
+     * @param mode The listening mode.
+     */
+    void setListeningMode(ListeningMode mode);
+
+    /**
+     * @brief Sets the check interval used while no press is in progress in POLLING mode.
+     *
+     * @details The listening task samples at the check interval only while a press, long
+     * press or double press window is in progress. A longer idle interval saves wakeups at the
+     * cost of detecting the start of a press later. Takes effect immediately.
+     *
+     * @param idleCheckInterval The idle check interval, 0 to always use the check interval.
+     */
+    void setIdleCheckInterval(uint16_t idleCheckInterval);
+
+    /**
+     * @brief Gets how long to wait before the next detection step.
+     *
+     * @details While a press is in progress this is the check interval, shortened to the
+     * pending long press or double press deadline so the event is reported on time. In
+     * INTERRUPT mode only the deadline counts, since pin changes wake the task anyway. Used
+     * by the listening task after every poll(), and by owners calling poll() themselves.
+     *
+     * @return Milliseconds to wait, or ButtonStateMachine::NO_DEADLINE to wait for a pin change.
+     */
+    uint32_t getPollDelay();
+
+    /**
+     * @brief Attaches the optional diagnostics of this button.
+     *
+     * @details The diagnostics are kept out of the button, which only holds a pointer to
+     * them, so a button without any costs no more than that pointer. See ButtonDiagnostics
+     * for what each one records. Change the attached objects by attaching the diagnostics
+     * again, not through the pointer, while the button is listening.
+     *
+     * @param diagnostics The diagnostics, or nullptr to stop recording.
+     */
+    void setDiagnostics(ButtonDiagnostics const *diagnostics);
+
+    /**
+     * @brief Rate limits the events of this button and quarantines it when noisy or stuck.
+     *
+     * @details Every event, gestures included, takes a token of the guard before it is
+     * delivered to the event queue, the callbacks and the subscribers; events over the limit
+     * and during a quarantine are counted instead. The statistics, log ring and trace recorder
+     * still see every event, so a storm shows up in them; gestures are counted by the
+     * statistics and the log ring, and the trace keeps the edges they are made of. A stuck input is ignored until
+     * released, so the polling task falls back to its idle interval rather than following the
+     * press. The guard reports quarantines through its own callback. A batched ButtonScanner
+     * skips released, idle buttons, so their recovery is only seen with their next press.
+     *
+     * @param guard The guard, or nullptr to dispatch every event.
+     */
+    void setGuard(ButtonGuard *guard);
+
+    /**
+     * @brief Gets the time of the last pin edge before the last event.
+     *
+     * @details Valid inside the callbacks, queued events carry it as ButtonEvent::captureMicros.
+     *
+     * @return The capture time in microseconds.
+     */
+    uint32_t getLastCaptureMicros() const;
+
+    /**
+     * @brief Gets the time the last event was dispatched.
+     *
+     * @details Valid inside the callbacks, queued events carry it as ButtonEvent::dispatchMicros.
+     *
+     * @return The dispatch time in microseconds.
+     */
+    uint32_t getLastDispatchMicros() const;
+
+    /**
+     * @brief Delivers events through a queue instead of invoking the callbacks.
+     *
+     * @details Detected events are pushed as compact records into the queue by the task polling
+     * the button, and the callbacks are no longer called. Consumers pop them from their own task,
+     * so slow handlers never delay detection. The queue is single producer: buttons sharing a
+     * queue must be polled by the same task, e.g. one ButtonScanner.
+     *
+     * @param queue The queue, or nullptr to go back to the callbacks.
+     * @param buttonId Identifier written in the events of this button.
+     * @param events Mask of ButtonStateMachine::EnabledEvent bits to detect and queue.
+     */
+    void setEventQueue(
+        ButtonEventQueue *queue, uint8_t buttonId = 0,
+        uint8_t events = ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED |
+                         ButtonStateMachine::LONG_PRESS_ENABLED);
+
+    /**
+     * @brief Runs a single detection step.
+     *
+     * @details Samples the button once and advances the press detection state machine,
+     * invoking callbacks when an event is recognized. Called by the listening task or
+     * by a ButtonScanner; it must not be called from two tasks at the same time.
+     */
+    void poll();
 };
+
+// Two configs, eleven pointers and 80 bytes of state, 392 bytes on a 64-bit host; optional state goes out of line
+static_assert(sizeof(ButtonModule) <= 2 * sizeof(ButtonConfig) + 11 * sizeof(void *) + 80, "ButtonModule grew, keep optional state out of line");
@@ -10,6 +10,8 @@
 
 #include <stdint.h> // uint8_t, uint16_t, uint32_t
 
+#include "ButtonDelegate.hpp"
+
 /**
  * @brief Interface for button modules.
  *
@@ -20,6 +22,15 @@
 class ButtonModuleInterface
 {
 public:
+    /**
+     * @brief How the pin level is debounced before press detection.
+     */
+    enum class DebounceMode : uint8_t
+    {
+        TIMESTAMP,        // Compare press and release timestamps against the debounce time
+        VERTICAL_COUNTER, // Require debounceTime / checkInterval consecutive equal samples before a level change
+    };
+
     /**
      * @brief Virtual destructor for ButtonModuleInterface.
      */
@@ -40,6 +51,13 @@ public:
      */
     virtual void onSinglePress(void (*callback)(void *), void *_pParameter = nullptr) = 0;
 
+    /**
+     * @brief Sets the callback for a single press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    virtual void onSinglePress(ButtonCallback const &callback) = 0;
+
     /**
      * @brief Sets the callback function for a double press event.
      *
@@ -48,6 +66,13 @@ public:
      */
     virtual void onDoublePress(void (*callback)(void *), void *_pParameter = nullptr) = 0;
 
+    /**
+     * @brief Sets the callback for a double press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    virtual void onDoublePress(ButtonCallback const &callback) = 0;
+
     /**
      * @brief Sets the callback function for a long press event.
      *
@@ -56,6 +81,13 @@ public:
      */
     virtual void onLongPress(void (*callback)(void *), void *_pParameter = nullptr) = 0;
 
+    /**
+     * @brief Sets the callback for a long press event, with its context stored inline.
+     *
+     * @param callback The callback, e.g. a lambda with captures or a bound member function.
+     */
+    virtual void onLongPress(ButtonCallback const &callback) = 0;
+
     /**
      * @brief Starts listening for button triggers.
      *
@@ -65,11 +97,12 @@ public:
      * @param debounceTime The debounce time for button triggers.
      * @param longPressTime The long press time for button triggers.
      * @param timeBetweenDoublePress The time between double presses for button triggers.
+     * @param debounceMode How the pin level is debounced.
      */
     virtual void startListening(
         uint16_t usStackDepth = 3000, char const *taskName = "buttonTriggerTask", uint8_t checkInterval = 30,
         uint8_t debounceTime = 90, uint16_t longPressTime = 1000,
-        uint16_t timeBetweenDoublePress = 500) = 0;
+        uint16_t timeBetweenDoublePress = 500, DebounceMode debounceMode = DebounceMode::TIMESTAMP) = 0;
 
     /**
      * @brief Stops listening for button triggers.
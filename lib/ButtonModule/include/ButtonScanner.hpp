@@ -0,0 +1,169 @@
+#pragma once
+
+/**
+ * @file ButtonScanner.hpp
+ * @brief Defines the ButtonScanner class
+ * @details Header file declaring a shared scanner task that polls many ButtonModule instances
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <MultiPrinterLoggerInterface.hpp> // MultiPrinterLoggerInterface
+#include <TaskTracker.hpp>
+
+#include "BitParallelDebouncer.hpp"
+#include "ButtonChordDetector.hpp"
+#include "ButtonHalInterface.hpp"
+#include "ButtonModule.hpp"
+
+#ifndef BUTTON_SCANNER_MAX_BUTTONS
+#define BUTTON_SCANNER_MAX_BUTTONS 64 // Maximum number of buttons a single scanner can poll
+#endif
+
+#ifndef BUTTON_SCANNER_FILTER_SAMPLES
+#define BUTTON_SCANNER_FILTER_SAMPLES 2 // Equal samples needed to change the filtered level in BATCHED mode
+#endif
+
+static_assert(BUTTON_SCANNER_MAX_BUTTONS <= 64, "A scanner holds one bit per button in a 64 bit word");
+
+/**
+ * @brief Shared polling task for many buttons.
+ *
+ * @details The ButtonScanner owns a single FreeRTOS task that runs the detection state
+ * machine of every registered ButtonModule on each tick, instead of every ButtonModule
+ * spawning its own listening task. Registered buttons keep their own callbacks and timings;
+ * only the check interval is shared by the whole group.
+ */
+class ButtonScanner
+{
+public:
+    /**
+     * @brief How the scanner samples the registered buttons.
+     */
+    enum class ScanMode : uint8_t
+    {
+        PER_BUTTON, // Every button reads its own pin through its own HAL
+        BATCHED,    // The GPIO input registers are read once per tick and filtered bit-parallel
+    };
+
+private:
+    MultiPrinterLoggerInterface *const _logger; // Logger for logging
+    ButtonHalInterface *const _hal;             // Time source and pin access for BATCHED mode
+
+    ButtonModule *_buttons[BUTTON_SCANNER_MAX_BUTTONS] = {}; // Registered buttons
+    uint8_t _buttonCount = 0;                                // Number of registered buttons
+    SemaphoreHandle_t _buttonsMutex = nullptr;               // Guards the registered buttons against the scanner task
+
+    ScanMode _scanMode = ScanMode::PER_BUTTON;                                  // How the buttons are sampled
+    BitParallelDebouncer<uint64_t, BUTTON_SCANNER_FILTER_SAMPLES> _levelFilter; // Filtered pressed level, one bit per button
+    uint64_t _activeButtons = 0;                                                // Buttons with a press in progress, one bit per button
+
+    uint8_t _checkInterval = 30;               // Check interval shared by all registered buttons
+    TaskHandle_t _scannerTaskHandle = nullptr; // Task handle for the scanner task
+
+    ButtonChordDetector *_chordDetector = nullptr; // Chord detector fed with the levels of its members, if any
+
+    /**
+     * @brief Scanner task.
+     *
+     * @details This task polls every registered button once per check interval.
+     */
+    void scannerTask();
+    void scanPerButton();
+    void scanBatched();
+    void updateChords(uint64_t pressed);
+
+public:
+    /**
+     * @brief Constructor for ButtonScanner.
+     *
+     * @param logger Logger for logging.
+     * @param hal Time source and pin access for BATCHED mode, defaults to the Arduino GPIOs.
+     */
+    ButtonScanner(MultiPrinterLoggerInterface *const logger = nullptr, ButtonHalInterface *const hal = nullptr);
+
+    /**
+     * @brief Destructor for ButtonScanner.
+     *
+     * @details Stops scanning and unregisters all buttons.
+     */
+    ~ButtonScanner();
+
+    /**
+     * @brief Registers a button with the scanner.
+     *
+     * @details Any listening task owned by the button is stopped, and the button is detached
+     * from any other scanner. Buttons can be added while the scanner is running.
+     *
+     * @param button The button to register.
+     * @param debounceTime The debounce time for button triggers.
+     * @param longPressTime The long press time for button triggers.
+     * @param timeBetweenDoublePress The time between double presses for button triggers.
+     * @return true if the button was registered, false if the scanner is full or the button is null.
+     */
+    bool addButton(
+        ButtonModule *button, uint8_t debounceTime = 90, uint16_t longPressTime = 1000,
+        uint16_t timeBetweenDoublePress = 500);
+
+    /**
+     * @brief Unregisters a button from the scanner.
+     *
+     * @details Once this returns, the scanner task no longer touches the button.
+     *
+     * @param button The button to unregister.
+     * @return true if the button was registered with this scanner, false otherwise.
+     */
+    bool removeButton(ButtonModule *button);
+
+    /**
+     * @brief Gets the number of registered buttons.
+     *
+     * @return The number of registered buttons.
+     */
+    uint8_t getButtonCount() const;
+
+    /**
+     * @brief Starts the scanner task.
+     *
+     * @param usStackDepth Stack depth for the task.
+     * @param taskName The name of the task.
+     * @param checkInterval The check interval for button triggers.
+     */
+    void startScanning(uint16_t usStackDepth = 3000, char const *taskName = nullptr, uint8_t checkInterval = 30);
+
+    /**
+     * @brief Stops the scanner task.
+     */
+    void stopScanning();
+
+    /**
+     * @brief Sets how the scanner samples the registered buttons.
+     *
+     * @details In BATCHED mode each tick reads all GPIO levels with a single HAL call, extracts
+     * the level of every button with mask operations and filters them together with a
+     * BitParallelDebouncer (BUTTON_SCANNER_FILTER_SAMPLES). Only buttons that are pressed or have
+     * a press in progress run their state machine; idle buttons cost nothing. Pins are read
+     * through the HAL of the scanner rather than the HAL of each button.
+     *
+     * @param mode The scan mode.
+     */
+    void setScanMode(ScanMode mode);
+
+    /**
+     * @brief Feeds a chord detector from the scans.
+     *
+     * @details Every scan samples all buttons first, reports the levels of the registered
+     * buttons that are members of the detector, and only then lets the buttons process their
+     * samples, so a chord is seen before any of its members reacts to it.
+     *
+     * @param detector The chord detector, or nullptr to stop feeding it.
+     */
+    void setChordDetector(ButtonChordDetector *detector);
+
+    /**
+     * @brief Runs a single scan of all registered buttons.
+     *
+     * @details Called by the scanner task every check interval, or directly by an owner that
+     * drives the scanner from its own loop instead of starting the task.
+     */
+    void scan();
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file ButtonSeqlock.hpp
+ * @brief Defines the ButtonSeqlock class
+ * @details Header-only sequence lock letting any task copy counters updated by one task
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h> // uint8_t, uint32_t
+
+#define BUTTON_SEQLOCK_READ_ATTEMPTS 8 // Copies tried by ButtonSeqlock::read() before it gives up
+
+/**
+ * @brief Sequence counter bracketing the updates of a group of atomic counters.
+ *
+ * @details One task, the writer, updates the counters; the sequence is odd while it does. Any
+ * other task copies them with read() and retries when the sequence was odd or changed under
+ * the copy. Neither side locks. A reader retrying yields first, then sleeps a tick, so a
+ * writer of lower priority preempted halfway through an update gets to finish it; after
+ * BUTTON_SEQLOCK_READ_ATTEMPTS copies the reader gives up instead of spinning.
+ */
+class ButtonSeqlock
+{
+private:
+    std::atomic<uint32_t> _sequence{0}; // Odd while an update is in progress
+
+public:
+    /**
+     * @brief Adds to one counter in a single update. Must only be called by the writer.
+     *
+     * @param counter The counter.
+     * @param amount The amount to add.
+     */
+    void add(std::atomic<uint32_t> &counter, uint32_t amount = 1)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the counters consistently. Safe from any task.
+     *
+     * @tparam Copy Callable loading every counter with std::memory_order_relaxed.
+     * @param copy Called once per attempt, the last call holds the result.
+     * @return true if the copy is consistent, false if every attempt overlapped an update.
+     */
+    template <typename Copy>
+    bool read(Copy const &copy) const
+    {
+        for (uint8_t attempt = 0; attempt < BUTTON_SEQLOCK_READ_ATTEMPTS; attempt++)
+        {
+            if (attempt == 1)
+                taskYIELD();
+            else if (attempt > 1)
+                vTaskDelay(1);
+            uint32_t before = _sequence.load(std::memory_order_acquire);
+            copy();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(before & 1) && _sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+};
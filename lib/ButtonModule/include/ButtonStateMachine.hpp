@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+ * @file ButtonStateMachine.hpp
+ * @brief Defines the ButtonStateMachine class
+ * @details Header-only, hardware independent press detection used by ButtonModule.
+ * It has no dependency on Arduino or FreeRTOS and builds for the native host.
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+/**
+ * @brief Timing parameters of the press detection, in milliseconds.
+ */
+struct ButtonTimings
+{
+    uint16_t debounceTime = 90;            // Debounce time for button trigger
+    uint16_t longPressTime = 1000;         // Long press time for button trigger
+    uint16_t timeBetweenDoublePress = 500; // Time between double press for button trigger
+};
+
+/**
+ * @brief Classifies button samples into single, double and long press events.
+ *
+ * @details The state machine is fed with `(timestamp, level)` samples and returns the event,
+ * if any, that the sample completes. It holds only the detection state: timings and the set of
+ * enabled events are passed on every update, so a single configuration can be shared by many
+ * machines and changed between samples. It never allocates and has no virtual methods.
+ */
+class ButtonStateMachine
+{
+public:
+    /**
+     * @brief Event recognized by an update.
+     */
+    enum class Event : uint8_t
+    {
+        NONE,
+        SINGLE_PRESS,
+        DOUBLE_PRESS,
+        LONG_PRESS,
+    };
+
+    /**
+     * @brief Bits of the enabled events mask.
+     *
+     * @details A press is classified differently depending on which events someone listens to,
+     * e.g. a single press is reported on release when double press is disabled.
+     */
+    enum EnabledEvent : uint8_t
+    {
+        SINGLE_PRESS_ENABLED = 1 << 0,
+        DOUBLE_PRESS_ENABLED = 1 << 1,
+        LONG_PRESS_ENABLED = 1 << 2,
+    };
+
+    /**
+     * @brief Returned by timeToDeadline() when only a level change can produce an event.
+     */
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+private:
+    uint32_t _lastPressTime;   // Timestamp of the last press
+    uint32_t _lastReleaseTime; // Timestamp of the last release
+    uint8_t _countPress;       // Number of completed presses in the current sequence
+    bool _wasPressed;          // Level of the previous sample
+    bool _triggerFired;        // An event was reported, waiting for the release
+
+    Event handleButtonPress(uint32_t now, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (!_wasPressed)
+        {
+            // First time the button is pressed
+            _lastPressTime = now;
+            _lastReleaseTime = 0;
+            _wasPressed = true;
+        }
+        else
+        {
+            // Button pressed again, check for long press and not a double press
+            if ((enabledEvents & LONG_PRESS_ENABLED) && _countPress == 0 && now - _lastPressTime >= timings.longPressTime)
+            {
+                _triggerFired = true;
+                return Event::LONG_PRESS;
+            }
+        }
+        return Event::NONE;
+    }
+
+    Event handleButtonRelease(uint32_t now, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (_wasPressed)
+        {
+            // Button was released
+            _lastReleaseTime = now;
+            _countPress++;
+            _wasPressed = false;
+        }
+
+        if (_countPress > 0)
+        {
+            // Check if the button is released within the debounce time
+            if (_lastPressTime - _lastReleaseTime <= timings.debounceTime)
+            {
+                // Ignore short button release (debounce)
+                reset();
+            }
+            else
+            {
+                // Check for single or double press
+                return handleSingleOrDoublePress(now, timings, enabledEvents);
+            }
+        }
+        return Event::NONE;
+    }
+
+    Event handleSingleOrDoublePress(uint32_t now, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if ((enabledEvents & SINGLE_PRESS_ENABLED) &&
+            (!(enabledEvents & DOUBLE_PRESS_ENABLED) || now - _lastReleaseTime > timings.timeBetweenDoublePress))
+        {
+            _triggerFired = true;
+            return Event::SINGLE_PRESS;
+        }
+        else if ((enabledEvents & DOUBLE_PRESS_ENABLED) && _countPress >= 2)
+        {
+            _triggerFired = true;
+            return Event::DOUBLE_PRESS;
+        }
+        return Event::NONE;
+    }
+
+public:
+    /**
+     * @brief Constructor for ButtonStateMachine.
+     */
+    ButtonStateMachine() { reset(); }
+
+    /**
+     * @brief Forgets any press in progress.
+     */
+    void reset()
+    {
+        _wasPressed = false;
+        _lastPressTime = 0;
+        _lastReleaseTime = 0;
+        _triggerFired = false;
+        _countPress = 0;
+    }
+
+    /**
+     * @brief Feeds one sample into the state machine.
+     *
+     * @param now Timestamp of the sample in milliseconds, wrapping around like millis().
+     * @param pressed Whether the button is pressed in this sample.
+     * @param timings Timing parameters of the detection.
+     * @param enabledEvents Mask of EnabledEvent bits.
+     * @return The event completed by this sample, or Event::NONE.
+     */
+    Event update(uint32_t now, bool pressed, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (_triggerFired)
+        {
+            // Wait until the button is released before resetting variables
+            if (!pressed)
+                reset();
+            return Event::NONE;
+        }
+
+        if (pressed)
+            return handleButtonPress(now, timings, enabledEvents);
+        return handleButtonRelease(now, timings, enabledEvents);
+    }
+
+    /**
+     * @brief Checks if no press, long press or double press window is in progress.
+     *
+     * @return true if the state machine is idle, false otherwise.
+     */
+    bool isIdle() const { return !_wasPressed && _countPress == 0 && !_triggerFired; }
+
+    /**
+     * @brief Checks if an event was reported and the machine waits for the release.
+     *
+     * @return true if the next released sample only clears the press, false otherwise.
+     */
+    bool isWaitingForRelease() const { return _triggerFired; }
+
+    /**
+     * @brief Gets the time until an unchanged level completes an event.
+     *
+     * @details While the button is held this is the long press deadline, and while it is
+     * released after a press the end of the double press window. A caller sampling at that time
+     * reports the event without delay; until then, only a level change can produce an event.
+     * After a single or double press it is 0 until the next sample clears the press, so a
+     * caller that only wakes on deadlines does not miss the start of the next press.
+     *
+     * @param now Current time in milliseconds.
+     * @param timings Timing parameters of the detection.
+     * @param enabledEvents Mask of EnabledEvent bits.
+     * @return Milliseconds until the deadline, 0 if it has passed, or NO_DEADLINE.
+     */
+    uint32_t timeToDeadline(uint32_t now, ButtonTimings const &timings, uint8_t enabledEvents) const
+    {
+        // A reported press clears on the next released sample, a long press waits for the release
+        if (_triggerFired)
+            return _wasPressed ? NO_DEADLINE : 0;
+
+        if (_wasPressed)
+        {
+            if (!(enabledEvents & LONG_PRESS_ENABLED) || _countPress != 0)
+                return NO_DEADLINE;
+            uint32_t held = now - _lastPressTime;
+            return held >= timings.longPressTime ? 0 : timings.longPressTime - held;
+        }
+
+        if (_countPress == 0 || !(enabledEvents & SINGLE_PRESS_ENABLED))
+            return NO_DEADLINE;
+        // The single press is reported once the window has strictly passed
+        uint32_t released = now - _lastReleaseTime;
+        return released > timings.timeBetweenDoublePress ? 0 : timings.timeBetweenDoublePress + 1 - released;
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+/**
+ * @file ButtonStats.hpp
+ * @brief Defines the ButtonStats class
+ * @details Header-only counters and histograms of a button, readable without locking
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <atomic>
+#include <stdint.h> // uint8_t, uint32_t
+
+#include "ButtonSeqlock.hpp"
+#include "ButtonStateMachine.hpp"
+
+#define BUTTON_STATS_BUCKETS 8             // Buckets of the press and callback duration histograms
+#define BUTTON_STATS_PRESS_BUCKET_MS 32    // Upper bound of the first press duration bucket, doubling for every next bucket
+#define BUTTON_STATS_CALLBACK_BUCKET_US 16 // Upper bound of the first callback duration bucket, doubling for every next bucket
+
+/**
+ * @brief Consistent copy of the statistics of a button.
+ *
+ * @details Bucket 0 of a histogram counts values below its first bound, bucket i values below
+ * the first bound << i, and the last bucket everything above.
+ */
+struct ButtonStatsSnapshot
+{
+    uint32_t polls;                                   // Detection steps executed
+    uint32_t edges;                                   // Raw level changes seen by the samples
+    uint32_t bouncesRejected;                         // Level changes discarded by the debounce
+    uint32_t singlePresses;                           // Single press events dispatched
+    uint32_t doublePresses;                           // Double press events dispatched
+    uint32_t longPresses;                             // Long press events dispatched
+    uint32_t gestures;                                // Gestures of a GestureTable detected
+    uint32_t pressDurations[BUTTON_STATS_BUCKETS];    // Histogram of press durations, BUTTON_STATS_PRESS_BUCKET_MS first bound
+    uint32_t callbackDurations[BUTTON_STATS_BUCKETS]; // Histogram of callback durations, BUTTON_STATS_CALLBACK_BUCKET_US first bound
+};
+
+/**
+ * @brief Counters and histograms of a button.
+ *
+ * @details Updated by the task polling the button, with no formatting and no allocation.
+ * Any task reads a consistent snapshot without locking: every update is bracketed by a
+ * sequence counter, see ButtonSeqlock, and a reader that overlaps an update reads again.
+ */
+class ButtonStats
+{
+private:
+    enum Counter : uint8_t
+    {
+        POLLS,
+        EDGES,
+        BOUNCES_REJECTED,
+        SINGLE_PRESSES,
+        DOUBLE_PRESSES,
+        LONG_PRESSES,
+        GESTURES,
+        PRESS_DURATIONS,
+        CALLBACK_DURATIONS = PRESS_DURATIONS + BUTTON_STATS_BUCKETS,
+        COUNTERS = CALLBACK_DURATIONS + BUTTON_STATS_BUCKETS,
+    };
+
+    ButtonSeqlock _sequence;                   // Brackets the updates of the counters
+    std::atomic<uint32_t> _counters[COUNTERS]; // Indexed by Counter
+
+    void increment(uint8_t counter) { _sequence.add(_counters[counter]); }
+
+    static uint8_t bucketOf(uint32_t value, uint32_t firstBound)
+    {
+        uint8_t bucket = 0;
+        while (bucket < BUTTON_STATS_BUCKETS - 1 && value >= firstBound)
+        {
+            value >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+public:
+    /**
+     * @brief Constructor for ButtonStats.
+     */
+    ButtonStats() { reset(); }
+
+    ButtonStats(ButtonStats const &) = delete;
+    ButtonStats &operator=(ButtonStats const &) = delete;
+
+    /**
+     * @brief Clears all counters. Must not run while the button is polled.
+     */
+    void reset()
+    {
+        for (uint8_t i = 0; i < COUNTERS; i++)
+            _counters[i].store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counts a detection step. The add methods must only be called by the polling task.
+     */
+    void addPoll() { increment(POLLS); }
+
+    /**
+     * @brief Counts a raw level change.
+     */
+    void addEdge() { increment(EDGES); }
+
+    /**
+     * @brief Counts a level change discarded by the debounce.
+     */
+    void addBounceRejected() { increment(BOUNCES_REJECTED); }
+
+    /**
+     * @brief Adds a press to the press duration histogram.
+     *
+     * @param ms Time between the press and the release in milliseconds.
+     */
+    void addPressDuration(uint32_t ms) { increment(PRESS_DURATIONS + bucketOf(ms, BUTTON_STATS_PRESS_BUCKET_MS)); }
+
+    /**
+     * @brief Adds a callback run to the callback duration histogram.
+     *
+     * @param us Execution time of the callback in microseconds.
+     */
+    void addCallbackDuration(uint32_t us) { increment(CALLBACK_DURATIONS + bucketOf(us, BUTTON_STATS_CALLBACK_BUCKET_US)); }
+
+    /**
+     * @brief Counts a dispatched event.
+     *
+     * @param event The event.
+     */
+    void addEvent(ButtonStateMachine::Event event)
+    {
+        switch (event)
+        {
+        case ButtonStateMachine::Event::SINGLE_PRESS:
+            increment(SINGLE_PRESSES);
+            break;
+        case ButtonStateMachine::Event::DOUBLE_PRESS:
+            increment(DOUBLE_PRESSES);
+            break;
+        case ButtonStateMachine::Event::LONG_PRESS:
+            increment(LONG_PRESSES);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Counts a detected gesture.
+     */
+    void addGesture() { increment(GESTURES); }
+
+    /**
+     * @brief Copies all counters at once. Safe from any task.
+     *
+     * @details Retries a copy overlapping an update, yielding to the polling task in between.
+     *
+     * @param snapshot Receives the counters.
+     * @return true if the snapshot is consistent, false if the polling task kept updating it.
+     */
+    bool getSnapshot(ButtonStatsSnapshot &snapshot) const
+    {
+        uint32_t counters[COUNTERS];
+        bool consistent = _sequence.read([&]()
+                                         {
+                                             for (uint8_t i = 0; i < COUNTERS; i++)
+                                                 counters[i] = _counters[i].load(std::memory_order_relaxed); });
+
+        snapshot.polls = counters[POLLS];
+        snapshot.edges = counters[EDGES];
+        snapshot.bouncesRejected = counters[BOUNCES_REJECTED];
+        snapshot.singlePresses = counters[SINGLE_PRESSES];
+        snapshot.doublePresses = counters[DOUBLE_PRESSES];
+        snapshot.longPresses = counters[LONG_PRESSES];
+        snapshot.gestures = counters[GESTURES];
+        for (uint8_t i = 0; i < BUTTON_STATS_BUCKETS; i++)
+        {
+            snapshot.pressDurations[i] = counters[PRESS_DURATIONS + i];
+            snapshot.callbackDurations[i] = counters[CALLBACK_DURATIONS + i];
+        }
+        return consistent;
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * @file ButtonSubscribers.hpp
+ * @brief Defines the ButtonSubscribers class
+ * @details Header file declaring a fixed-capacity list of subscribers to the events of a button
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <TaskTracker.hpp>
+#include <atomic>
+#include <stdint.h> // uint8_t, uint32_t
+
+#include "ButtonDelegate.hpp"
+#include "ButtonStateMachine.hpp"
+
+/**
+ * @brief Callback of a subscriber, taking the event.
+ */
+typedef ButtonDelegate<ButtonStateMachine::Event> ButtonSubscriber;
+
+/**
+ * @brief Fan-out of the events of one button to several subscribers.
+ *
+ * @details Each subscriber registers a callback for a mask of events and receives every
+ * matching event, in slot order, after the callback set with onSinglePress(), onDoublePress()
+ * or onLongPress(). One bit mask of slots per event keeps the dispatch proportional to the
+ * subscribers of that event. Nothing is allocated, the slots are provided by the caller, see
+ * StaticButtonSubscribers.
+ *
+ * Subscribers may subscribe and unsubscribe from any task, and from inside a callback, while
+ * the event is dispatched. A subscriber added during a dispatch receives the next event. Once
+ * unsubscribe() returns the callback is neither running on another task nor called again, so
+ * its context may be released.
+ */
+class ButtonSubscribers
+{
+private:
+    ButtonSubscriber *const _slots;       // Callback of every slot
+    uint8_t const _capacity;              // Number of slots, at most 32
+    uint32_t _used = 0;                   // Slots holding a subscriber, one bit per slot
+    uint32_t _pending = 0;                // Slots the dispatch in progress has yet to call, one bit per slot
+    std::atomic<uint32_t> _eventSlots[3]; // Slots subscribed to single, double and long press, one bit per slot
+    StaticSemaphore_t _mutexStorage;      // Storage of the mutex, nothing comes from the FreeRTOS heap
+    SemaphoreHandle_t _mutex = nullptr;   // Guards the slots against the dispatching task
+
+protected:
+    /**
+     * @brief Constructor for ButtonSubscribers.
+     *
+     * @param slots Storage for the callbacks.
+     * @param capacity Number of callbacks the storage holds, at most 32.
+     */
+    ButtonSubscribers(ButtonSubscriber *slots, uint8_t capacity);
+
+public:
+    ButtonSubscribers(ButtonSubscribers const &) = delete;
+    ButtonSubscribers &operator=(ButtonSubscribers const &) = delete;
+
+    /**
+     * @brief Destructor for ButtonSubscribers.
+     *
+     * @details Detach the subscribers from their button first.
+     */
+    ~ButtonSubscribers();
+
+    /**
+     * @brief Adds a subscriber.
+     *
+     * @param events Mask of ButtonStateMachine::EnabledEvent bits the subscriber receives.
+     * @param callback The callback, taking the event.
+     * @return The subscription, passed to unsubscribe(), or -1 if all slots are used or nothing is subscribed.
+     */
+    int8_t subscribe(uint8_t events, ButtonSubscriber const &callback);
+
+    /**
+     * @brief Removes a subscriber.
+     *
+     * @details Waits for a dispatch in progress on another task to finish.
+     *
+     * @param subscription The subscription returned by subscribe().
+     * @return true if the subscriber was removed, false if there was none.
+     */
+    bool unsubscribe(int8_t subscription);
+
+    /**
+     * @brief Gets the events with at least one subscriber.
+     *
+     * @return Mask of ButtonStateMachine::EnabledEvent bits.
+     */
+    uint8_t subscribedEvents() const;
+
+    /**
+     * @brief Gets the number of subscribers.
+     *
+     * @return The number of used slots.
+     */
+    uint8_t getCount() const;
+
+    /**
+     * @brief Calls every subscriber of an event.
+     *
+     * @details Called by the task polling the button.
+     *
+     * @param event The event.
+     */
+    void dispatch(ButtonStateMachine::Event event);
+};
+
+/**
+ * @brief ButtonSubscribers with statically sized slots.
+ *
+ * @tparam Capacity Number of subscribers, at most 32.
+ */
+template <uint8_t Capacity>
+class StaticButtonSubscribers : public ButtonSubscribers
+{
+    static_assert(Capacity > 0 && Capacity <= 32, "Capacity must be between 1 and 32");
+
+private:
+    ButtonSubscriber _storage[Capacity]; // Slot storage
+
+public:
+    StaticButtonSubscribers() : ButtonSubscribers(_storage, Capacity) {}
+};
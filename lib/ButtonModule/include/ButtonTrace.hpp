@@ -0,0 +1,196 @@
+#pragma once
+
+/**
+ * @file ButtonTrace.hpp
+ * @brief Defines the ButtonTrace binary format
+ * @details Header-only encoding of recorded button edges and events, shared by the device and the host tools
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ *
+ * A trace file is a file header followed by blocks, all integers little-endian:
+ *
+ *   File header, 8 bytes:   "BTRC", uint8_t version (1), 3 reserved bytes (0)
+ *   Block header, 12 bytes: uint16_t button, uint8_t flags, 1 reserved byte,
+ *                           uint32_t start time in milliseconds, uint32_t payload bytes
+ *   Block payload:          records, each one unsigned LEB128 varint
+ *
+ * Bit 0 of the block flags is the raw level of the button at the start time, 1 for pressed.
+ * A record packs the milliseconds since the previous record of the block, or since the start
+ * time for the first one, above a 2 bit tag: (delta << 2) | tag. Tag EDGE toggles the raw
+ * level; the other tags are events the device reported at that time, which do not change the
+ * level. A block covers one button; a button may have several blocks, e.g. one per day, in
+ * increasing start time. Typical edges take 2 bytes.
+ */
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+#include <string.h> // memcpy
+
+#include "ButtonStateMachine.hpp"
+
+/**
+ * @brief Encoding and decoding of the trace format.
+ */
+class ButtonTrace
+{
+public:
+    static constexpr uint8_t VERSION = 1;            // Version written in the file header
+    static constexpr size_t FILE_HEADER_SIZE = 8;    // Bytes of the file header
+    static constexpr size_t BLOCK_HEADER_SIZE = 12;  // Bytes of a block header
+    static constexpr size_t MAX_RECORD_SIZE = 5;     // Bytes of the longest record
+    static constexpr uint8_t INITIAL_PRESSED = 0x01; // Block flag: the button is pressed at the start time
+
+    /**
+     * @brief Kind of a record, in its 2 low bits.
+     */
+    enum Tag : uint8_t
+    {
+        EDGE = 0,         // The raw level toggled
+        SINGLE_PRESS = 1, // The device reported a single press
+        DOUBLE_PRESS = 2, // The device reported a double press
+        LONG_PRESS = 3,   // The device reported a long press
+    };
+
+    /**
+     * @brief Header of a block.
+     */
+    struct BlockHeader
+    {
+        uint16_t button;       // Button of the block
+        uint8_t flags;         // INITIAL_PRESSED
+        uint32_t startTime;    // Time of the first record's delta origin, in milliseconds
+        uint32_t payloadBytes; // Bytes of records following the header
+    };
+
+    /**
+     * @brief Gets the tag of an event.
+     *
+     * @param event The event, not Event::NONE.
+     * @return The tag of the event.
+     */
+    static Tag eventTag(ButtonStateMachine::Event event)
+    {
+        return Tag(uint8_t(event));
+    }
+
+    /**
+     * @brief Gets the event of a tag.
+     *
+     * @param tag The tag, not EDGE.
+     * @return The event of the tag.
+     */
+    static ButtonStateMachine::Event tagEvent(Tag tag)
+    {
+        return ButtonStateMachine::Event(uint8_t(tag));
+    }
+
+    /**
+     * @brief Writes the file header.
+     *
+     * @param out At least FILE_HEADER_SIZE bytes.
+     */
+    static void writeFileHeader(uint8_t *out)
+    {
+        uint8_t const header[FILE_HEADER_SIZE] = {'B', 'T', 'R', 'C', VERSION, 0, 0, 0};
+        memcpy(out, header, FILE_HEADER_SIZE);
+    }
+
+    /**
+     * @brief Checks a file header.
+     *
+     * @param data The start of the file.
+     * @param size Bytes available.
+     * @return true if the data starts with a header of a supported version, false otherwise.
+     */
+    static bool checkFileHeader(uint8_t const *data, size_t size)
+    {
+        return size >= FILE_HEADER_SIZE && memcmp(data, "BTRC", 4) == 0 && data[4] == VERSION;
+    }
+
+    /**
+     * @brief Writes a block header.
+     *
+     * @param header The header.
+     * @param out At least BLOCK_HEADER_SIZE bytes.
+     */
+    static void writeBlockHeader(BlockHeader const &header, uint8_t *out)
+    {
+        out[0] = uint8_t(header.button);
+        out[1] = uint8_t(header.button >> 8);
+        out[2] = header.flags;
+        out[3] = 0;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            out[4 + i] = uint8_t(header.startTime >> (8 * i));
+            out[8 + i] = uint8_t(header.payloadBytes >> (8 * i));
+        }
+    }
+
+    /**
+     * @brief Reads a block header.
+     *
+     * @param data At least BLOCK_HEADER_SIZE bytes.
+     * @return The header.
+     */
+    static BlockHeader readBlockHeader(uint8_t const *data)
+    {
+        BlockHeader header;
+        header.button = uint16_t(data[0] | (data[1] << 8));
+        header.flags = data[2];
+        header.startTime = 0;
+        header.payloadBytes = 0;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            header.startTime |= uint32_t(data[4 + i]) << (8 * i);
+            header.payloadBytes |= uint32_t(data[8 + i]) << (8 * i);
+        }
+        return header;
+    }
+
+    /**
+     * @brief Encodes a record.
+     *
+     * @param delta Milliseconds since the previous record, below 2^30.
+     * @param tag Kind of the record.
+     * @param out At least MAX_RECORD_SIZE bytes.
+     * @return Bytes written.
+     */
+    static uint8_t encodeRecord(uint32_t delta, Tag tag, uint8_t *out)
+    {
+        uint32_t value = (delta << 2) | tag;
+        uint8_t size = 0;
+        while (value >= 0x80)
+        {
+            out[size++] = uint8_t(value) | 0x80;
+            value >>= 7;
+        }
+        out[size++] = uint8_t(value);
+        return size;
+    }
+
+    /**
+     * @brief Decodes a record.
+     *
+     * @param data Position of the record, advanced past it.
+     * @param end End of the payload.
+     * @param delta Milliseconds since the previous record.
+     * @param tag Kind of the record.
+     * @return true if a record was decoded, false at the end of the payload or on a truncated record.
+     */
+    static bool decodeRecord(uint8_t const *&data, uint8_t const *end, uint32_t &delta, Tag &tag)
+    {
+        uint32_t value = 0;
+        for (uint8_t shift = 0; data < end && shift < 7 * MAX_RECORD_SIZE; shift += 7)
+        {
+            uint8_t byte = *data++;
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                delta = value >> 2;
+                tag = Tag(value & 0x03);
+                return true;
+            }
+        }
+        return false;
+    }
+};
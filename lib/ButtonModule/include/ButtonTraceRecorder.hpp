@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file ButtonTraceRecorder.hpp
+ * @brief Defines the ButtonTraceRecorder class
+ * @details Header file declaring a RAM ring of the raw edges and events of a button in the ButtonTrace format
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+#include <atomic>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#include "ButtonDelegate.hpp"
+#include "ButtonStateMachine.hpp"
+#include "ButtonTrace.hpp"
+
+/**
+ * @brief Sink of a dump, taking a chunk of bytes of the trace.
+ */
+typedef ButtonDelegate<uint8_t const *, size_t> ButtonTraceWriter;
+
+/**
+ * @brief Recent raw edges and events of a button, kept as ButtonTrace records in a byte ring.
+ *
+ * @details The task polling the button appends a record for every raw level change, before
+ * the debounce, and for every dispatched event: the milliseconds since the previous record
+ * and a 2 bit tag, typically 2 bytes. Samples without an edge cost one comparison in
+ * ButtonModule and nothing here, and nothing is formatted. When the ring is full the oldest
+ * records are overwritten, so it always holds the most recent history, and dump() writes it
+ * as one ButtonTrace block that the host replay tool reads.
+ *
+ * dump() may run on any task. While it writes, the polling task skips its records instead
+ * of waiting and counts them as dropped; the first record after the dump restores the
+ * level, so an edge lost meanwhile shows up late rather than inverting the trace. The
+ * storage is provided by the caller, see StaticButtonTraceRecorder.
+ */
+class ButtonTraceRecorder
+{
+private:
+    static constexpr uint32_t MAX_DELTA = (uint32_t(1) << 30) - 1; // Longest delta of a record, in milliseconds
+
+    uint8_t *const _buffer;   // Ring storage
+    uint32_t const _capacity; // Bytes the storage holds
+    uint16_t const _button;   // Button written in the block header
+
+    uint32_t _head = 0;        // Next byte to write
+    uint32_t _tail = 0;        // First byte of the oldest record
+    uint32_t _used = 0;        // Bytes of records in the ring
+    bool _started = false;     // A first record set the start time and level
+    uint32_t _startTime = 0;   // Time the delta of the oldest record starts from, in milliseconds
+    bool _startLevel = false;  // Raw level before the oldest record
+    uint32_t _lastTime = 0;    // Time of the newest record, in milliseconds
+    bool _level = false;       // Raw level after the newest record
+    uint32_t _overwritten = 0; // Records overwritten by newer ones
+
+    std::atomic<bool> _writing{false};      // The polling task is appending
+    std::atomic<bool> _dumping{false};      // dump() is reading the ring
+    std::atomic<uint32_t> _droppedCount{0}; // Records skipped while dump() was reading
+
+    bool beginRecord();
+    void sync(uint32_t now, bool level);
+    void append(uint32_t now, ButtonTrace::Tag tag);
+    void appendRecord(uint32_t delta, ButtonTrace::Tag tag);
+    void dropOldest();
+
+protected:
+    /**
+     * @brief Constructor for ButtonTraceRecorder.
+     *
+     * @param buffer Storage for the records.
+     * @param capacity Bytes the storage holds, at least ButtonTrace::MAX_RECORD_SIZE.
+     * @param button Button written in the block header, e.g. its pin.
+     */
+    ButtonTraceRecorder(uint8_t *buffer, uint32_t capacity, uint16_t button);
+
+public:
+    ButtonTraceRecorder(ButtonTraceRecorder const &) = delete;
+    ButtonTraceRecorder &operator=(ButtonTraceRecorder const &) = delete;
+
+    /**
+     * @brief Records a raw level change. Must only be called by the polling task.
+     *
+     * @param now Time of the sample that saw the change, in milliseconds.
+     * @param level The new raw level, true for pressed.
+     */
+    void recordEdge(uint32_t now, bool level);
+
+    /**
+     * @brief Records a dispatched event. Must only be called by the polling task.
+     *
+     * @param now Time of the event, in milliseconds.
+     * @param event The event.
+     * @param level The current raw level, true for pressed.
+     * @param held true for an event held back by a ButtonChordDetector, recorded no earlier than the last record.
+     */
+    void recordEvent(uint32_t now, ButtonStateMachine::Event event, bool level, bool held = false);
+
+    /**
+     * @brief Writes the recorded history as a ButtonTrace block.
+     *
+     * @details The writer receives the file header, if requested, the block header and the
+     * records, in up to four chunks. Dumps of several recorders, the first one with the file
+     * header, make one trace file.
+     *
+     * @param writer The sink of the bytes, e.g. writing to a serial port or a file.
+     * @param fileHeader true to start with the ButtonTrace file header.
+     * @return Bytes written.
+     */
+    size_t dump(ButtonTraceWriter const &writer, bool fileHeader = true);
+
+    /**
+     * @brief Forgets the recorded history.
+     *
+     * @details Must not be called while the button is polled.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the bytes of records in the ring.
+     *
+     * @details Exact while the button is not polled, approximate otherwise.
+     *
+     * @return The bytes dump() writes after the headers.
+     */
+    uint32_t getSize() const;
+
+    /**
+     * @brief Gets the number of oldest records overwritten by newer ones.
+     *
+     * @details Exact while the button is not polled, approximate otherwise.
+     *
+     * @return The number of overwritten records.
+     */
+    uint32_t getOverwrittenCount() const;
+
+    /**
+     * @brief Gets the number of records skipped while dump() was reading.
+     *
+     * @return The number of dropped records.
+     */
+    uint32_t getDroppedCount() const;
+};
+
+/**
+ * @brief ButtonTraceRecorder with inline storage.
+ *
+ * @tparam Capacity Bytes of records the ring holds.
+ */
+template <uint32_t Capacity>
+class StaticButtonTraceRecorder : public ButtonTraceRecorder
+{
+    static_assert(Capacity >= ButtonTrace::MAX_RECORD_SIZE, "Capacity must hold at least one record");
+
+private:
+    uint8_t _storage[Capacity]; // Ring storage
+
+public:
+    /**
+     * @brief Constructor for StaticButtonTraceRecorder.
+     *
+     * @param button Button written in the block header, e.g. its pin.
+     */
+    explicit StaticButtonTraceRecorder(uint16_t button = 0) : ButtonTraceRecorder(_storage, Capacity, button) {}
+};
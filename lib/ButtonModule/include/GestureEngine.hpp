@@ -0,0 +1,307 @@
+#pragma once
+
+/**
+ * @file GestureEngine.hpp
+ * @brief Defines the GestureTable and GestureEngine classes
+ * @details Header-only, table-driven recognizer of tap, tap-then-hold and auto-repeat gestures
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#ifndef GESTURE_MAX_TAPS
+#define GESTURE_MAX_TAPS 8 // Largest number of taps a gesture can count
+#endif
+
+/**
+ * @brief A gesture to recognize.
+ */
+struct GestureDefinition
+{
+    /**
+     * @brief Shape of a gesture.
+     */
+    enum class Type : uint8_t
+    {
+        TAPS,              // `taps` short presses, e.g. 3 for a triple tap
+        TAPS_THEN_HOLD,    // `taps` short presses then a press held for the hold time, 0 taps for a long press
+        REPEAT_WHILE_HELD, // Reported every repeat interval while held after `taps` short presses
+    };
+
+    Type type;    // Shape of the gesture
+    uint8_t taps; // Number of taps, see Type
+};
+
+/**
+ * @brief Timing parameters of the gesture recognition, in milliseconds.
+ */
+struct GestureTimings
+{
+    uint16_t debounceTime = 40;    // Presses shorter than this are ignored
+    uint16_t tapWindow = 400;      // Longest release between the taps of one gesture
+    uint16_t holdTime = 800;       // Press duration of a hold
+    uint16_t repeatDelay = 500;    // Press duration before the first repeat
+    uint16_t repeatInterval = 100; // Time between repeats
+};
+
+/**
+ * @brief Gesture definitions compiled into a transition table.
+ *
+ * @details The table has one row per number of completed taps, telling which gesture a tap
+ * completes, which gesture a hold reports, whether holding repeats and whether a further tap
+ * can still make a longer gesture. The GestureEngine looks up a single row per sample, so the
+ * cost of recognition does not depend on the number of gestures. A gesture is identified by
+ * its index in the definitions; later definitions with the same shape replace earlier ones.
+ */
+class GestureTable
+{
+public:
+    static constexpr uint8_t NO_GESTURE = 0xFF; // Returned when a sample completes no gesture
+
+    /**
+     * @brief Row of the table, for a number of completed taps.
+     */
+    struct Row
+    {
+        uint8_t tap;     // Gesture completed by this number of taps, or NO_GESTURE
+        uint8_t hold;    // Gesture reported by a hold after this number of taps, or NO_GESTURE
+        uint8_t repeat;  // Gesture repeated while held after this number of taps, or NO_GESTURE
+        bool waitForTap; // A further tap can still complete a gesture, so wait for the tap window
+    };
+
+private:
+    Row _rows[GESTURE_MAX_TAPS + 1]; // Indexed by the number of completed taps
+    GestureTimings _timings;         // Timing parameters
+
+public:
+    /**
+     * @brief Compiles gesture definitions.
+     *
+     * @param definitions The gestures, identified by their index. Definitions with more than
+     * GESTURE_MAX_TAPS taps, or 0 taps for TAPS, are ignored.
+     * @param count Number of definitions, at most 255.
+     * @param timings Timing parameters of the recognition.
+     */
+    GestureTable(GestureDefinition const *definitions, uint8_t count, GestureTimings const &timings = GestureTimings())
+        : _timings(timings)
+    {
+        for (uint8_t taps = 0; taps <= GESTURE_MAX_TAPS; taps++)
+            _rows[taps] = {NO_GESTURE, NO_GESTURE, NO_GESTURE, false};
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            uint8_t taps = definitions[i].taps;
+            if (taps > GESTURE_MAX_TAPS)
+                continue;
+            switch (definitions[i].type)
+            {
+            case GestureDefinition::Type::TAPS:
+                if (taps == 0)
+                    continue;
+                _rows[taps].tap = i;
+                // Taps short of the gesture wait for more
+                for (uint8_t fewer = 1; fewer < taps; fewer++)
+                    _rows[fewer].waitForTap = true;
+                break;
+            case GestureDefinition::Type::TAPS_THEN_HOLD:
+                _rows[taps].hold = i;
+                for (uint8_t fewer = 1; fewer <= taps; fewer++)
+                    _rows[fewer].waitForTap = true;
+                break;
+            case GestureDefinition::Type::REPEAT_WHILE_HELD:
+                _rows[taps].repeat = i;
+                for (uint8_t fewer = 1; fewer <= taps; fewer++)
+                    _rows[fewer].waitForTap = true;
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the row for a number of completed taps.
+     *
+     * @param taps Number of completed taps, at most GESTURE_MAX_TAPS.
+     * @return The row.
+     */
+    Row const &getRow(uint8_t taps) const { return _rows[taps]; }
+
+    /**
+     * @brief Gets the timing parameters.
+     *
+     * @return The timing parameters.
+     */
+    GestureTimings const &getTimings() const { return _timings; }
+};
+
+/**
+ * @brief Recognizes the gestures of a GestureTable from button samples.
+ *
+ * @details Like ButtonStateMachine, the engine is fed with `(timestamp, level)` samples and
+ * holds only the recognition state; the table is passed on every update, so one table can be
+ * shared by many buttons. Every update does a constant amount of work whatever the number of
+ * gestures. It never allocates and has no virtual methods.
+ */
+class GestureEngine
+{
+public:
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF; // Returned by timeToDeadline() when only a level change can complete a gesture
+
+private:
+    /**
+     * @brief Phase of the recognition.
+     */
+    enum class Phase : uint8_t
+    {
+        IDLE,     // Released, no tap counted
+        PRESSED,  // Pressed, no hold reported yet
+        HOLDING,  // Pressed, a hold or repeat was reported
+        RELEASED, // Released between taps, waiting for the tap window
+    };
+
+    Phase _phase = Phase::IDLE; // Phase of the recognition
+    uint8_t _taps = 0;          // Taps completed in the current gesture
+    bool _holdReported = false; // The hold gesture of this press was reported
+    uint32_t _phaseStart = 0;   // Time the button was pressed or released
+    uint32_t _releaseTime = 0;  // Time of the release that opened the tap window
+    uint32_t _nextRepeat = 0;   // Time of the next repeat while holding
+
+    uint8_t finish(uint8_t gesture)
+    {
+        reset();
+        return gesture;
+    }
+
+    uint8_t updatePressed(uint32_t now, GestureTable::Row const &row, GestureTimings const &timings)
+    {
+        uint32_t held = now - _phaseStart;
+        if (row.hold != GestureTable::NO_GESTURE && !_holdReported && held >= timings.holdTime)
+        {
+            _holdReported = true;
+            _phase = Phase::HOLDING;
+            return row.hold;
+        }
+        if (row.repeat != GestureTable::NO_GESTURE && int32_t(now - _nextRepeat) >= 0)
+        {
+            _nextRepeat = now + timings.repeatInterval;
+            _phase = Phase::HOLDING;
+            return row.repeat;
+        }
+        return GestureTable::NO_GESTURE;
+    }
+
+    uint8_t updateReleased(uint32_t now, GestureTable const &table, GestureTimings const &timings)
+    {
+        if (_phase == Phase::HOLDING)
+            return finish(GestureTable::NO_GESTURE);
+
+        // Too short to be a tap, back to the taps counted before and their tap window
+        if (now - _phaseStart < timings.debounceTime)
+        {
+            _phase = _taps == 0 ? Phase::IDLE : Phase::RELEASED;
+            _phaseStart = _releaseTime;
+            return GestureTable::NO_GESTURE;
+        }
+
+        if (_taps < GESTURE_MAX_TAPS)
+            _taps++;
+        GestureTable::Row const &row = table.getRow(_taps);
+        if (!row.waitForTap)
+            return finish(row.tap);
+        _phase = Phase::RELEASED;
+        _phaseStart = now;
+        _releaseTime = now;
+        return GestureTable::NO_GESTURE;
+    }
+
+public:
+    /**
+     * @brief Forgets any gesture in progress.
+     */
+    void reset()
+    {
+        _phase = Phase::IDLE;
+        _taps = 0;
+        _holdReported = false;
+    }
+
+    /**
+     * @brief Feeds one sample into the engine.
+     *
+     * @param now Timestamp of the sample in milliseconds, wrapping around like millis().
+     * @param pressed Whether the button is pressed in this sample.
+     * @param table The gestures to recognize.
+     * @return Index of the gesture completed or repeated by this sample, or GestureTable::NO_GESTURE.
+     */
+    uint8_t update(uint32_t now, bool pressed, GestureTable const &table)
+    {
+        GestureTimings const &timings = table.getTimings();
+        switch (_phase)
+        {
+        case Phase::IDLE:
+        case Phase::RELEASED:
+            if (pressed)
+            {
+                _phase = Phase::PRESSED;
+                _phaseStart = now;
+                _holdReported = false;
+                _nextRepeat = now + timings.repeatDelay;
+                return updatePressed(now, table.getRow(_taps), timings);
+            }
+            // The tap window closed, the taps so far are the gesture
+            if (_phase == Phase::RELEASED && now - _phaseStart > timings.tapWindow)
+                return finish(table.getRow(_taps).tap);
+            return GestureTable::NO_GESTURE;
+        default:
+            if (pressed)
+                return updatePressed(now, table.getRow(_taps), timings);
+            return updateReleased(now, table, timings);
+        }
+    }
+
+    /**
+     * @brief Checks if no gesture is in progress.
+     *
+     * @return true if the engine is idle, false otherwise.
+     */
+    bool isIdle() const { return _phase == Phase::IDLE; }
+
+    /**
+     * @brief Gets the time until an unchanged level completes or repeats a gesture.
+     *
+     * @param now Current time in milliseconds.
+     * @param table The gestures to recognize.
+     * @return Milliseconds until the deadline, 0 if it has passed, or NO_DEADLINE.
+     */
+    uint32_t timeToDeadline(uint32_t now, GestureTable const &table) const
+    {
+        GestureTimings const &timings = table.getTimings();
+        GestureTable::Row const &row = table.getRow(_taps);
+        uint32_t deadline = NO_DEADLINE;
+        switch (_phase)
+        {
+        case Phase::RELEASED:
+            deadline = timings.tapWindow + 1 - (now - _phaseStart);
+            if (now - _phaseStart > timings.tapWindow)
+                deadline = 0;
+            break;
+        case Phase::PRESSED:
+        case Phase::HOLDING:
+            if (row.hold != GestureTable::NO_GESTURE && !_holdReported)
+            {
+                uint32_t held = now - _phaseStart;
+                deadline = held >= timings.holdTime ? 0 : timings.holdTime - held;
+            }
+            if (row.repeat != GestureTable::NO_GESTURE)
+            {
+                uint32_t untilRepeat = int32_t(_nextRepeat - now) > 0 ? _nextRepeat - now : 0;
+                if (untilRepeat < deadline)
+                    deadline = untilRepeat;
+            }
+            break;
+        default:
+            break;
+        }
+        return deadline;
+    }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+ * @file LatencyHistogram.hpp
+ * @brief Defines the LatencyHistogram class
+ * @details Header-only fixed-bucket histogram of latencies in microseconds
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <atomic>
+#include <stdint.h> // uint8_t, uint32_t
+
+#define LATENCY_HISTOGRAM_BUCKETS 124 // 4 buckets per power of two up to 2^32 microseconds
+
+/**
+ * @brief Histogram of latencies with a bounded relative error.
+ *
+ * @details Values below 4 us have a bucket each; above, every power of two is split into 4
+ * buckets, so a bucket is at most 25% wider than its lower bound. Recording is a handful of
+ * integer operations and one relaxed atomic increment, and never allocates. One task records
+ * while any task reads the counts and percentiles without locking.
+ */
+class LatencyHistogram
+{
+private:
+    std::atomic<uint32_t> _buckets[LATENCY_HISTOGRAM_BUCKETS]; // Number of values recorded in every bucket
+    std::atomic<uint32_t> _count{0};                           // Number of values recorded
+    std::atomic<uint32_t> _max{0};                             // Largest value recorded
+
+    static uint8_t bucketOf(uint32_t value)
+    {
+        if (value < 4)
+            return value;
+        uint8_t msb = 31 - __builtin_clz(value);
+        return 4 * (msb - 1) + ((value >> (msb - 2)) & 3);
+    }
+
+    static uint32_t upperBoundOf(uint8_t bucket)
+    {
+        if (bucket < 4)
+            return bucket;
+        uint8_t shift = bucket / 4 - 1;
+        uint32_t lower = uint32_t(4 + bucket % 4) << shift;
+        return lower + ((uint32_t(1) << shift) - 1);
+    }
+
+public:
+    /**
+     * @brief Constructor for LatencyHistogram.
+     */
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(LatencyHistogram const &) = delete;
+    LatencyHistogram &operator=(LatencyHistogram const &) = delete;
+
+    /**
+     * @brief Clears all buckets.
+     */
+    void reset()
+    {
+        for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+            _buckets[i].store(0, std::memory_order_relaxed);
+        _count.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records one latency. Must only be called by one task at a time.
+     *
+     * @param micros The latency in microseconds.
+     */
+    void record(uint32_t micros)
+    {
+        _buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        if (micros > _max.load(std::memory_order_relaxed))
+            _max.store(micros, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Gets the number of recorded latencies.
+     *
+     * @return The number of recorded latencies.
+     */
+    uint32_t getCount() const { return _count.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets the largest recorded latency.
+     *
+     * @return The largest latency in microseconds.
+     */
+    uint32_t getMax() const { return _max.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets a percentile of the recorded latencies.
+     *
+     * @param percent The percentile, e.g. 50 for the median or 99.
+     * @return The upper bound of the bucket holding the percentile in microseconds, 0 if nothing was recorded.
+     */
+    uint32_t getPercentile(uint8_t percent) const
+    {
+        uint32_t count = getCount();
+        if (count == 0)
+            return 0;
+
+        // Rank of the percentile, rounded up so that p100 is the last value
+        uint32_t rank = uint32_t((uint64_t(count) * (percent > 100 ? 100 : percent) + 99) / 100);
+        if (rank == 0)
+            rank = 1;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                uint32_t bound = upperBoundOf(i);
+                return bound < getMax() ? bound : getMax();
+            }
+        }
+        return getMax();
+    }
+};
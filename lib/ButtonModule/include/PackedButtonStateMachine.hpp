@@ -0,0 +1,179 @@
+#pragma once
+
+/**
+ * @file PackedButtonStateMachine.hpp
+ * @brief Defines the PackedButtonStateMachine class
+ * @details Header-only press detection with the classification of ButtonStateMachine in 4 bytes
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#include "ButtonStateMachine.hpp"
+
+/**
+ * @brief ButtonStateMachine packed into one 16 bit timestamp and one byte of flags.
+ *
+ * @details Reports the same events as ButtonStateMachine for the same samples. Only one
+ * timestamp is kept: the press time while pressed, the release time while released. The
+ * press count saturates at 3 where ButtonStateMachine wraps after 255; they only differ after
+ * 256 presses without an event, with single and double press both disabled.
+ * Timestamps are 16 bit: the press time saturates at the long press time, so presses of any
+ * length are classified alike as long as the long press time, the debounce time and the
+ * interval between samples add up to less than 65 seconds, which any scan loop does. Used where there are many keys, such as a ButtonMatrix.
+ */
+class PackedButtonStateMachine
+{
+private:
+    enum Flag : uint8_t
+    {
+        COUNT_MASK = 0x03,      // Completed presses in the current sequence, saturating
+        WAS_PRESSED = 1 << 2,   // Level of the previous sample
+        TRIGGER_FIRED = 1 << 3, // An event was reported, waiting for the release
+    };
+
+    uint16_t _time; // Press time while pressed, release time while released, in milliseconds
+    uint8_t _flags; // Flag bits
+
+    uint8_t countPress() const { return _flags & COUNT_MASK; }
+
+    ButtonStateMachine::Event fire(ButtonStateMachine::Event event)
+    {
+        _flags |= TRIGGER_FIRED;
+        return event;
+    }
+
+    ButtonStateMachine::Event handleButtonPress(uint16_t now, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (!(_flags & WAS_PRESSED))
+        {
+            // First time the button is pressed
+            _time = now;
+            _flags |= WAS_PRESSED;
+        }
+        else
+        {
+            // Button pressed again, check for long press and not a double press
+            uint16_t elapsed = uint16_t(now - _time);
+            if ((enabledEvents & ButtonStateMachine::LONG_PRESS_ENABLED) && countPress() == 0 && elapsed >= timings.longPressTime)
+                return fire(ButtonStateMachine::Event::LONG_PRESS);
+            // Past the long press time only the debounce check needs the press time, saturate it
+            // there so that a press longer than 65 seconds does not wrap around
+            if (elapsed > timings.longPressTime)
+                _time = now - timings.longPressTime;
+        }
+        return ButtonStateMachine::Event::NONE;
+    }
+
+    ButtonStateMachine::Event handleButtonRelease(uint16_t now, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (_flags & WAS_PRESSED)
+        {
+            // Button was released, the press time is only needed by the debounce check
+            bool bounce = uint16_t(_time - now) <= timings.debounceTime;
+            _time = now;
+            _flags = (_flags & ~WAS_PRESSED) | (countPress() < COUNT_MASK ? countPress() + 1 : COUNT_MASK);
+            if (bounce)
+            {
+                // Ignore short button release (debounce)
+                reset();
+                return ButtonStateMachine::Event::NONE;
+            }
+        }
+
+        if (countPress() == 0)
+            return ButtonStateMachine::Event::NONE;
+
+        // Check for single or double press
+        if ((enabledEvents & ButtonStateMachine::SINGLE_PRESS_ENABLED) &&
+            (!(enabledEvents & ButtonStateMachine::DOUBLE_PRESS_ENABLED) || uint16_t(now - _time) > timings.timeBetweenDoublePress))
+            return fire(ButtonStateMachine::Event::SINGLE_PRESS);
+        if ((enabledEvents & ButtonStateMachine::DOUBLE_PRESS_ENABLED) && countPress() >= 2)
+            return fire(ButtonStateMachine::Event::DOUBLE_PRESS);
+        return ButtonStateMachine::Event::NONE;
+    }
+
+public:
+    /**
+     * @brief Constructor for PackedButtonStateMachine.
+     */
+    PackedButtonStateMachine() { reset(); }
+
+    /**
+     * @brief Forgets any press in progress.
+     */
+    void reset()
+    {
+        _time = 0;
+        _flags = 0;
+    }
+
+    /**
+     * @brief Feeds one sample into the state machine.
+     *
+     * @param now Timestamp of the sample in milliseconds, wrapping around like millis().
+     * @param pressed Whether the button is pressed in this sample.
+     * @param timings Timing parameters of the detection.
+     * @param enabledEvents Mask of ButtonStateMachine::EnabledEvent bits.
+     * @return The event completed by this sample, or Event::NONE.
+     */
+    ButtonStateMachine::Event update(uint32_t now, bool pressed, ButtonTimings const &timings, uint8_t enabledEvents)
+    {
+        if (_flags & TRIGGER_FIRED)
+        {
+            // Wait until the button is released before resetting variables
+            if (!pressed)
+                reset();
+            return ButtonStateMachine::Event::NONE;
+        }
+
+        if (pressed)
+            return handleButtonPress(uint16_t(now), timings, enabledEvents);
+        return handleButtonRelease(uint16_t(now), timings, enabledEvents);
+    }
+
+    /**
+     * @brief Checks if no press, long press or double press window is in progress.
+     *
+     * @return true if the state machine is idle, false otherwise.
+     */
+    bool isIdle() const { return _flags == 0; }
+
+    /**
+     * @brief Checks if an event was reported and the machine waits for the release.
+     *
+     * @return true if the next released sample only clears the press, false otherwise.
+     */
+    bool isWaitingForRelease() const { return _flags & TRIGGER_FIRED; }
+
+    /**
+     * @brief Gets the time until an unchanged level completes an event.
+     *
+     * @details Same as ButtonStateMachine::timeToDeadline().
+     *
+     * @param now Current time in milliseconds.
+     * @param timings Timing parameters of the detection.
+     * @param enabledEvents Mask of ButtonStateMachine::EnabledEvent bits.
+     * @return Milliseconds until the deadline, 0 if it has passed, or ButtonStateMachine::NO_DEADLINE.
+     */
+    uint32_t timeToDeadline(uint32_t now, ButtonTimings const &timings, uint8_t enabledEvents) const
+    {
+        // A reported press clears on the next released sample, a long press waits for the release
+        if (_flags & TRIGGER_FIRED)
+            return (_flags & WAS_PRESSED) ? ButtonStateMachine::NO_DEADLINE : 0;
+
+        uint16_t elapsed = uint16_t(now) - _time;
+        if (_flags & WAS_PRESSED)
+        {
+            if (!(enabledEvents & ButtonStateMachine::LONG_PRESS_ENABLED) || countPress() != 0)
+                return ButtonStateMachine::NO_DEADLINE;
+            return elapsed >= timings.longPressTime ? 0 : timings.longPressTime - elapsed;
+        }
+
+        if (countPress() == 0 || !(enabledEvents & ButtonStateMachine::SINGLE_PRESS_ENABLED))
+            return ButtonStateMachine::NO_DEADLINE;
+        // The single press is reported once the window has strictly passed
+        return elapsed > timings.timeBetweenDoublePress ? 0 : timings.timeBetweenDoublePress + 1 - elapsed;
+    }
+};
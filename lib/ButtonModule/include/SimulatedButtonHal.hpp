@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file SimulatedButtonHal.hpp
+ * @brief Defines the SimulatedButtonHal class
+ * @details Header-only ButtonHalInterface backed by a virtual clock and simulated pins
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include "ButtonHalInterface.hpp"
+
+#define SIMULATED_BUTTON_HAL_PINS 64 // Number of simulated pins
+
+/**
+ * @brief Simulated time source and pins for deterministic tests.
+ *
+ * @details Time only moves when advance() is called and pin levels only change through
+ * setLevel(), which also runs the attached pin change handler like the interrupt would.
+ * Combined with ButtonModule::poll() a test can replay any press sequence without sleeping.
+ */
+class SimulatedButtonHal : public ButtonHalInterface
+{
+private:
+    uint64_t _nowMicros = 0;                                   // Virtual time in microseconds
+    bool _levels[SIMULATED_BUTTON_HAL_PINS] = {};              // Level of every pin
+    void (*_handlers[SIMULATED_BUTTON_HAL_PINS])(void *) = {}; // Attached pin change handlers
+    void *_handlerArgs[SIMULATED_BUTTON_HAL_PINS] = {};        // Parameters of the attached handlers
+    uint64_t _wakeupPins = 0;                                  // Pins enabled as a wakeup source, one bit per pin
+    int8_t _wakeupSource = -1;                                 // Pin that caused the last wakeup, or -1
+
+public:
+    uint32_t now() override { return uint32_t(_nowMicros / 1000); }
+
+    uint32_t micros() override { return uint32_t(_nowMicros); }
+
+    void setupPin(uint8_t) override {}
+
+    bool readPin(uint8_t pin) override { return pin < SIMULATED_BUTTON_HAL_PINS && _levels[pin]; }
+
+    uint64_t readPins() override
+    {
+        uint64_t levels = 0;
+        for (uint8_t pin = 0; pin < SIMULATED_BUTTON_HAL_PINS; pin++)
+            levels |= uint64_t(_levels[pin]) << pin;
+        return levels;
+    }
+
+    void attachPinInterrupt(uint8_t pin, void (*handler)(void *), void *arg) override
+    {
+        if (pin >= SIMULATED_BUTTON_HAL_PINS)
+            return;
+        _handlers[pin] = handler;
+        _handlerArgs[pin] = arg;
+    }
+
+    void detachPinInterrupt(uint8_t pin) override
+    {
+        if (pin < SIMULATED_BUTTON_HAL_PINS)
+            _handlers[pin] = nullptr;
+    }
+
+    bool enableWakeup(uint8_t pin, bool, bool) override
+    {
+        if (pin >= SIMULATED_BUTTON_HAL_PINS)
+            return false;
+        _wakeupPins |= uint64_t(1) << pin;
+        return true;
+    }
+
+    void disableWakeup(uint8_t pin) override
+    {
+        if (pin < SIMULATED_BUTTON_HAL_PINS)
+            _wakeupPins &= ~(uint64_t(1) << pin);
+    }
+
+    bool wasWakeupSource(uint8_t pin) override { return _wakeupSource == pin; }
+
+    /**
+     * @brief Checks if a pin was enabled as a wakeup source.
+     *
+     * @param pin The pin.
+     * @return true if enableWakeup() was called for the pin and disableWakeup() was not since, false otherwise.
+     */
+    bool isWakeupEnabled(uint8_t pin) const { return pin < SIMULATED_BUTTON_HAL_PINS && ((_wakeupPins >> pin) & 1); }
+
+    /**
+     * @brief Simulates the cause of the last wakeup.
+     *
+     * @param pin The pin that woke the chip, or -1 for another cause.
+     */
+    void setWakeupSource(int8_t pin) { _wakeupSource = pin; }
+
+    /**
+     * @brief Moves the virtual clock forward.
+     *
+     * @param ms Milliseconds to advance.
+     */
+    void advance(uint32_t ms) { _nowMicros += uint64_t(ms) * 1000; }
+
+    /**
+     * @brief Moves the virtual clock forward by less than a millisecond if needed.
+     *
+     * @param us Microseconds to advance.
+     */
+    void advanceMicros(uint32_t us) { _nowMicros += us; }
+
+    /**
+     * @brief Sets the virtual clock.
+     *
+     * @param ms The new time in milliseconds.
+     */
+    void setTime(uint32_t ms) { _nowMicros = uint64_t(ms) * 1000; }
+
+    /**
+     * @brief Drives a pin, calling its pin change handler if the level changes.
+     *
+     * @param pin The pin to drive.
+     * @param level true for high, false for low.
+     */
+    void setLevel(uint8_t pin, bool level)
+    {
+        if (pin >= SIMULATED_BUTTON_HAL_PINS || _levels[pin] == level)
+            return;
+        _levels[pin] = level;
+        if (_handlers[pin] != nullptr)
+            _handlers[pin](_handlerArgs[pin]);
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * @file SimulatedKeypadHal.hpp
+ * @brief Defines the SimulatedKeypadHal class
+ * @details Header-only SimulatedButtonHal wired to a simulated key matrix
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include "SimulatedButtonHal.hpp"
+
+#define SIMULATED_KEYPAD_HAL_LINES 8 // Maximum number of rows and of columns
+
+/**
+ * @brief Simulated keypad for deterministic ButtonMatrix tests.
+ *
+ * @details Rows are the outputs driven by the matrix, columns are inputs pulled up. A column
+ * reads low when a low row reaches it through pressed keys. Without diodes current also flows
+ * backwards through pressed keys, so three pressed corners of a rectangle pull the column of
+ * the fourth corner low: the ghost key a real diode-less keypad shows. Levels follow the rows
+ * at once, so the settle time of the matrix is ignored.
+ */
+class SimulatedKeypadHal : public SimulatedButtonHal
+{
+private:
+    uint8_t _rowPins[SIMULATED_KEYPAD_HAL_LINES];    // Pins of the rows
+    uint8_t _columnPins[SIMULATED_KEYPAD_HAL_LINES]; // Pins of the columns
+    uint8_t _rowCount;                               // Number of rows
+    uint8_t _columnCount;                            // Number of columns
+    bool _diodes;                                    // Every key has a diode, no ghosting
+    uint8_t _keys[SIMULATED_KEYPAD_HAL_LINES] = {};  // Pressed keys, one column bit per row
+    uint8_t _lowRows = 0;                            // Rows driven low, one bit per row
+
+    // Columns pulled low by the driven rows, one bit per column
+    uint8_t lowColumns() const
+    {
+        uint8_t rows = _lowRows;
+        uint8_t columns = 0;
+        while (true)
+        {
+            uint8_t reached = 0;
+            for (uint8_t row = 0; row < _rowCount; row++)
+                if ((rows >> row) & 1)
+                    reached |= _keys[row];
+            if (_diodes || reached == columns)
+                return reached;
+            columns = reached;
+            // Rows sharing a pressed key with a low column are low too
+            for (uint8_t row = 0; row < _rowCount; row++)
+                if (_keys[row] & columns)
+                    rows |= 1 << row;
+        }
+    }
+
+    int8_t columnOf(uint8_t pin) const
+    {
+        for (uint8_t column = 0; column < _columnCount; column++)
+            if (_columnPins[column] == pin)
+                return column;
+        return -1;
+    }
+
+public:
+    /**
+     * @brief Constructor for SimulatedKeypadHal.
+     *
+     * @param rowPins Pins of the rows.
+     * @param rowCount Number of rows, at most SIMULATED_KEYPAD_HAL_LINES.
+     * @param columnPins Pins of the columns.
+     * @param columnCount Number of columns, at most SIMULATED_KEYPAD_HAL_LINES.
+     * @param diodes Whether every key has a diode.
+     */
+    SimulatedKeypadHal(uint8_t const *rowPins, uint8_t rowCount, uint8_t const *columnPins, uint8_t columnCount, bool diodes = false)
+        : _rowCount(rowCount < SIMULATED_KEYPAD_HAL_LINES ? rowCount : SIMULATED_KEYPAD_HAL_LINES),
+          _columnCount(columnCount < SIMULATED_KEYPAD_HAL_LINES ? columnCount : SIMULATED_KEYPAD_HAL_LINES),
+          _diodes(diodes)
+    {
+        for (uint8_t row = 0; row < _rowCount; row++)
+            _rowPins[row] = rowPins[row];
+        for (uint8_t column = 0; column < _columnCount; column++)
+            _columnPins[column] = columnPins[column];
+    }
+
+    void writePin(uint8_t pin, bool level) override
+    {
+        for (uint8_t row = 0; row < _rowCount; row++)
+            if (_rowPins[row] == pin)
+                _lowRows = level ? _lowRows & ~(1 << row) : _lowRows | (1 << row);
+    }
+
+    bool readPin(uint8_t pin) override
+    {
+        int8_t column = columnOf(pin);
+        if (column < 0)
+            return SimulatedButtonHal::readPin(pin);
+        return !((lowColumns() >> column) & 1);
+    }
+
+    uint64_t readPins() override
+    {
+        uint64_t levels = SimulatedButtonHal::readPins();
+        uint8_t low = lowColumns();
+        for (uint8_t column = 0; column < _columnCount; column++)
+        {
+            uint64_t bit = uint64_t(1) << _columnPins[column];
+            levels = (low >> column) & 1 ? levels & ~bit : levels | bit;
+        }
+        return levels;
+    }
+
+    /**
+     * @brief Presses or releases a key.
+     *
+     * @param row Row of the key.
+     * @param column Column of the key.
+     * @param pressed Whether the key is pressed.
+     */
+    void setKey(uint8_t row, uint8_t column, bool pressed)
+    {
+        if (row >= _rowCount || column >= _columnCount)
+            return;
+        _keys[row] = pressed ? _keys[row] | (1 << column) : _keys[row] & ~(1 << column);
+    }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * @file SpscRing.hpp
+ * @brief Defines the SpscRing class template
+ * @details Header-only lock-free single producer, single consumer ring of fixed-size records
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <atomic>
+#include <stdint.h> // uint32_t
+
+/**
+ * @brief Fixed-size lock-free ring with one producer and one consumer.
+ *
+ * @details Records are pushed by exactly one producer task and popped by exactly one consumer
+ * task. Neither side ever blocks: when the ring is full new records are dropped and counted.
+ * The capacity is a power of two so the indices wrap with a mask and run freely, their
+ * difference being the number of queued records. The storage is provided by the caller, so
+ * rings of any capacity share one type, see ButtonEventQueue and ButtonLogRing.
+ *
+ * @tparam T Record type, copied in and out of the ring.
+ */
+template <typename T>
+class SpscRing
+{
+private:
+    T *const _buffer;                       // Ring storage
+    uint32_t const _mask;                   // Capacity - 1, capacity is a power of two
+    std::atomic<uint32_t> _head{0};         // Next slot to write, owned by the producer
+    std::atomic<uint32_t> _tail{0};         // Next slot to read, owned by the consumer
+    std::atomic<uint32_t> _droppedCount{0}; // Records dropped because the ring was full
+
+protected:
+    /**
+     * @brief Constructor for SpscRing.
+     *
+     * @param buffer Storage for the ring.
+     * @param capacity Number of records the storage holds, must be a power of two.
+     */
+    SpscRing(T *buffer, uint32_t capacity)
+        : _buffer(buffer), _mask(capacity - 1) {}
+
+public:
+    SpscRing(SpscRing const &) = delete;
+    SpscRing &operator=(SpscRing const &) = delete;
+
+    /**
+     * @brief Appends a record. Must only be called by the producer.
+     *
+     * @param record The record to append.
+     * @return true if the record was stored, false if the ring was full and the record was dropped.
+     */
+    bool push(T const &record)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) > _mask)
+        {
+            _droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _buffer[head & _mask] = record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest record. Must only be called by the consumer.
+     *
+     * @param record Receives the record.
+     * @return true if a record was removed, false if the ring was empty.
+     */
+    bool pop(T &record)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        record = _buffer[tail & _mask];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of queued records.
+     *
+     * @return The number of queued records.
+     */
+    uint32_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Gets the capacity of the ring.
+     *
+     * @return The maximum number of queued records.
+     */
+    uint32_t capacity() const { return _mask + 1; }
+
+    /**
+     * @brief Gets the number of records dropped because the ring was full.
+     *
+     * @return The number of dropped records.
+     */
+    uint32_t getDroppedCount() const { return _droppedCount.load(std::memory_order_relaxed); }
+};
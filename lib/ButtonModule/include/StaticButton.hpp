@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file StaticButton.hpp
+ * @brief Defines the StaticButton class template
+ * @details Header-only button with compile-time pin, active level, timings and handler
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+
+#include "ButtonStateMachine.hpp"
+
+#if defined(ARDUINO)
+#include <Arduino.h> // millis, pinMode, digitalRead
+#endif
+
+/**
+ * @brief Default timings of StaticButton, the same as ButtonModule::startListening.
+ *
+ * @details Custom timings are any type with the same three static constexpr members.
+ */
+struct DefaultStaticButtonTimings
+{
+    static constexpr uint16_t debounceTime = 90;            // Debounce time for button trigger
+    static constexpr uint16_t longPressTime = 1000;         // Long press time for button trigger
+    static constexpr uint16_t timeBetweenDoublePress = 500; // Time between double press for button trigger
+};
+
+/**
+ * @brief Button configured entirely at compile time.
+ *
+ * @details For fixed hardware, StaticButton replaces ButtonModule when neither the pin, the
+ * timings nor the handler change at runtime. The timings are constants folded into the
+ * ButtonStateMachine, and the handler is a functor called directly with the event, so the
+ * whole detection inlines into the caller: no virtual dispatch, no function pointers and no
+ * task. The owner calls poll() from its own loop or task at the desired check interval.
+ *
+ * @tparam Pin The pin of the button.
+ * @tparam ActiveLevel The level of the pin while the button is pressed.
+ * @tparam Timings Type with static constexpr debounceTime, longPressTime and timeBetweenDoublePress.
+ * @tparam Handler Functor called as `handler(ButtonStateMachine::Event)` for every detected event.
+ * @tparam EnabledEvents Mask of ButtonStateMachine::EnabledEvent bits the handler is interested in.
+ */
+template <uint8_t Pin, bool ActiveLevel, typename Timings, typename Handler,
+          uint8_t EnabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED |
+                                  ButtonStateMachine::LONG_PRESS_ENABLED>
+class StaticButton
+{
+private:
+    ButtonStateMachine _stateMachine; // Press detection state
+    Handler _handler;                 // Called for every detected event
+
+public:
+    /**
+     * @brief Constructor for StaticButton.
+     *
+     * @param handler The handler for the detected events.
+     */
+    explicit StaticButton(Handler handler = Handler()) : _handler(handler) {}
+
+    /**
+     * @brief Feeds one sample of the pin.
+     *
+     * @param now Timestamp of the sample in milliseconds.
+     * @param level Level of the pin, true for high.
+     */
+    void sample(uint32_t now, bool level)
+    {
+        ButtonTimings timings;
+        timings.debounceTime = Timings::debounceTime;
+        timings.longPressTime = Timings::longPressTime;
+        timings.timeBetweenDoublePress = Timings::timeBetweenDoublePress;
+
+        ButtonStateMachine::Event event = _stateMachine.update(now, level == ActiveLevel, timings, EnabledEvents);
+        if (event != ButtonStateMachine::Event::NONE)
+            _handler(event);
+    }
+
+    /**
+     * @brief Forgets any press in progress.
+     */
+    void reset() { _stateMachine.reset(); }
+
+    /**
+     * @brief Gets the handler.
+     *
+     * @return The handler.
+     */
+    Handler &getHandler() { return _handler; }
+
+#if defined(ARDUINO)
+    /**
+     * @brief Configures the pin as an input.
+     */
+    void begin() { pinMode(Pin, INPUT); }
+
+    /**
+     * @brief Samples the pin and runs a single detection step.
+     */
+    void poll() { sample(millis(), digitalRead(Pin) == HIGH); }
+
+    /**
+     * @brief Checks if the button is currently pressed.
+     *
+     * @return true if the button is pressed, false otherwise.
+     */
+    bool isPressed() const { return (digitalRead(Pin) == HIGH) == ActiveLevel; }
+#endif
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @file VerticalCounterDebouncer.hpp
+ * @brief Defines the VerticalCounterDebouncer class template
+ * @details Header-only debounce filter counting consecutive samples of many inputs at once
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <stdint.h> // uint8_t
+
+/**
+ * @brief Debounces every bit of a word with vertical counters.
+ *
+ * @details Each bit is one input, or lane. Every lane has a small counter of consecutive
+ * samples that differ from its debounced state; the counters are stored "vertically", bit b of
+ * every counter in word b, so one update increments, clears and compares all of them with a
+ * few bitwise operations per counter bit. A lane changes state once its counter reaches the
+ * configured number of samples; any sample agreeing with the state clears the counter, so
+ * glitches shorter than that are rejected however often they repeat.
+ *
+ * @tparam Word Unsigned integer type holding one bit per lane, e.g. uint32_t for 32 inputs.
+ * @tparam Bits Width of the counters, allowing up to 2^Bits - 1 samples.
+ */
+template <typename Word, uint8_t Bits = 4>
+class VerticalCounterDebouncer
+{
+    static_assert(Bits > 0 && Bits < 8, "Bits must be between 1 and 7");
+
+private:
+    Word _counter[Bits]; // Bit b of the counter of every lane
+    Word _state;         // Debounced state of every lane
+    uint8_t _samples;    // Consecutive differing samples needed to change state
+
+public:
+    /**
+     * @brief Maximum number of samples supported by the counter width.
+     */
+    static constexpr uint8_t MAX_SAMPLES = (1 << Bits) - 1;
+
+    /**
+     * @brief Constructor for VerticalCounterDebouncer.
+     *
+     * @param samples Consecutive differing samples needed to change state.
+     * @param state Initial state of every lane.
+     */
+    explicit VerticalCounterDebouncer(uint8_t samples = MAX_SAMPLES, Word state = 0)
+    {
+        setSamples(samples);
+        reset(state);
+    }
+
+    /**
+     * @brief Sets the number of consecutive differing samples needed to change state.
+     *
+     * @param samples The number of samples, clamped to 1..MAX_SAMPLES. 1 disables filtering.
+     * @return true if samples was used as given, false if it was clamped.
+     */
+    bool setSamples(uint8_t samples)
+    {
+        _samples = samples < 1 ? 1 : samples > MAX_SAMPLES ? MAX_SAMPLES : samples;
+        return _samples == samples;
+    }
+
+    /**
+     * @brief Sets the state of every lane and clears the counters.
+     *
+     * @param state The new state of every lane.
+     */
+    void reset(Word state)
+    {
+        for (uint8_t b = 0; b < Bits; b++)
+            _counter[b] = 0;
+        _state = state;
+    }
+
+    /**
+     * @brief Feeds one raw sample of every lane.
+     *
+     * @param sample Raw level of every lane.
+     * @return Mask of the lanes whose debounced state changed.
+     */
+    Word update(Word sample)
+    {
+        Word delta = sample ^ _state;
+
+        // Increment the counters of the lanes that differ, clear the others
+        Word carry = delta;
+        for (uint8_t b = 0; b < Bits; b++)
+        {
+            Word bit = _counter[b];
+            _counter[b] = (bit ^ carry) & delta;
+            carry &= bit;
+        }
+
+        // Lanes whose counter equals the number of samples
+        Word reached = delta;
+        for (uint8_t b = 0; b < Bits; b++)
+            reached &= ((_samples >> b) & 1) ? _counter[b] : Word(~_counter[b]);
+
+        _state ^= reached;
+        for (uint8_t b = 0; b < Bits; b++)
+            _counter[b] &= ~reached;
+        return reached;
+    }
+
+    /**
+     * @brief Gets the debounced state of every lane.
+     *
+     * @return The debounced state of every lane.
+     */
+    Word state() const { return _state; }
+};
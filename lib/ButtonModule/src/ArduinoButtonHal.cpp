@@ -0,0 +1,167 @@
+#include <Arduino.h>
+#if defined(ESP32)
+#include <driver/gpio.h>   // gpio_wakeup_enable, gpio_wakeup_disable
+#include <driver/rtc_io.h> // rtc_gpio_is_valid_gpio
+#include <esp_sleep.h>     // esp_sleep_enable_ext0_wakeup, esp_sleep_enable_ext1_wakeup, esp_sleep_disable_wakeup_source
+#include <esp_timer.h>     // esp_timer_get_time
+#include <soc/gpio_reg.h>  // GPIO_IN_REG, GPIO_IN1_REG
+#include <soc/soc.h>       // REG_READ
+#endif
+
+#include "ArduinoButtonHal.hpp"
+
+#if defined(ESP32)
+// Wakeup sources survive deep sleep, so the pin that woke the chip is known after the reboot
+RTC_DATA_ATTR static int8_t ext0WakeupPin = -1;   // Pin of the EXT0 wakeup, active low, or -1
+RTC_DATA_ATTR static uint64_t ext1WakeupPins = 0; // Pins of the EXT1 wakeup, any high
+static uint64_t lightSleepWakeupPins = 0;         // Pins of the GPIO wakeup from light sleep
+static uint64_t lightSleepWakeupLevels = 0;       // Levels waking the chip from light sleep, one bit per pin
+#endif
+
+ArduinoButtonHal &ArduinoButtonHal::getInstance()
+{
+    static ArduinoButtonHal instance;
+    return instance;
+}
+
+uint32_t ArduinoButtonHal::now()
+{
+    return millis();
+}
+
+uint32_t ArduinoButtonHal::micros()
+{
+#if defined(ESP32)
+    // Safe from interrupt context
+    return uint32_t(esp_timer_get_time());
+#else
+    return ::micros();
+#endif
+}
+
+void ArduinoButtonHal::setupPin(uint8_t pin)
+{
+    pinMode(pin, INPUT);
+}
+
+bool ArduinoButtonHal::readPin(uint8_t pin)
+{
+    return digitalRead(pin) == HIGH;
+}
+
+uint64_t ArduinoButtonHal::readPins()
+{
+#if defined(ESP32)
+    // Pins 0-31 and 32-39, one register read each
+    return REG_READ(GPIO_IN_REG) | (uint64_t(REG_READ(GPIO_IN1_REG) & 0xFF) << 32);
+#else
+    return ButtonHalInterface::readPins();
+#endif
+}
+
+void ArduinoButtonHal::setupOutputPin(uint8_t pin)
+{
+    pinMode(pin, OUTPUT);
+}
+
+void ArduinoButtonHal::writePin(uint8_t pin, bool level)
+{
+    digitalWrite(pin, level ? HIGH : LOW);
+}
+
+void ArduinoButtonHal::delayMicroseconds(uint32_t microseconds)
+{
+    ::delayMicroseconds(microseconds);
+}
+
+void ArduinoButtonHal::attachPinInterrupt(uint8_t pin, void (*handler)(void *), void *arg)
+{
+    attachInterruptArg(digitalPinToInterrupt(pin), handler, arg, CHANGE);
+}
+
+void ArduinoButtonHal::detachPinInterrupt(uint8_t pin)
+{
+    detachInterrupt(digitalPinToInterrupt(pin));
+}
+
+bool ArduinoButtonHal::enableWakeup(uint8_t pin, bool level, bool deepSleep)
+{
+#if defined(ESP32)
+    gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+    if (!deepSleep)
+    {
+        if (gpio_wakeup_enable(gpio, level ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL) != ESP_OK)
+            return false;
+        lightSleepWakeupPins |= uint64_t(1) << pin;
+        lightSleepWakeupLevels = level ? lightSleepWakeupLevels | (uint64_t(1) << pin) : lightSleepWakeupLevels & ~(uint64_t(1) << pin);
+        return esp_sleep_enable_gpio_wakeup() == ESP_OK;
+    }
+
+    // Only RTC GPIOs wake from deep sleep: EXT1 takes any number of pins going high, EXT0 one pin going low
+    if (!rtc_gpio_is_valid_gpio(gpio))
+        return false;
+    if (level)
+    {
+        if (esp_sleep_enable_ext1_wakeup(ext1WakeupPins | (uint64_t(1) << pin), ESP_EXT1_WAKEUP_ANY_HIGH) != ESP_OK)
+            return false;
+        ext1WakeupPins |= uint64_t(1) << pin;
+        return true;
+    }
+    if ((ext0WakeupPin >= 0 && ext0WakeupPin != pin) || esp_sleep_enable_ext0_wakeup(gpio, 0) != ESP_OK)
+        return false;
+    ext0WakeupPin = pin;
+    return true;
+#else
+    return ButtonHalInterface::enableWakeup(pin, level, deepSleep);
+#endif
+}
+
+void ArduinoButtonHal::disableWakeup(uint8_t pin)
+{
+#if defined(ESP32)
+    uint64_t bit = uint64_t(1) << pin;
+    if (lightSleepWakeupPins & bit)
+    {
+        gpio_wakeup_disable(static_cast<gpio_num_t>(pin));
+        lightSleepWakeupPins &= ~bit;
+        if (lightSleepWakeupPins == 0)
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    }
+    // EXT1 is armed with the whole mask, the remaining pins keep waking the chip
+    if (ext1WakeupPins & bit)
+    {
+        ext1WakeupPins &= ~bit;
+        if (ext1WakeupPins == 0)
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT1);
+        else
+            esp_sleep_enable_ext1_wakeup(ext1WakeupPins, ESP_EXT1_WAKEUP_ANY_HIGH);
+    }
+    if (ext0WakeupPin == pin)
+    {
+        ext0WakeupPin = -1;
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT0);
+    }
+#else
+    ButtonHalInterface::disableWakeup(pin);
+#endif
+}
+
+bool ArduinoButtonHal::wasWakeupSource(uint8_t pin)
+{
+#if defined(ESP32)
+    switch (esp_sleep_get_wakeup_cause())
+    {
+    case ESP_SLEEP_WAKEUP_EXT0:
+        return ext0WakeupPin == pin;
+    case ESP_SLEEP_WAKEUP_EXT1:
+        return (esp_sleep_get_ext1_wakeup_status() >> pin) & 1;
+    case ESP_SLEEP_WAKEUP_GPIO:
+        // The ESP32 does not latch which pin woke it from light sleep, take the ones still at their wakeup level
+        return ((lightSleepWakeupPins >> pin) & 1) && readPin(pin) == bool((lightSleepWakeupLevels >> pin) & 1);
+    default:
+        return false;
+    }
+#else
+    return ButtonHalInterface::wasWakeupSource(pin);
+#endif
+}
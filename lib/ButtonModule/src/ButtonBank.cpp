@@ -0,0 +1,183 @@
+#include <string.h> // memcpy
+
+#include "ButtonBank.hpp"
+
+namespace
+{
+    // One uint32_t per button, vector operations are expanded to scalar code where the target has none
+    typedef uint32_t Lanes __attribute__((vector_size(BUTTON_BANK_LANES * sizeof(uint32_t))));
+
+    uint32_t const COUNT_MASK = 0xFF;      // Completed presses in the current sequence, wrapping like ButtonStateMachine
+    uint32_t const WAS_PRESSED = 1 << 8;   // Level of the previous sample
+    uint32_t const TRIGGER_FIRED = 1 << 9; // An event was reported, waiting for the release
+
+    inline Lanes splat(uint32_t value)
+    {
+        return Lanes{} + value;
+    }
+
+    // All ones where the condition holds, zero elsewhere
+    inline Lanes mask(bool condition)
+    {
+        return splat(condition ? 0xFFFFFFFF : 0);
+    }
+
+    inline Lanes select(Lanes condition, Lanes ifSet, Lanes ifClear)
+    {
+        return (ifSet & condition) | (ifClear & ~condition);
+    }
+
+    inline Lanes load(uint32_t const *source)
+    {
+        Lanes lanes;
+        memcpy(&lanes, source, sizeof(lanes));
+        return lanes;
+    }
+
+    inline void store(uint32_t *destination, Lanes lanes)
+    {
+        memcpy(destination, &lanes, sizeof(lanes));
+    }
+}
+
+ButtonBank::ButtonBank(uint32_t *pressTimes, uint32_t *releaseTimes, uint32_t *states, uint32_t *activeWords, uint16_t buttonCount)
+    : _pressTimes(pressTimes),
+      _releaseTimes(releaseTimes),
+      _states(states),
+      _activeWords(activeWords),
+      _buttonCount(buttonCount)
+{
+    reset();
+}
+
+void ButtonBank::onEvent(ButtonBankCallback const &callback)
+{
+    _callback = callback;
+}
+
+void ButtonBank::setTimings(uint16_t debounceTime, uint16_t longPressTime, uint16_t timeBetweenDoublePress)
+{
+    _timings.debounceTime = debounceTime;
+    _timings.longPressTime = longPressTime;
+    _timings.timeBetweenDoublePress = timeBetweenDoublePress;
+}
+
+void ButtonBank::setEnabledEvents(uint8_t events)
+{
+    _enabledEvents = events;
+}
+
+uint16_t ButtonBank::getButtonCount() const
+{
+    return _buttonCount;
+}
+
+bool ButtonBank::isIdle(uint16_t button) const
+{
+    return button < _buttonCount && _states[button] == 0;
+}
+
+void ButtonBank::reset()
+{
+    for (uint32_t button = 0; button < storageSize(_buttonCount); button++)
+    {
+        _pressTimes[button] = 0;
+        _releaseTimes[button] = 0;
+        _states[button] = 0;
+    }
+    for (uint16_t word = 0; word < (_buttonCount + 31) / 32; word++)
+        _activeWords[word] = 0;
+}
+
+void ButtonBank::update(uint32_t now, uint32_t const *pressed)
+{
+    Lanes const nowLanes = splat(now);
+    Lanes const debounceTime = splat(_timings.debounceTime);
+    Lanes const longPressTime = splat(_timings.longPressTime);
+    Lanes const timeBetweenDoublePress = splat(_timings.timeBetweenDoublePress);
+    Lanes const singleEnabled = mask(_enabledEvents & ButtonStateMachine::SINGLE_PRESS_ENABLED);
+    Lanes const doubleEnabled = mask(_enabledEvents & ButtonStateMachine::DOUBLE_PRESS_ENABLED);
+    Lanes const longEnabled = mask(_enabledEvents & ButtonStateMachine::LONG_PRESS_ENABLED);
+
+    // Bit of every lane in the pressed word, a variable shift per lane has no SSE2 or NEON instruction
+    Lanes laneBits;
+    for (uint32_t lane = 0; lane < BUTTON_BANK_LANES; lane++)
+        laneBits[lane] = uint32_t(1) << lane;
+    uint32_t const laneMask = BUTTON_BANK_LANES == 32 ? 0xFFFFFFFF : (uint32_t(1) << (BUTTON_BANK_LANES % 32)) - 1;
+
+    // The arrays never alias the members, keep them out of the loop
+    uint32_t *const pressTimes = _pressTimes;
+    uint32_t *const releaseTimes = _releaseTimes;
+    uint32_t *const states = _states;
+    uint32_t *const activeWords = _activeWords;
+    uint32_t const words = (_buttonCount + 31) / 32;
+
+    for (uint32_t word = 0; word < words; word++)
+    {
+        // Bits past the last button are ignored, the padding buttons stay idle
+        uint32_t levels = pressed[word];
+        if (word + 1 == words && _buttonCount % 32 != 0)
+            levels &= (uint32_t(1) << (_buttonCount % 32)) - 1;
+
+        // A released, idle button would not change state, lanes without any are skipped
+        uint32_t pending = levels | activeWords[word];
+        while (pending != 0)
+        {
+            uint32_t offset = __builtin_ctz(pending) & ~uint32_t(BUTTON_BANK_LANES - 1);
+            uint32_t first = word * 32 + offset;
+            pending &= ~(laneMask << offset);
+
+            Lanes isPressed = (Lanes)((splat(levels >> offset) & laneBits) != 0);
+            Lanes pressTime = load(pressTimes + first);
+            Lanes releaseTime = load(releaseTimes + first);
+            Lanes state = load(states + first);
+            Lanes triggerFired = (Lanes)((state & TRIGGER_FIRED) != 0);
+            Lanes wasPressed = (Lanes)((state & WAS_PRESSED) != 0);
+            Lanes count = state & COUNT_MASK;
+
+            // Pressed, first time or check for long press
+            Lanes press = ~triggerFired & isPressed;
+            Lanes firstPress = press & ~wasPressed;
+            Lanes longPress = press & wasPressed & longEnabled & (Lanes)(count == 0) & (Lanes)(nowLanes - pressTime >= longPressTime);
+
+            // Released, count the press then check for debounce, single or double press
+            Lanes release = ~triggerFired & ~isPressed;
+            Lanes releasedNow = release & wasPressed;
+            releaseTime = select(releasedNow, nowLanes, select(firstPress, splat(0), releaseTime));
+            count = select(releasedNow, (count + 1) & COUNT_MASK, count);
+            Lanes counted = release & (Lanes)(count != 0);
+            Lanes bounce = counted & (Lanes)(pressTime - releaseTime <= debounceTime);
+            Lanes classify = counted & ~bounce;
+            Lanes singlePress = classify & singleEnabled & (~doubleEnabled | (Lanes)(nowLanes - releaseTime > timeBetweenDoublePress));
+            Lanes doublePress = classify & ~singlePress & doubleEnabled & (Lanes)(count >= 2);
+
+            // Reset once released after an event, or on a bounce
+            Lanes cleared = (triggerFired & ~isPressed) | bounce;
+            Lanes fired = longPress | singlePress | doublePress;
+            wasPressed = (wasPressed | firstPress) & ~releasedNow;
+            state = (count | (wasPressed & WAS_PRESSED) | ((triggerFired | fired) & TRIGGER_FIRED)) & ~cleared;
+            store(pressTimes + first, select(firstPress, nowLanes, pressTime) & ~cleared);
+            store(releaseTimes + first, releaseTime & ~cleared);
+            store(states + first, state);
+
+            Lanes activeLanes = (Lanes)(state != 0) & laneBits;
+            Lanes events = (singlePress & uint32_t(ButtonStateMachine::Event::SINGLE_PRESS)) |
+                           (doublePress & uint32_t(ButtonStateMachine::Event::DOUBLE_PRESS)) |
+                           (longPress & uint32_t(ButtonStateMachine::Event::LONG_PRESS));
+            uint32_t active = 0;
+            uint32_t any = 0;
+            for (uint32_t lane = 0; lane < BUTTON_BANK_LANES; lane++)
+            {
+                active |= activeLanes[lane];
+                any |= events[lane];
+            }
+            activeWords[word] = (activeWords[word] & ~(laneMask << offset)) | (active << offset);
+
+            if (any == 0 || !_callback)
+                continue;
+            for (uint32_t lane = 0; lane < BUTTON_BANK_LANES; lane++)
+                if (events[lane] != 0)
+                    _callback(first + lane, ButtonStateMachine::Event(events[lane]));
+        }
+    }
+}
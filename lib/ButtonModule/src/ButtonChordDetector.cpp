@@ -0,0 +1,307 @@
+#include "ButtonChordDetector.hpp"
+#include "ButtonLog.hpp"
+
+ButtonChordDetector::ButtonChordDetector(MultiPrinterLoggerInterface *const logger, uint16_t chordWindow, uint16_t sequenceWindow)
+    : _logger(logger),
+      _chordWindow(chordWindow),
+      _sequenceWindow(sequenceWindow)
+{
+    BUTTON_LOG_DEBUG(_logger, "Created with parameters: chordWindow=%d, sequenceWindow=%d", chordWindow, sequenceWindow);
+    // Recursive so that chord callbacks may reconfigure the detector
+    _mutex = xSemaphoreCreateRecursiveMutexStatic(&_mutexStorage);
+}
+
+ButtonChordDetector::~ButtonChordDetector()
+{
+    BUTTON_LOG_DEBUG(_logger, "Destroyed");
+    for (uint8_t i = 0; i < BUTTON_CHORD_MAX_MEMBERS; i++)
+        if (_members[i] != nullptr)
+            removeMember(_members[i]);
+    vSemaphoreDelete(_mutex);
+}
+
+int8_t ButtonChordDetector::addMember(ButtonModule *button)
+{
+    if (button == nullptr)
+        return -1;
+    if (button->_chordDetector == this)
+        return button->_chordMember;
+    if (button->_chordDetector != nullptr)
+        button->_chordDetector->removeMember(button);
+
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    // The first empty slot, left by a removed member or never used
+    int8_t member = 0;
+    while (member < BUTTON_CHORD_MAX_MEMBERS && _members[member] != nullptr)
+        member++;
+    if (member >= BUTTON_CHORD_MAX_MEMBERS)
+    {
+        xSemaphoreGiveRecursive(_mutex);
+        BUTTON_LOG_ERROR(_logger, "Cannot add member, detector is full (%d members)", BUTTON_CHORD_MAX_MEMBERS);
+        return -1;
+    }
+    _members[member] = button;
+    button->_chordDetector = this;
+    button->_chordMember = member;
+    xSemaphoreGiveRecursive(_mutex);
+
+    BUTTON_LOG_VERBOSE(_logger, "Member %d added", member);
+    return member;
+}
+
+bool ButtonChordDetector::removeMember(ButtonModule *button)
+{
+    if (button == nullptr || button->_chordDetector != this)
+        return false;
+
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    // Member indexes of the others stay stable, the slot is left empty for the next member
+    uint8_t member = button->_chordMember;
+    dropHeld(1 << member);
+    _members[member] = nullptr;
+    _pressed &= ~(1 << member);
+    button->_chordDetector = nullptr;
+    button->_chordCancelled = false;
+    xSemaphoreGiveRecursive(_mutex);
+
+    BUTTON_LOG_VERBOSE(_logger, "Member %d removed", member);
+    return true;
+}
+
+int8_t ButtonChordDetector::addDefinition(Chord const &chord)
+{
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    if (_chordCount >= BUTTON_CHORD_MAX_CHORDS)
+    {
+        xSemaphoreGiveRecursive(_mutex);
+        BUTTON_LOG_ERROR(_logger, "Cannot add chord, detector is full (%d chords)", BUTTON_CHORD_MAX_CHORDS);
+        return -1;
+    }
+    int8_t index = _chordCount++;
+    _chords[index] = chord;
+    xSemaphoreGiveRecursive(_mutex);
+    return index;
+}
+
+int8_t ButtonChordDetector::addChord(uint8_t memberMask, uint16_t holdTime, void (*callback)(void *), void *_pParameter)
+{
+    if (callback == nullptr || __builtin_popcount(memberMask) < 2)
+        return -1;
+
+    Chord chord = {};
+    chord.mask = memberMask;
+    chord.holdTime = holdTime;
+    chord.callback = callback;
+    chord.parameter = _pParameter;
+    int8_t index = addDefinition(chord);
+    BUTTON_LOG_VERBOSE(_logger, "Chord %d added with parameters: memberMask=0x%02x, holdTime=%d", index, memberMask, holdTime);
+    return index;
+}
+
+int8_t ButtonChordDetector::addSequence(uint8_t const *members, uint8_t length, void (*callback)(void *), void *_pParameter)
+{
+    if (callback == nullptr || members == nullptr || length < 2 || length > BUTTON_CHORD_MAX_STEPS)
+        return -1;
+
+    Chord chord = {};
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (members[i] >= BUTTON_CHORD_MAX_MEMBERS)
+            return -1;
+        chord.steps[i] = members[i];
+        chord.mask |= 1 << members[i];
+    }
+    // Failure function: the longest proper prefix that is also a suffix of the first i + 1 steps
+    for (uint8_t i = 1, matched = 0; i < length; i++)
+    {
+        while (matched > 0 && chord.steps[i] != chord.steps[matched])
+            matched = chord.fallback[matched - 1];
+        if (chord.steps[i] == chord.steps[matched])
+            matched++;
+        chord.fallback[i] = matched;
+    }
+    chord.length = length;
+    chord.callback = callback;
+    chord.parameter = _pParameter;
+    int8_t index = addDefinition(chord);
+    BUTTON_LOG_VERBOSE(_logger, "Sequence %d added with parameters: length=%d", index, length);
+    return index;
+}
+
+void ButtonChordDetector::update(uint32_t now, uint8_t pressed)
+{
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    uint8_t pressedEdges = pressed & ~_pressed;
+    _pressed = pressed;
+
+    // The engaged chord is reported once held long enough, and ends when a member is released
+    if (_engaged >= 0)
+    {
+        Chord const &chord = _chords[_engaged];
+        if ((pressed & chord.mask) != chord.mask)
+            _engaged = -1;
+        else if (!_engagedReported && now - _engagedAt >= chord.holdTime)
+        {
+            _engagedReported = true;
+            BUTTON_LOG_VERBOSE(_logger, "Chord %d detected", _engaged);
+            chord.callback(chord.parameter);
+        }
+    }
+
+    // Presses that engaged a chord are not steps of a sequence
+    if (updateChords(now, pressedEdges))
+        pressedEdges = 0;
+    updateSequences(now, pressedEdges);
+
+    // Nothing can match anymore, the members get their events back
+    if (!_groupOpen && !_sequencePending && _heldCount > 0)
+        dispatchHeld();
+    xSemaphoreGiveRecursive(_mutex);
+}
+
+bool ButtonChordDetector::updateChords(uint32_t now, uint8_t pressedEdges)
+{
+    if (pressedEdges != 0 && !_groupOpen)
+    {
+        _groupOpen = true;
+        _groupStart = now;
+        _groupMask = 0;
+    }
+    if (!_groupOpen)
+        return false;
+    _groupMask |= pressedEdges;
+
+    // The largest chord pressed within the window and still held
+    int8_t best = -1;
+    for (uint8_t i = 0; i < _chordCount; i++)
+    {
+        Chord const &chord = _chords[i];
+        if (chord.length == 0 && (chord.mask & _groupMask & _pressed) == chord.mask &&
+            (best < 0 || __builtin_popcount(chord.mask) > __builtin_popcount(_chords[best].mask)))
+            best = i;
+    }
+
+    bool expired = now - _groupStart > _chordWindow;
+    if (best < 0)
+    {
+        if (expired)
+            _groupOpen = false;
+        return false;
+    }
+
+    // Wait for the rest of a larger chord while the window is open
+    for (uint8_t i = 0; i < _chordCount && !expired; i++)
+    {
+        Chord const &chord = _chords[i];
+        if (chord.length == 0 && chord.mask != _chords[best].mask && (chord.mask & _chords[best].mask) == _chords[best].mask)
+            return false;
+    }
+
+    _groupOpen = false;
+    _engaged = best;
+    _engagedAt = now;
+    _engagedReported = false;
+    match(_chords[best]);
+    if (_chords[best].holdTime == 0)
+    {
+        _engagedReported = true;
+        BUTTON_LOG_VERBOSE(_logger, "Chord %d detected", best);
+        _chords[best].callback(_chords[best].parameter);
+    }
+    return true;
+}
+
+void ButtonChordDetector::updateSequences(uint32_t now, uint8_t pressedEdges)
+{
+    if (_sequencePending && now - _lastStep > _sequenceWindow)
+    {
+        for (uint8_t i = 0; i < _chordCount; i++)
+            _chords[i].progress = 0;
+        _sequencePending = false;
+    }
+
+    while (pressedEdges != 0)
+    {
+        uint8_t member = __builtin_ctz(pressedEdges);
+        pressedEdges &= pressedEdges - 1;
+        _lastStep = now;
+
+        bool pending = false;
+        for (uint8_t i = 0; i < _chordCount; i++)
+        {
+            Chord &chord = _chords[i];
+            if (chord.length == 0)
+                continue;
+            // On a mismatch, fall back to the longest matched steps the press can still extend
+            while (chord.progress > 0 && chord.steps[chord.progress] != member)
+                chord.progress = chord.fallback[chord.progress - 1];
+            if (chord.steps[chord.progress] == member)
+                chord.progress++;
+
+            if (chord.progress == chord.length)
+            {
+                match(chord);
+                BUTTON_LOG_VERBOSE(_logger, "Sequence %d detected", i);
+                chord.callback(chord.parameter);
+                return;
+            }
+            pending |= chord.progress > 0;
+        }
+        _sequencePending = pending;
+    }
+}
+
+void ButtonChordDetector::match(Chord const &chord)
+{
+    // The members forget their presses, so they report nothing of the chord
+    for (uint8_t member = 0; member < BUTTON_CHORD_MAX_MEMBERS; member++)
+        if ((chord.mask >> member) & 1 && _members[member] != nullptr)
+            _members[member]->cancelPress((_pressed >> member) & 1);
+    dropHeld(chord.mask);
+
+    for (uint8_t i = 0; i < _chordCount; i++)
+        _chords[i].progress = 0;
+    _sequencePending = false;
+}
+
+bool ButtonChordDetector::holdBack(uint8_t member, uint32_t now, ButtonStateMachine::Event event)
+{
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    if (!_groupOpen && !_sequencePending)
+    {
+        xSemaphoreGiveRecursive(_mutex);
+        return false;
+    }
+
+    // Out of room, the oldest event goes out now
+    if (_heldCount >= BUTTON_CHORD_HELD_EVENTS)
+    {
+        HeldEvent oldest = _held[0];
+        for (uint8_t i = 1; i < _heldCount; i++)
+            _held[i - 1] = _held[i];
+        _heldCount--;
+        if (_members[oldest.member] != nullptr)
+            _members[oldest.member]->dispatchEvent(oldest.time, oldest.event, true);
+    }
+    _held[_heldCount++] = {now, member, event};
+    xSemaphoreGiveRecursive(_mutex);
+    return true;
+}
+
+void ButtonChordDetector::dispatchHeld()
+{
+    uint8_t count = _heldCount;
+    _heldCount = 0;
+    for (uint8_t i = 0; i < count; i++)
+        if (_members[_held[i].member] != nullptr)
+            _members[_held[i].member]->dispatchEvent(_held[i].time, _held[i].event, true);
+}
+
+void ButtonChordDetector::dropHeld(uint8_t mask)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < _heldCount; i++)
+        if (!((mask >> _held[i].member) & 1))
+            _held[kept++] = _held[i];
+    _heldCount = kept;
+}
@@ -0,0 +1,176 @@
+#include "ArduinoButtonHal.hpp"
+#include "ButtonGroup.hpp"
+#include "ButtonLog.hpp"
+
+void ButtonGroup::scannerTask()
+{
+    while (true)
+    {
+        scan();
+        // Wait for the next iteration
+        vTaskDelay(_checkInterval / portTICK_PERIOD_MS);
+    }
+}
+
+void ButtonGroup::updateWord(uint32_t now, uint16_t word, uint32_t pressed, uint8_t enabledEvents)
+{
+    // A released, idle button would not change state, skip it
+    uint32_t pending = pressed | _activeWords[word];
+    uint32_t active = _activeWords[word];
+    while (pending != 0)
+    {
+        uint8_t bit = __builtin_ctz(pending);
+        pending &= pending - 1;
+        uint16_t button = word * 32 + bit;
+
+        ButtonStateMachine::Event event = _states[button].update(now, (pressed >> bit) & 1, _timings, enabledEvents);
+        if (_states[button].isIdle())
+            active &= ~(uint32_t(1) << bit);
+        else
+            active |= uint32_t(1) << bit;
+
+        if (event != ButtonStateMachine::Event::NONE)
+        {
+            BUTTON_LOG_VERBOSE(_logger, "Button %d event %d detected", button, int(event));
+            _callback(button, event);
+        }
+    }
+    _activeWords[word] = active;
+}
+
+void ButtonGroup::update(uint32_t now, uint32_t const *pressed)
+{
+    uint8_t enabledEvents = _callback ? _enabledEvents : 0;
+    uint16_t words = (_buttonCount + 31) / 32;
+    for (uint16_t word = 0; word < words; word++)
+    {
+        // Bits past the last button are ignored
+        uint32_t valid = word + 1 < words || _buttonCount % 32 == 0 ? ~uint32_t(0) : (uint32_t(1) << (_buttonCount % 32)) - 1;
+        updateWord(now, word, pressed[word] & valid, enabledEvents);
+    }
+}
+
+void ButtonGroup::scan()
+{
+    uint64_t levels = _hal->readPins();
+    uint32_t now = _hal->now();
+    uint8_t enabledEvents = _callback ? _enabledEvents : 0;
+
+    uint32_t pressed = 0;
+    for (uint16_t button = 0; button < _buttonCount; button++)
+    {
+        uint8_t pin = _pins[button];
+        // Bit 7 marks buttons pressed low
+        if (pin != NO_PIN && ((levels >> (pin & 0x3F)) & 1) != (pin >> 7))
+            pressed |= uint32_t(1) << (button % 32);
+        if (button % 32 == 31 || button + 1 == _buttonCount)
+        {
+            updateWord(now, button / 32, pressed, enabledEvents);
+            pressed = 0;
+        }
+    }
+}
+
+ButtonGroup::ButtonGroup(
+    PackedButtonStateMachine *states, uint8_t *pins, uint32_t *activeWords, uint16_t buttonCount,
+    MultiPrinterLoggerInterface *const logger, ButtonHalInterface *const hal)
+    : _logger(logger),
+      _hal(hal != nullptr ? hal : &ArduinoButtonHal::getInstance()),
+      _states(states),
+      _pins(pins),
+      _activeWords(activeWords),
+      _buttonCount(buttonCount)
+{
+    BUTTON_LOG_DEBUG(_logger, "Created with parameters: buttons=%d", buttonCount);
+    for (uint16_t button = 0; button < _buttonCount; button++)
+    {
+        _states[button].reset();
+        _pins[button] = NO_PIN;
+    }
+    for (uint16_t word = 0; word < (_buttonCount + 31) / 32; word++)
+        _activeWords[word] = 0;
+}
+
+ButtonGroup::~ButtonGroup()
+{
+    BUTTON_LOG_DEBUG(_logger, "Destroyed");
+    stopScanning();
+}
+
+void ButtonGroup::setPin(uint16_t button, uint8_t pin, bool onRaising)
+{
+    if (button >= _buttonCount)
+        return;
+    BUTTON_LOG_VERBOSE(_logger, "Button %d set to pin %d, onRaising = %s", button, pin, onRaising ? "HIGH" : "LOW");
+    if (pin < 64)
+        _hal->setupPin(pin);
+    _pins[button] = pin < 64 ? pin | (onRaising ? 0 : 0x80) : NO_PIN;
+}
+
+void ButtonGroup::onEvent(ButtonGroupCallback const &callback)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On event callback set");
+    _callback = callback;
+}
+
+void ButtonGroup::setTimings(uint8_t debounceTime, uint16_t longPressTime, uint16_t timeBetweenDoublePress)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Timings set with parameters: debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
+                       debounceTime, longPressTime, timeBetweenDoublePress);
+    _timings.debounceTime = debounceTime;
+    _timings.longPressTime = longPressTime;
+    _timings.timeBetweenDoublePress = timeBetweenDoublePress;
+}
+
+void ButtonGroup::setEnabledEvents(uint8_t events)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Enabled events set to 0x%02x", events);
+    _enabledEvents = events;
+}
+
+uint16_t ButtonGroup::getButtonCount() const
+{
+    return _buttonCount;
+}
+
+bool ButtonGroup::isActive(uint16_t button) const
+{
+    return button < _buttonCount && ((_activeWords[button / 32] >> (button % 32)) & 1);
+}
+
+void ButtonGroup::startScanning(uint16_t usStackDepth, char const *taskName, uint8_t checkInterval)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Scanning started with parameters: usStackDepth=%d, checkInterval=%d, buttons=%d",
+                       usStackDepth, checkInterval, _buttonCount);
+    _checkInterval = checkInterval;
+
+    bool nameing = true;
+    if (taskName == nullptr || strlen(taskName) < 2 || strlen(taskName) > 50)
+    {
+        // Use default task name
+        nameing = false;
+    }
+
+    // Stop any existing scanner task
+    stopScanning();
+
+    // Start scanner task
+    xTASK_CREATE_TRACKED(
+        [](void *thisPointer)
+        { static_cast<ButtonGroup *>(thisPointer)->scannerTask(); },
+        nameing ? taskName : "buttonGroupTask",
+        usStackDepth,
+        this,
+        1,
+        &_scannerTaskHandle);
+}
+
+void ButtonGroup::stopScanning()
+{
+    if (_scannerTaskHandle != nullptr)
+    {
+        BUTTON_LOG_VERBOSE(_logger, "Scanning stopped");
+        xTASK_DELETE_TRACKED(&_scannerTaskHandle);
+    }
+    _scannerTaskHandle = nullptr;
+}
@@ -0,0 +1,124 @@
+#include "ButtonGuard.hpp"
+#include "ButtonStateMachine.hpp"
+
+ButtonGuard::ButtonGuard(uint8_t maxEventsPerSecond, uint8_t burst, uint32_t stuckTime, uint16_t recoveryTime)
+{
+    setLimits(maxEventsPerSecond, burst, stuckTime, recoveryTime);
+}
+
+void ButtonGuard::setLimits(uint8_t maxEventsPerSecond, uint8_t burst, uint32_t stuckTime, uint16_t recoveryTime)
+{
+    _maxEventsPerSecond = maxEventsPerSecond;
+    _burst = burst > 0 ? burst : 1;
+    _stuckTime = stuckTime;
+    _recoveryTime = recoveryTime;
+    _tokens = uint32_t(_burst) * 1000;
+}
+
+void ButtonGuard::onReport(ButtonGuardCallback const &callback)
+{
+    _callback = callback;
+}
+
+bool ButtonGuard::admitSample(uint32_t now, bool pressed)
+{
+    // Checked before the level changes, a task blocked until the next press only sees it then
+    if (_quarantined && !_pressed && now - _levelTime >= _recoveryTime)
+        endQuarantine(now);
+    if (pressed != _pressed)
+    {
+        _pressed = pressed;
+        _levelTime = now;
+    }
+    bool stuck = _quarantined && _reason == ButtonGuardReport::Reason::STUCK;
+    if (!stuck && _pressed && _stuckTime > 0 && now - _levelTime >= _stuckTime)
+        startQuarantine(now, ButtonGuardReport::Reason::STUCK);
+    return !_quarantined || _reason != ButtonGuardReport::Reason::STUCK;
+}
+
+bool ButtonGuard::admitEvent(uint32_t now)
+{
+    if (_maxEventsPerSecond > 0)
+    {
+        // Refill for the time since the last event, a full bucket after burst seconds at the least rate
+        uint32_t capacity = uint32_t(_burst) * 1000;
+        uint32_t elapsed = now - _refillTime;
+        _refillTime = now;
+        uint32_t refill = elapsed < capacity ? elapsed * _maxEventsPerSecond : capacity;
+        _tokens = capacity - _tokens > refill ? _tokens + refill : capacity;
+    }
+    if (!_quarantined && (_maxEventsPerSecond == 0 || _tokens >= 1000))
+    {
+        _tokens -= _maxEventsPerSecond > 0 ? 1000 : 0;
+        _sequence.add(_admittedEvents);
+        return true;
+    }
+    if (!_quarantined)
+        startQuarantine(now, ButtonGuardReport::Reason::STORM);
+    _quarantineEvents++;
+    _sequence.add(_suppressedEvents);
+    return false;
+}
+
+void ButtonGuard::startQuarantine(uint32_t now, ButtonGuardReport::Reason reason)
+{
+    // A storm ending in a stuck input stays one quarantine
+    if (!_quarantined)
+    {
+        _quarantined = true;
+        _quarantineStart = now;
+        _quarantineEvents = 0;
+        _quarantinedFlag.store(true, std::memory_order_relaxed);
+    }
+    _reason = reason;
+    _sequence.add(reason == ButtonGuardReport::Reason::STORM ? _storms : _stuckInputs);
+    if (_callback)
+        _callback(ButtonGuardReport{reason, true, _quarantineEvents, now - _quarantineStart});
+}
+
+void ButtonGuard::endQuarantine(uint32_t now)
+{
+    _quarantined = false;
+    _quarantinedFlag.store(false, std::memory_order_relaxed);
+    _sequence.add(_quarantineTime, now - _quarantineStart);
+    // The bucket starts over, the storm is over
+    _tokens = uint32_t(_burst) * 1000;
+    _refillTime = now;
+    if (_callback)
+        _callback(ButtonGuardReport{_reason, false, _quarantineEvents, now - _quarantineStart});
+}
+
+uint32_t ButtonGuard::timeToDeadline(uint32_t now) const
+{
+    uint32_t elapsed = now - _levelTime;
+    if (_quarantined && !_pressed)
+        return elapsed < _recoveryTime ? _recoveryTime - elapsed : 0;
+    if (_pressed && _stuckTime > 0 && !(_quarantined && _reason == ButtonGuardReport::Reason::STUCK))
+        return elapsed < _stuckTime ? _stuckTime - elapsed : 0;
+    return ButtonStateMachine::NO_DEADLINE;
+}
+
+bool ButtonGuard::isQuarantined() const
+{
+    return _quarantinedFlag.load(std::memory_order_relaxed);
+}
+
+bool ButtonGuard::getCounters(ButtonGuardCounters &counters) const
+{
+    return _sequence.read([&]()
+                          {
+                              counters.admittedEvents = _admittedEvents.load(std::memory_order_relaxed);
+                              counters.suppressedEvents = _suppressedEvents.load(std::memory_order_relaxed);
+                              counters.storms = _storms.load(std::memory_order_relaxed);
+                              counters.stuckInputs = _stuckInputs.load(std::memory_order_relaxed);
+                              counters.quarantineTime = _quarantineTime.load(std::memory_order_relaxed); });
+}
+
+void ButtonGuard::reset()
+{
+    _quarantined = false;
+    _quarantinedFlag.store(false, std::memory_order_relaxed);
+    _tokens = uint32_t(_burst) * 1000;
+    _pressed = false;
+    _levelTime = 0;
+}
@@ -0,0 +1,201 @@
+#include "ArduinoButtonHal.hpp"
+#include "ButtonLog.hpp"
+#include "ButtonMatrix.hpp"
+
+void ButtonMatrix::scannerTask()
+{
+    while (true)
+    {
+        scan();
+        // Wait for the next iteration
+        vTaskDelay(_checkInterval / portTICK_PERIOD_MS);
+    }
+}
+
+uint64_t ButtonMatrix::readKeys()
+{
+    // Bit row * column count + column is set when the key is pressed
+    uint64_t pressed = 0;
+    for (uint8_t row = 0; row < _rowCount; row++)
+    {
+        _hal->writePin(_rowPins[row], false);
+        if (_settleMicros > 0)
+            _hal->delayMicroseconds(_settleMicros);
+        uint64_t levels = _hal->readPins();
+        _hal->writePin(_rowPins[row], true);
+
+        for (uint8_t column = 0; column < _columnCount; column++)
+            if (!((levels >> _columnPins[column]) & 1))
+                pressed |= uint64_t(1) << (row * _columnCount + column);
+    }
+    return pressed;
+}
+
+uint64_t ButtonMatrix::ambiguousKeys(uint64_t pressed) const
+{
+    uint64_t const rowMask = (uint64_t(1) << _columnCount) - 1;
+    uint64_t ambiguous = 0;
+
+    // Two rows sharing two pressed columns form a rectangle, any of its corners may be a ghost
+    for (uint8_t first = 0; first < _rowCount; first++)
+    {
+        uint64_t firstKeys = (pressed >> (first * _columnCount)) & rowMask;
+        if (__builtin_popcountll(firstKeys) < 2)
+            continue;
+        for (uint8_t second = first + 1; second < _rowCount; second++)
+        {
+            uint64_t shared = firstKeys & (pressed >> (second * _columnCount));
+            if (__builtin_popcountll(shared) < 2)
+                continue;
+            ambiguous |= (shared << (first * _columnCount)) | (shared << (second * _columnCount));
+        }
+    }
+    return ambiguous;
+}
+
+void ButtonMatrix::scan()
+{
+    uint64_t pressed = readKeys();
+    uint32_t now = _hal->now();
+
+    if (_antiGhosting)
+    {
+        // Keys of an ambiguous reading keep their previous level
+        uint64_t ambiguous = ambiguousKeys(pressed);
+        pressed = (pressed & ~ambiguous) | (_levelFilter.state() & ambiguous);
+    }
+    _levelFilter.update(pressed);
+    pressed = _levelFilter.state();
+
+    // A released, idle key would not change state, skip it
+    uint8_t enabledEvents = _keyCallback != nullptr ? _enabledEvents : 0;
+    uint64_t pending = pressed | _activeKeys;
+    while (pending != 0)
+    {
+        uint8_t key = __builtin_ctzll(pending);
+        pending &= pending - 1;
+
+        ButtonStateMachine::Event event = _keys[key].update(now, (pressed >> key) & 1, _timings, enabledEvents);
+        if (_keys[key].isIdle())
+            _activeKeys &= ~(uint64_t(1) << key);
+        else
+            _activeKeys |= uint64_t(1) << key;
+
+        if (event != ButtonStateMachine::Event::NONE)
+        {
+            BUTTON_LOG_VERBOSE(_logger, "Key %d event %d detected", key, int(event));
+            _keyCallback(key, event, _keyCallbackParameter);
+        }
+    }
+}
+
+ButtonMatrix::ButtonMatrix(
+    uint8_t const *rowPins, uint8_t rowCount, uint8_t const *columnPins, uint8_t columnCount,
+    MultiPrinterLoggerInterface *const logger, ButtonHalInterface *const hal)
+    : _logger(logger),
+      _hal(hal != nullptr ? hal : &ArduinoButtonHal::getInstance()),
+      _rowCount(rowCount < BUTTON_MATRIX_MAX_LINES ? rowCount : BUTTON_MATRIX_MAX_LINES),
+      _columnCount(columnCount < BUTTON_MATRIX_MAX_LINES ? columnCount : BUTTON_MATRIX_MAX_LINES)
+{
+    BUTTON_LOG_DEBUG(_logger, "Created with parameters: rows=%d, columns=%d", rowCount, columnCount);
+    // Rows idle high, columns read with pull-ups
+    for (uint8_t row = 0; row < _rowCount; row++)
+    {
+        _rowPins[row] = rowPins[row];
+        _hal->setupOutputPin(_rowPins[row]);
+        _hal->writePin(_rowPins[row], true);
+    }
+    for (uint8_t column = 0; column < _columnCount; column++)
+    {
+        _columnPins[column] = columnPins[column];
+        _hal->setupPin(_columnPins[column]);
+    }
+}
+
+ButtonMatrix::~ButtonMatrix()
+{
+    BUTTON_LOG_DEBUG(_logger, "Destroyed");
+    stopScanning();
+}
+
+void ButtonMatrix::onKeyEvent(void (*callback)(uint8_t, ButtonStateMachine::Event, void *), void *_pParameter)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On key event callback set");
+    // Set the callback function and its parameter for key events
+    _keyCallback = callback;
+    _keyCallbackParameter = _pParameter;
+}
+
+void ButtonMatrix::setTimings(uint8_t debounceTime, uint16_t longPressTime, uint16_t timeBetweenDoublePress)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Timings set with parameters: debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
+                       debounceTime, longPressTime, timeBetweenDoublePress);
+    _timings.debounceTime = debounceTime;
+    _timings.longPressTime = longPressTime;
+    _timings.timeBetweenDoublePress = timeBetweenDoublePress;
+}
+
+void ButtonMatrix::setEnabledEvents(uint8_t events)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Enabled events set to 0x%02x", events);
+    _enabledEvents = events;
+}
+
+void ButtonMatrix::setAntiGhosting(bool enabled)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Anti-ghosting %s", enabled ? "enabled" : "disabled");
+    _antiGhosting = enabled;
+}
+
+void ButtonMatrix::setSettleTime(uint8_t microseconds)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Settle time set to %d us", microseconds);
+    _settleMicros = microseconds;
+}
+
+uint8_t ButtonMatrix::getKeyCount() const
+{
+    return _rowCount * _columnCount;
+}
+
+bool ButtonMatrix::isKeyPressed(uint8_t key) const
+{
+    return key < getKeyCount() && ((_levelFilter.state() >> key) & 1);
+}
+
+void ButtonMatrix::startScanning(uint16_t usStackDepth, char const *taskName, uint8_t checkInterval)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Scanning started with parameters: usStackDepth=%d, checkInterval=%d, keys=%d",
+                       usStackDepth, checkInterval, getKeyCount());
+    _checkInterval = checkInterval;
+
+    bool nameing = true;
+    if (taskName == nullptr || strlen(taskName) < 2 || strlen(taskName) > 50)
+    {
+        // Use default task name
+        nameing = false;
+    }
+
+    // Stop any existing scanner task
+    stopScanning();
+
+    // Start scanner task
+    xTASK_CREATE_TRACKED(
+        [](void *thisPointer)
+        { static_cast<ButtonMatrix *>(thisPointer)->scannerTask(); },
+        nameing ? taskName : "buttonMatrixTask",
+        usStackDepth,
+        this,
+        1,
+        &_scannerTaskHandle);
+}
+
+void ButtonMatrix::stopScanning()
+{
+    if (_scannerTaskHandle != nullptr)
+    {
+        BUTTON_LOG_VERBOSE(_logger, "Scanning stopped");
+        xTASK_DELETE_TRACKED(&_scannerTaskHandle);
+    }
+    _scannerTaskHandle = nullptr;
+}
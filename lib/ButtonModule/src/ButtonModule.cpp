@@ -1,162 +1,504 @@
+#include <Arduino.h>
+#if defined(ESP32)
+#include <esp_timer.h> // esp_timer_get_time
+#endif
+
+#include "ArduinoButtonHal.hpp"
+#include "ButtonChordDetector.hpp"
+#include "ButtonLog.hpp"
 #include "ButtonModule.hpp"
+#include "ButtonScanner.hpp"
+
+// Attached to the buttons without diagnostics, so that checking one costs a single pointer
+static ButtonDiagnostics const noDiagnostics{};
 
 void ButtonModule::buttonTriggerTask()
 {
-    resetButtonState();
+    resetDetection();
 
     while (true)
     {
-        if (triggerFired)
+        if (_paused.load(std::memory_order_acquire))
         {
-            // Wait until the button is released before resetting variables
-            if (!isPressed())
-                resetButtonState();
+            // Keep the task, blocked until resumeListening() notifies it
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
         }
-        else
+
+        // Drop notifications of edges the poll below is about to see
+        if (_listeningMode == ListeningMode::INTERRUPT)
+            ulTaskNotifyTake(pdTRUE, 0);
+
+        poll();
+
+        // Wait for the next iteration, rounding up so the deadline has passed when waking
+        uint32_t delay = getPollDelay();
+        TickType_t ticks = delay == ButtonStateMachine::NO_DEADLINE
+                               ? portMAX_DELAY
+                               : (delay + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        if (_listeningMode == ListeningMode::INTERRUPT)
         {
-            if (isPressed())
-                handleButtonPress();
-            else
-                handleButtonRelease();
+            // Sleep until the deadline or the pin changes, then let the contacts settle
+            if (ulTaskNotifyTake(pdTRUE, ticks) > 0)
+                vTaskDelay(_config.checkInterval / portTICK_PERIOD_MS);
+            continue;
         }
-        // Wait for the next iteration
-        vTaskDelay(_checkInterval / portTICK_PERIOD_MS);
+        vTaskDelay(ticks);
     }
 }
 
-void ButtonModule::resetButtonState()
+void IRAM_ATTR ButtonModule::edgeInterruptHandler(void *thisPointer)
+{
+    ButtonModule *buttonModule = static_cast<ButtonModule *>(thisPointer);
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+#if defined(ESP32)
+    // Not through the HAL: its vtable is in flash, which may be unreachable while the interrupt runs
+    buttonModule->_edgeMicros.store(uint32_t(esp_timer_get_time()), std::memory_order_relaxed);
+#else
+    buttonModule->_edgeMicros.store(buttonModule->_hal->micros(), std::memory_order_relaxed);
+#endif
+    if (buttonModule->_buttonTriggerTaskHandle != nullptr)
+        vTaskNotifyGiveFromISR(buttonModule->_buttonTriggerTaskHandle, &higherPriorityTaskWoken);
+
+    if (higherPriorityTaskWoken)
+        portYIELD_FROM_ISR();
+}
+
+void ButtonModule::poll()
 {
-    wasPressed = false;
-    lastPressTime = 0;
-    lastReleaseTime = 0;
-    triggerFired = false;
-    countPress = 0;
+    bool pressed = sampleLevel();
+    processSample(_hal->now(), pressed);
 }
 
-void ButtonModule::handleButtonPress()
+bool ButtonModule::sampleLevel()
 {
-    if (!wasPressed)
+    bool raw = isPressed();
+    bool pressed = raw;
+    if (_config.debounceMode == DebounceMode::VERTICAL_COUNTER)
     {
-        // First time the button is pressed
-        lastPressTime = millis();
-        lastReleaseTime = 0;
-        wasPressed = true;
+        bool filtered = _levelFilter.state() != 0;
+        // A glitch ends when the level returns before the filter accepted it
+        if (_diagnostics->stats != nullptr && _lastRawLevel != filtered && raw == filtered)
+            _diagnostics->stats->addBounceRejected();
+        _levelFilter.update(raw);
+        pressed = _levelFilter.state() != 0;
     }
-    else
+    if (raw != _lastRawLevel)
     {
-        // Button pressed again, check for long press and not a double press
-        if (_longPressCallback && countPress == 0 && millis() - lastPressTime >= _longPressTime)
-        {
-            Log_Verbose(_logger, "Long press detected");
-            _longPressCallback(_longPressCallbackParameter);
-            triggerFired = true;
-        }
+        if (_diagnostics->stats != nullptr)
+            _diagnostics->stats->addEdge();
+        if (_diagnostics->traceRecorder != nullptr)
+            _diagnostics->traceRecorder->recordEdge(_hal->now(), raw);
     }
+    _lastRawLevel = raw;
+    return pressed;
 }
 
-void ButtonModule::handleButtonRelease()
+uint32_t ButtonModule::getPollDelay()
 {
-    if (wasPressed)
+    uint32_t delay = detectionDelay();
+    // A stuck input or the end of a quarantine is due without a pin change
+    if (_guard != nullptr)
     {
-        // Button was released
-        lastReleaseTime = millis();
-        countPress++;
-        wasPressed = false;
+        uint32_t guardDelay = _guard->timeToDeadline(_hal->now());
+        if (guardDelay < delay)
+            delay = guardDelay;
     }
+    return delay;
+}
 
-    if (countPress > 0)
+uint32_t ButtonModule::detectionDelay()
+{
+    applyConfig();
+    // Vertical counters need consecutive samples while the level differs from the filtered one
+    if (_config.debounceMode == DebounceMode::VERTICAL_COUNTER && isPressed() != (_levelFilter.state() != 0))
+        return _config.checkInterval;
+
+    if (isDetectionIdle())
     {
-        // Check if the button is released within the debounce time
-        if (lastPressTime - lastReleaseTime <= _debounceTime)
-        {
-            // Ignore short button release (debounce)
-            resetButtonState();
-        }
-        else
-        {
-            // Check for single or double press
-            handleSingleOrDoublePress();
-        }
+        if (_listeningMode == ListeningMode::INTERRUPT)
+            return ButtonStateMachine::NO_DEADLINE;
+        return _idleCheckInterval > 0 ? _idleCheckInterval : _config.checkInterval;
+    }
+
+    uint32_t deadline = _config.gestureTable != nullptr
+                            ? _gestureEngine.timeToDeadline(_hal->now(), *_config.gestureTable)
+                            : _stateMachine.timeToDeadline(_hal->now(), _config.timings, enabledEvents());
+    if (_listeningMode == ListeningMode::INTERRUPT)
+        return deadline;
+    return deadline < _config.checkInterval ? deadline : _config.checkInterval;
+}
+
+void ButtonModule::processSample(uint32_t now, bool pressed)
+{
+    if (_paused.load(std::memory_order_relaxed))
+        return;
+    applyConfig();
+    if (_restartDetection.load(std::memory_order_relaxed) && _restartDetection.exchange(false))
+    {
+        // The pin was not watched while paused
+        resetDetection();
+        _lastLevel = false;
+    }
+    if (_wakePress.load(std::memory_order_relaxed) && _wakePress.exchange(false) && !pressed)
+    {
+        // The press that woke the chip ended before this sample, replay it as starting earlier
+        processSample(now - 1, true);
+    }
+    bool held = _lastLevel && !_stateMachine.isWaitingForRelease();
+    if (pressed != _lastLevel)
+    {
+        // The interrupt timed the edge exactly, otherwise it happened at most one interval ago
+        _lastLevel = pressed;
+        _captureMicros = _listeningMode == ListeningMode::INTERRUPT && _buttonTriggerTaskHandle != nullptr
+                             ? _edgeMicros.load(std::memory_order_relaxed)
+                             : _hal->micros();
+        if (pressed)
+            _pressStartTime = now;
+        else if (_diagnostics->stats != nullptr)
+            _diagnostics->stats->addPressDuration(now - _pressStartTime);
+    }
+
+    // A stuck input is ignored until it recovers, forget the press it started
+    if (_guard != nullptr && !_guard->admitSample(now, pressed))
+    {
+        if (!isDetectionIdle())
+            resetDetection();
+        return;
+    }
+
+    // A chord took over this press, the button sees nothing until it is released
+    if (_chordCancelled)
+    {
+        if (pressed)
+            return;
+        _chordCancelled = false;
+    }
+
+    if (_config.gestureTable != nullptr)
+    {
+        processGesture(now, pressed);
+        return;
+    }
+
+    ButtonStateMachine::Event event = _stateMachine.update(now, pressed, _config.timings, enabledEvents());
+    if (_diagnostics->stats != nullptr)
+    {
+        _diagnostics->stats->addPoll();
+        // A release the state machine dropped instead of counting a press
+        if (held && !pressed && event == ButtonStateMachine::Event::NONE && _stateMachine.isIdle())
+            _diagnostics->stats->addBounceRejected();
     }
+    if (event == ButtonStateMachine::Event::NONE)
+        return;
+
+    // Held back while a chord over this button may still match
+    if (_chordDetector != nullptr && _chordDetector->holdBack(_chordMember, now, event))
+        return;
+    dispatchEvent(now, event);
 }
 
-void ButtonModule::handleSingleOrDoublePress()
+void ButtonModule::dispatchEvent(uint32_t now, ButtonStateMachine::Event event, bool held)
 {
-    if (_singlePressCallback && (!_doublePressCallback || millis() - lastReleaseTime > _timeBetweenDoublePress))
+    _dispatchMicros = _hal->micros();
+    if (_diagnostics->latencyHistogram != nullptr)
+        _diagnostics->latencyHistogram->record(_dispatchMicros - _captureMicros);
+    if (_diagnostics->stats != nullptr)
+        _diagnostics->stats->addEvent(event);
+    if (_diagnostics->logRing != nullptr)
     {
-        Log_Verbose(_logger, "Single press detected");
-        _singlePressCallback(_singlePressCallbackParameter);
-        triggerFired = true;
+        // A few bytes instead of text, formatted by whoever drains the ring
+        ButtonLogRecord::Id id = event == ButtonStateMachine::Event::SINGLE_PRESS   ? ButtonLogRecord::Id::SINGLE_PRESS
+                                 : event == ButtonStateMachine::Event::DOUBLE_PRESS ? ButtonLogRecord::Id::DOUBLE_PRESS
+                                                                                    : ButtonLogRecord::Id::LONG_PRESS;
+        _diagnostics->logRing->push({now, id, _pin, _dispatchMicros - _captureMicros});
     }
-    else if (_doublePressCallback && countPress >= 2)
+    if (_diagnostics->traceRecorder != nullptr)
+        _diagnostics->traceRecorder->recordEvent(now, event, _lastRawLevel, held);
+
+    // Recorded above either way, only delivered when the guard admits it
+    if (_guard != nullptr && !_guard->admitEvent(now))
+        return;
+    if (_eventQueue != nullptr)
+    {
+        // Hand the event over to the consumer task, a full queue counts the drop
+        if (!_eventQueue->push({now, _eventQueueButtonId, event, _captureMicros, _dispatchMicros}) && _diagnostics->logRing != nullptr)
+            _diagnostics->logRing->push({now, ButtonLogRecord::Id::EVENT_DROPPED, _pin, _eventQueue->getDroppedCount()});
+        return;
+    }
+
+    switch (event)
     {
-        Log_Verbose(_logger, "Double press detected");
-        _doublePressCallback(_doublePressCallbackParameter);
-        triggerFired = true;
+    case ButtonStateMachine::Event::SINGLE_PRESS:
+        BUTTON_LOG_VERBOSE(_logger, "Single press detected");
+        if (_config.singlePressCallback)
+            _config.singlePressCallback();
+        break;
+    case ButtonStateMachine::Event::DOUBLE_PRESS:
+        BUTTON_LOG_VERBOSE(_logger, "Double press detected");
+        if (_config.doublePressCallback)
+            _config.doublePressCallback();
+        break;
+    case ButtonStateMachine::Event::LONG_PRESS:
+        BUTTON_LOG_VERBOSE(_logger, "Long press detected");
+        if (_config.longPressCallback)
+            _config.longPressCallback();
+        break;
+    default:
+        break;
     }
+    if (_subscribers != nullptr)
+        _subscribers->dispatch(event);
+
+    if (_diagnostics->stats != nullptr)
+        _diagnostics->stats->addCallbackDuration(_hal->micros() - _dispatchMicros);
+}
+
+void ButtonModule::processGesture(uint32_t now, bool pressed)
+{
+    uint8_t gesture = _gestureEngine.update(now, pressed, *_config.gestureTable);
+    if (_diagnostics->stats != nullptr)
+        _diagnostics->stats->addPoll();
+    if (gesture == GestureTable::NO_GESTURE)
+        return;
+
+    _dispatchMicros = _hal->micros();
+    if (_diagnostics->latencyHistogram != nullptr)
+        _diagnostics->latencyHistogram->record(_dispatchMicros - _captureMicros);
+    if (_diagnostics->stats != nullptr)
+        _diagnostics->stats->addGesture();
+    if (_diagnostics->logRing != nullptr)
+        _diagnostics->logRing->push({now, ButtonLogRecord::Id::GESTURE, _pin, gesture});
+
+    // Recorded above either way, only delivered when the guard admits it; the trace has no
+    // gesture records, it keeps the edges the gesture is made of
+    if (_guard != nullptr && !_guard->admitEvent(now))
+        return;
+    BUTTON_LOG_VERBOSE(_logger, "Gesture %d detected", gesture);
+    _config.gestureCallback(gesture);
+    if (_diagnostics->stats != nullptr)
+        _diagnostics->stats->addCallbackDuration(_hal->micros() - _dispatchMicros);
+}
+
+bool ButtonModule::isDetectionIdle() const
+{
+    return _config.gestureTable != nullptr ? _gestureEngine.isIdle() : _stateMachine.isIdle();
+}
+
+void ButtonModule::resetDetection()
+{
+    _stateMachine.reset();
+    _gestureEngine.reset();
+}
+
+void ButtonModule::cancelPress(bool pressed)
+{
+    // Forget any pending press and ignore the current one, if any
+    resetDetection();
+    _chordCancelled = pressed;
+}
+
+ButtonConfig &ButtonModule::beginConfigUpdate()
+{
+    // Writers are serialized, the polling task never waits for them
+    xSemaphoreTakeRecursive(_configMutex, portMAX_DELAY);
+    _configSequence.store(_configSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return _publishedConfig;
+}
+
+void ButtonModule::endConfigUpdate()
+{
+    _configSequence.store(_configSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    xSemaphoreGiveRecursive(_configMutex);
+}
+
+void ButtonModule::applyConfig()
+{
+    uint32_t sequence = _configSequence.load(std::memory_order_acquire);
+    if (sequence == _appliedSequence || (sequence & 1))
+        return;
+
+    // A copy overlapping a write is detected by the sequence and retried on the next step
+    ButtonConfig config;
+    memcpy(static_cast<void *>(&config), static_cast<void const *>(&_publishedConfig), sizeof(ButtonConfig));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_configSequence.load(std::memory_order_relaxed) != sequence)
+        return;
+
+    // The press in progress is kept, only a new gesture table or debounce mode restarts its detection
+    if (config.gestureTable != _config.gestureTable)
+        _gestureEngine.reset();
+    if (config.debounceMode != _config.debounceMode)
+        _levelFilter.reset(_lastLevel ? 1 : 0);
+    // Enough consecutive samples to cover the debounce time, the counters hold at most MAX_SAMPLES
+    uint32_t samples = config.checkInterval > 0 ? (uint32_t(config.timings.debounceTime) + config.checkInterval - 1) / config.checkInterval : 1;
+    uint8_t used = samples < 1 ? 1 : samples > _levelFilter.MAX_SAMPLES ? _levelFilter.MAX_SAMPLES : uint8_t(samples);
+    _levelFilter.setSamples(used);
+    if (samples > used && config.debounceMode == DebounceMode::VERTICAL_COUNTER)
+        BUTTON_LOG_WARNING(_logger, "Debounce of %lu samples clamped to %d, debounceTime shortened from %d to %d ms",
+                           (unsigned long)samples, used, config.timings.debounceTime, used * config.checkInterval);
+    _config = config;
+    _appliedSequence = sequence;
+}
+
+uint8_t ButtonModule::enabledEvents() const
+{
+    if (_eventQueue != nullptr)
+        return _queuedEvents;
+
+    // Only events with a callback or a subscriber take part in the classification
+    return (_config.singlePressCallback ? ButtonStateMachine::SINGLE_PRESS_ENABLED : 0) |
+           (_config.doublePressCallback ? ButtonStateMachine::DOUBLE_PRESS_ENABLED : 0) |
+           (_config.longPressCallback ? ButtonStateMachine::LONG_PRESS_ENABLED : 0) |
+           (_subscribers != nullptr ? _subscribers->subscribedEvents() : 0);
 }
 
 ButtonModule::ButtonModule(
     uint8_t const pin, bool const onRaising,
-    MultiPrinterLoggerInterface *const logger)
+    MultiPrinterLoggerInterface *const logger,
+    ButtonHalInterface *const hal)
     : _pin(pin),
       _onRaising(onRaising),
-      _logger(logger)
+      _logger(logger),
+      _hal(hal != nullptr ? hal : &ArduinoButtonHal::getInstance())
 {
-    Log_Debug(_logger, "Created with parameters: pin = %d, onRaising = %s", pin, onRaising ? "HIGH" : "LOW");
+    BUTTON_LOG_DEBUG(_logger, "Created with parameters: pin = %d, onRaising = %s", pin, onRaising ? "HIGH" : "LOW");
+    // Recursive so that callbacks may reconfigure the button
+    _configMutex = xSemaphoreCreateRecursiveMutex();
+    _diagnostics = &noDiagnostics;
     // Set pin mode to input
-    pinMode(_pin, INPUT);
+    _hal->setupPin(_pin);
 }
 
 ButtonModule::~ButtonModule()
 {
-    Log_Debug(_logger, "Destroyed");
+    BUTTON_LOG_DEBUG(_logger, "Destroyed");
     // Clean up and stop listening when the instance is destroyed
     stopListening();
+    if (_scanner != nullptr)
+        _scanner->removeButton(this);
+    if (_chordDetector != nullptr)
+        _chordDetector->removeMember(this);
+    vSemaphoreDelete(_configMutex);
 }
 
 bool const ButtonModule::isPressed() const
 {
     // Check if the button is pressed based on the configured edge
-    return (digitalRead(_pin) == _onRaising);
+    return (_hal->readPin(_pin) == _onRaising);
 }
 
 void ButtonModule::onSinglePress(void (*callback)(void *), void *_pParameter)
 {
-    Log_Verbose(_logger, "On single press callback set");
+    BUTTON_LOG_VERBOSE(_logger, "On single press callback set");
     // Set the callback function and its parameter for a single press event
-    _singlePressCallback = callback;
-    _singlePressCallbackParameter = _pParameter;
+    beginConfigUpdate().singlePressCallback = ButtonCallback(callback, _pParameter);
+    endConfigUpdate();
+}
+
+void ButtonModule::onSinglePress(ButtonCallback const &callback)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On single press callback set");
+    beginConfigUpdate().singlePressCallback = callback;
+    endConfigUpdate();
 }
 
 void ButtonModule::onDoublePress(void (*callback)(void *), void *_pParameter)
 {
-    Log_Verbose(_logger, "On double press callback set");
+    BUTTON_LOG_VERBOSE(_logger, "On double press callback set");
     // Set the callback function and its parameter for a double press event
-    _doublePressCallback = callback;
-    _doublePressCallbackParameter = _pParameter;
+    beginConfigUpdate().doublePressCallback = ButtonCallback(callback, _pParameter);
+    endConfigUpdate();
+}
+
+void ButtonModule::onDoublePress(ButtonCallback const &callback)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On double press callback set");
+    beginConfigUpdate().doublePressCallback = callback;
+    endConfigUpdate();
 }
 
 void ButtonModule::onLongPress(void (*callback)(void *), void *_pParameter)
 {
-    Log_Verbose(_logger, "On long press callback set");
+    BUTTON_LOG_VERBOSE(_logger, "On long press callback set");
     // Set the callback function and its parameter for a long press event
-    _longPressCallback = callback;
-    _longPressCallbackParameter = _pParameter;
+    beginConfigUpdate().longPressCallback = ButtonCallback(callback, _pParameter);
+    endConfigUpdate();
+}
+
+void ButtonModule::onLongPress(ButtonCallback const &callback)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On long press callback set");
+    beginConfigUpdate().longPressCallback = callback;
+    endConfigUpdate();
+}
+
+void ButtonModule::setSubscribers(ButtonSubscribers *subscribers)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Subscribers %s", subscribers != nullptr ? "set" : "cleared");
+    _subscribers = subscribers;
+}
+
+void ButtonModule::onGesture(GestureTable const *table, void (*callback)(uint8_t, void *), void *_pParameter)
+{
+    onGesture(table, ButtonDelegate<uint8_t>(callback, _pParameter));
+}
+
+void ButtonModule::onGesture(GestureTable const *table, ButtonDelegate<uint8_t> const &callback)
+{
+    BUTTON_LOG_VERBOSE(_logger, "On gesture callback %s", table != nullptr ? "set" : "cleared");
+    // Set the gesture table and its callback, the polling task restarts the recognition
+    ButtonConfig &config = beginConfigUpdate();
+    config.gestureTable = callback ? table : nullptr;
+    config.gestureCallback = callback;
+    endConfigUpdate();
+}
+
+ButtonConfig ButtonModule::getConfig() const
+{
+    xSemaphoreTakeRecursive(_configMutex, portMAX_DELAY);
+    ButtonConfig config = _publishedConfig;
+    xSemaphoreGiveRecursive(_configMutex);
+    return config;
+}
+
+void ButtonModule::reconfigure(ButtonConfig const &config)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Reconfigured with parameters: checkInterval=%d, debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
+                       config.checkInterval, config.timings.debounceTime, config.timings.longPressTime, config.timings.timeBetweenDoublePress);
+    beginConfigUpdate() = config;
+    endConfigUpdate();
+}
+
+void ButtonModule::setTimings(uint8_t debounceTime, uint16_t longPressTime, uint16_t timeBetweenDoublePress)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Timings set with parameters: debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
+                       debounceTime, longPressTime, timeBetweenDoublePress);
+    ButtonConfig &config = beginConfigUpdate();
+    config.timings.debounceTime = debounceTime;
+    config.timings.longPressTime = longPressTime;
+    config.timings.timeBetweenDoublePress = timeBetweenDoublePress;
+    endConfigUpdate();
 }
 
 void ButtonModule::startListening(
     uint16_t usStackDepth, char const *taskName, uint8_t checkInterval,
     uint8_t debounceTime, uint16_t longPressTime,
-    uint16_t timeBetweenDoublePress)
+    uint16_t timeBetweenDoublePress, DebounceMode debounceMode)
 {
-    Log_Verbose(_logger, "Button listening started with parameters: usStackDepth=%d,  checkInterval=%d, debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
-                usStackDepth, checkInterval, debounceTime, longPressTime, timeBetweenDoublePress);
+    BUTTON_LOG_VERBOSE(_logger, "Button listening started with parameters: usStackDepth=%d,  checkInterval=%d, debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d, debounceMode=%s",
+                usStackDepth, checkInterval, debounceTime, longPressTime, timeBetweenDoublePress,
+                debounceMode == DebounceMode::VERTICAL_COUNTER ? "VERTICAL_COUNTER" : "TIMESTAMP");
     // Set configuration parameters for button trigger detection
-    _checkInterval = checkInterval;
-    _debounceTime = debounceTime;
-    _longPressTime = longPressTime;
-    _timeBetweenDoublePress = timeBetweenDoublePress;
+    ButtonConfig &config = beginConfigUpdate();
+    config.checkInterval = checkInterval;
+    config.timings.debounceTime = debounceTime;
+    config.timings.longPressTime = longPressTime;
+    config.timings.timeBetweenDoublePress = timeBetweenDoublePress;
+    config.debounceMode = debounceMode;
+    endConfigUpdate();
 
     bool nameing = true;
     if (taskName == nullptr || strlen(taskName) < 2 || strcmp(taskName, "") == 0 || strlen(taskName) > 50)
@@ -166,8 +508,13 @@ void ButtonModule::startListening(
         // taskName = "buttonTriggerTask";
     }
 
-    // Stop any existing listening task
+    // Stop any existing listening task and leave a shared scanner, if any
     stopListening();
+    if (_scanner != nullptr)
+        _scanner->removeButton(this);
+    // Nothing polls the button now, start from the new config
+    applyConfig();
+    _levelFilter.reset(0);
 
     // Start listening task
     xTASK_CREATE_TRACKED(
@@ -186,6 +533,10 @@ void ButtonModule::startListening(
     //     this,
     //     1,
     //     &_buttonTriggerTaskHandle);
+
+    // Wake the task on every pin change, it was created first so the handler always has a task to notify
+    if (_listeningMode == ListeningMode::INTERRUPT)
+        _hal->attachPinInterrupt(_pin, edgeInterruptHandler, this);
 }
 
 void ButtonModule::stopListening()
@@ -193,9 +544,117 @@ void ButtonModule::stopListening()
     // Stop the listening task and clean up resources
     if (_buttonTriggerTaskHandle != nullptr)
     {
-        Log_Verbose(_logger, "Button listening stopped");
+        BUTTON_LOG_VERBOSE(_logger, "Button listening stopped");
+        if (_listeningMode == ListeningMode::INTERRUPT)
+            _hal->detachPinInterrupt(_pin);
         xTASK_DELETE_TRACKED(&_buttonTriggerTaskHandle);
         // vTaskDelete(_buttonTriggerTaskHandle);
     }
     _buttonTriggerTaskHandle = nullptr;
+    // A button no longer listening would report nothing of the press waking the chip
+    disableWakeup();
+}
+
+void ButtonModule::pauseListening()
+{
+    if (_paused.exchange(true))
+        return;
+    BUTTON_LOG_VERBOSE(_logger, "Button listening paused");
+    // Pin changes would only wake the task to block again
+    if (_listeningMode == ListeningMode::INTERRUPT && _buttonTriggerTaskHandle != nullptr)
+        _hal->detachPinInterrupt(_pin);
+}
+
+void ButtonModule::resumeListening()
+{
+    if (!_paused.load())
+        return;
+    BUTTON_LOG_VERBOSE(_logger, "Button listening resumed");
+    _restartDetection.store(true);
+    if (_listeningMode == ListeningMode::INTERRUPT && _buttonTriggerTaskHandle != nullptr)
+        _hal->attachPinInterrupt(_pin, edgeInterruptHandler, this);
+    _paused.store(false, std::memory_order_release);
+    if (_buttonTriggerTaskHandle != nullptr)
+        xTaskNotifyGive(_buttonTriggerTaskHandle);
+}
+
+bool ButtonModule::isPaused() const
+{
+    return _paused.load();
+}
+
+bool ButtonModule::enableWakeup(bool deepSleep)
+{
+    bool enabled = _hal->enableWakeup(_pin, _onRaising, deepSleep);
+    _wakeupEnabled |= enabled;
+    if (enabled)
+        BUTTON_LOG_VERBOSE(_logger, "Wakeup from %s sleep enabled", deepSleep ? "deep" : "light");
+    else
+        BUTTON_LOG_ERROR(_logger, "Pin %d cannot wake the chip from %s sleep", _pin, deepSleep ? "deep" : "light");
+    return enabled;
+}
+
+void ButtonModule::disableWakeup()
+{
+    if (!_wakeupEnabled)
+        return;
+    _hal->disableWakeup(_pin);
+    _wakeupEnabled = false;
+    BUTTON_LOG_VERBOSE(_logger, "Wakeup disabled");
+}
+
+bool ButtonModule::handleWakeup()
+{
+    if (!_hal->wasWakeupSource(_pin))
+        return false;
+    BUTTON_LOG_VERBOSE(_logger, "Woke the chip");
+    _wakePress.store(true);
+    // Wake a task waiting for a pin change that already happened
+    if (_buttonTriggerTaskHandle != nullptr && !_paused.load())
+        xTaskNotifyGive(_buttonTriggerTaskHandle);
+    return true;
+}
+
+void ButtonModule::setListeningMode(ListeningMode mode)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Listening mode set to %s", mode == ListeningMode::INTERRUPT ? "INTERRUPT" : "POLLING");
+    // Detach the interrupt of a running task with the mode it was started with
+    stopListening();
+    _listeningMode = mode;
+}
+
+void ButtonModule::setIdleCheckInterval(uint16_t idleCheckInterval)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Idle check interval set to %d", idleCheckInterval);
+    _idleCheckInterval = idleCheckInterval;
+}
+
+void ButtonModule::setEventQueue(ButtonEventQueue *queue, uint8_t buttonId, uint8_t events)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Event queue %s, buttonId=%d", queue != nullptr ? "set" : "cleared", buttonId);
+    _eventQueue = queue;
+    _eventQueueButtonId = buttonId;
+    _queuedEvents = events;
+}
+
+uint32_t ButtonModule::getLastCaptureMicros() const
+{
+    return _captureMicros;
+}
+
+uint32_t ButtonModule::getLastDispatchMicros() const
+{
+    return _dispatchMicros;
+}
+
+void ButtonModule::setDiagnostics(ButtonDiagnostics const *diagnostics)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Diagnostics %s", diagnostics != nullptr ? "set" : "cleared");
+    _diagnostics = diagnostics != nullptr ? diagnostics : &noDiagnostics;
+}
+
+void ButtonModule::setGuard(ButtonGuard *guard)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Guard %s", guard != nullptr ? "set" : "cleared");
+    _guard = guard;
 }
@@ -0,0 +1,244 @@
+#include "ArduinoButtonHal.hpp"
+#include "ButtonLog.hpp"
+#include "ButtonScanner.hpp"
+
+void ButtonScanner::scannerTask()
+{
+    while (true)
+    {
+        scan();
+        // Wait for the next iteration
+        vTaskDelay(_checkInterval / portTICK_PERIOD_MS);
+    }
+}
+
+void ButtonScanner::scan()
+{
+    xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+    if (_scanMode == ScanMode::BATCHED)
+        scanBatched();
+    else
+        scanPerButton();
+    xSemaphoreGiveRecursive(_buttonsMutex);
+}
+
+void ButtonScanner::scanPerButton()
+{
+    if (_chordDetector == nullptr)
+    {
+        for (uint8_t i = 0; i < _buttonCount; i++)
+            _buttons[i]->poll();
+        return;
+    }
+
+    // Sample every button before any of them reacts, so chords are seen first
+    uint64_t pressed = 0;
+    for (uint8_t i = 0; i < _buttonCount; i++)
+        pressed |= uint64_t(_buttons[i]->sampleLevel()) << i;
+    updateChords(pressed);
+    for (uint8_t i = 0; i < _buttonCount; i++)
+        _buttons[i]->processSample(_buttons[i]->_hal->now(), (pressed >> i) & 1);
+}
+
+void ButtonScanner::updateChords(uint64_t pressed)
+{
+    uint8_t members = 0;
+    for (uint8_t i = 0; i < _buttonCount; i++)
+        if (_buttons[i]->_chordDetector == _chordDetector)
+            members |= uint8_t((pressed >> i) & 1) << _buttons[i]->_chordMember;
+    _chordDetector->update(_hal->now(), members);
+}
+
+void ButtonScanner::scanBatched()
+{
+    uint64_t levels = _hal->readPins();
+    uint32_t now = _hal->now();
+
+    // Bit i is set when button i is pressed
+    uint64_t pressed = 0;
+    for (uint8_t i = 0; i < _buttonCount; i++)
+    {
+        ButtonModule *button = _buttons[i];
+        bool level = button->_pin < 64 && ((levels >> button->_pin) & 1);
+        pressed |= uint64_t(level == button->_onRaising) << i;
+    }
+    _levelFilter.update(pressed);
+    pressed = _levelFilter.state();
+    if (_chordDetector != nullptr)
+        updateChords(pressed);
+
+    // A released, idle button would not change state, skip it
+    uint64_t pending = pressed | _activeButtons;
+    while (pending != 0)
+    {
+        uint8_t i = __builtin_ctzll(pending);
+        pending &= pending - 1;
+
+        ButtonModule *button = _buttons[i];
+        button->processSample(now, (pressed >> i) & 1);
+        // A press cancelled by a chord stays active until its release is seen
+        if (button->isDetectionIdle() && !button->_chordCancelled)
+            _activeButtons &= ~(uint64_t(1) << i);
+        else
+            _activeButtons |= uint64_t(1) << i;
+    }
+}
+
+ButtonScanner::ButtonScanner(MultiPrinterLoggerInterface *const logger, ButtonHalInterface *const hal)
+    : _logger(logger),
+      _hal(hal != nullptr ? hal : &ArduinoButtonHal::getInstance())
+{
+    BUTTON_LOG_DEBUG(_logger, "Created");
+    // Recursive so that callbacks running on the scanner task may add or remove buttons
+    _buttonsMutex = xSemaphoreCreateRecursiveMutex();
+}
+
+ButtonScanner::~ButtonScanner()
+{
+    BUTTON_LOG_DEBUG(_logger, "Destroyed");
+    // Stop the task first so nothing polls the buttons while they are detached
+    stopScanning();
+    while (_buttonCount > 0)
+        removeButton(_buttons[_buttonCount - 1]);
+    vSemaphoreDelete(_buttonsMutex);
+}
+
+bool ButtonScanner::addButton(
+    ButtonModule *button, uint8_t debounceTime, uint16_t longPressTime,
+    uint16_t timeBetweenDoublePress)
+{
+    if (button == nullptr)
+        return false;
+
+    // A button can only be polled from one place at a time
+    button->stopListening();
+    if (button->_scanner != nullptr && button->_scanner != this)
+        button->_scanner->removeButton(button);
+
+    xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+    bool registered = button->_scanner == this;
+    if (!registered && _buttonCount >= BUTTON_SCANNER_MAX_BUTTONS)
+    {
+        xSemaphoreGiveRecursive(_buttonsMutex);
+        BUTTON_LOG_ERROR(_logger, "Cannot add button, scanner is full (%d buttons)", BUTTON_SCANNER_MAX_BUTTONS);
+        return false;
+    }
+
+    button->setTimings(debounceTime, longPressTime, timeBetweenDoublePress);
+    button->resetDetection();
+    if (!registered)
+    {
+        _buttons[_buttonCount] = button;
+        button->_scanner = this;
+        _levelFilter.resetLane(_buttonCount, false);
+        _buttonCount++;
+    }
+    // The state machine was reset, the button starts released and idle
+    for (uint8_t i = 0; i < _buttonCount; i++)
+        if (_buttons[i] == button)
+            _activeButtons &= ~(uint64_t(1) << i);
+    xSemaphoreGiveRecursive(_buttonsMutex);
+
+    BUTTON_LOG_VERBOSE(_logger, "Button added with parameters: debounceTime=%d, longPressTime=%d, timeBetweenDoublePress=%d",
+                debounceTime, longPressTime, timeBetweenDoublePress);
+    return true;
+}
+
+bool ButtonScanner::removeButton(ButtonModule *button)
+{
+    bool removed = false;
+
+    xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < _buttonCount; i++)
+    {
+        if (_buttons[i] == button)
+        {
+            // Keep the remaining buttons contiguous by moving the last one into the gap
+            uint8_t last = --_buttonCount;
+            _buttons[i] = _buttons[last];
+            _buttons[last] = nullptr;
+            uint64_t lastActive = (_activeButtons >> last) & 1;
+            _activeButtons &= ~((uint64_t(1) << i) | (uint64_t(1) << last));
+            if (i != last)
+            {
+                _levelFilter.moveLane(last, i);
+                _activeButtons |= lastActive << i;
+            }
+            _levelFilter.resetLane(last, false);
+            button->_scanner = nullptr;
+            removed = true;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(_buttonsMutex);
+
+    if (removed)
+        BUTTON_LOG_VERBOSE(_logger, "Button removed");
+    return removed;
+}
+
+uint8_t ButtonScanner::getButtonCount() const
+{
+    return _buttonCount;
+}
+
+void ButtonScanner::startScanning(uint16_t usStackDepth, char const *taskName, uint8_t checkInterval)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Scanning started with parameters: usStackDepth=%d, checkInterval=%d, buttons=%d",
+                usStackDepth, checkInterval, _buttonCount);
+    _checkInterval = checkInterval;
+
+    bool nameing = true;
+    if (taskName == nullptr || strlen(taskName) < 2 || strlen(taskName) > 50)
+    {
+        // Use default task name
+        nameing = false;
+    }
+
+    // Stop any existing scanner task
+    stopScanning();
+
+    // Start scanner task
+    xTASK_CREATE_TRACKED(
+        [](void *thisPointer)
+        { static_cast<ButtonScanner *>(thisPointer)->scannerTask(); },
+        nameing ? taskName : "buttonScannerTask",
+        usStackDepth,
+        this,
+        1,
+        &_scannerTaskHandle);
+}
+
+void ButtonScanner::stopScanning()
+{
+    if (_scannerTaskHandle != nullptr)
+    {
+        BUTTON_LOG_VERBOSE(_logger, "Scanning stopped");
+        // Hold the mutex so the task is never deleted in the middle of a scan
+        xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+        xTASK_DELETE_TRACKED(&_scannerTaskHandle);
+        xSemaphoreGiveRecursive(_buttonsMutex);
+    }
+    _scannerTaskHandle = nullptr;
+}
+
+void ButtonScanner::setScanMode(ScanMode mode)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Scan mode set to %s", mode == ScanMode::BATCHED ? "BATCHED" : "PER_BUTTON");
+    xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+    // Start from released, idle buttons
+    _scanMode = mode;
+    _levelFilter.reset(0);
+    _activeButtons = 0;
+    for (uint8_t i = 0; i < _buttonCount; i++)
+        _buttons[i]->resetDetection();
+    xSemaphoreGiveRecursive(_buttonsMutex);
+}
+
+void ButtonScanner::setChordDetector(ButtonChordDetector *detector)
+{
+    BUTTON_LOG_VERBOSE(_logger, "Chord detector %s", detector != nullptr ? "set" : "cleared");
+    xSemaphoreTakeRecursive(_buttonsMutex, portMAX_DELAY);
+    _chordDetector = detector;
+    xSemaphoreGiveRecursive(_buttonsMutex);
+}
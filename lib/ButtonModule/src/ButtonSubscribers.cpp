@@ -0,0 +1,95 @@
+#include "ButtonSubscribers.hpp"
+
+ButtonSubscribers::ButtonSubscribers(ButtonSubscriber *slots, uint8_t capacity)
+    : _slots(slots),
+      _capacity(capacity < 32 ? capacity : 32)
+{
+    for (uint8_t event = 0; event < 3; event++)
+        _eventSlots[event].store(0, std::memory_order_relaxed);
+    // Recursive so that callbacks may subscribe and unsubscribe while dispatching
+    _mutex = xSemaphoreCreateRecursiveMutexStatic(&_mutexStorage);
+}
+
+ButtonSubscribers::~ButtonSubscribers()
+{
+    vSemaphoreDelete(_mutex);
+}
+
+int8_t ButtonSubscribers::subscribe(uint8_t events, ButtonSubscriber const &callback)
+{
+    events &= ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED |
+              ButtonStateMachine::LONG_PRESS_ENABLED;
+    if (events == 0 || !callback)
+        return -1;
+
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    uint32_t freeSlots = ~_used & (_capacity < 32 ? (uint32_t(1) << _capacity) - 1 : ~uint32_t(0));
+    if (freeSlots == 0)
+    {
+        xSemaphoreGiveRecursive(_mutex);
+        return -1;
+    }
+    int8_t slot = __builtin_ctz(freeSlots);
+    _slots[slot] = callback;
+    _used |= uint32_t(1) << slot;
+    // Published last, the dispatching task only calls slots it finds in these masks
+    for (uint8_t event = 0; event < 3; event++)
+        if ((events >> event) & 1)
+            _eventSlots[event].fetch_or(uint32_t(1) << slot, std::memory_order_release);
+    xSemaphoreGiveRecursive(_mutex);
+    return slot;
+}
+
+bool ButtonSubscribers::unsubscribe(int8_t subscription)
+{
+    if (subscription < 0 || subscription >= _capacity)
+        return false;
+
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    uint32_t bit = uint32_t(1) << subscription;
+    bool subscribed = (_used & bit) != 0;
+    _used &= ~bit;
+    // Not called by a dispatch in progress, even once another subscriber takes the slot
+    _pending &= ~bit;
+    for (uint8_t event = 0; event < 3; event++)
+        _eventSlots[event].fetch_and(~bit, std::memory_order_relaxed);
+    _slots[subscription] = nullptr;
+    xSemaphoreGiveRecursive(_mutex);
+    return subscribed;
+}
+
+uint8_t ButtonSubscribers::subscribedEvents() const
+{
+    uint8_t events = 0;
+    for (uint8_t event = 0; event < 3; event++)
+        if (_eventSlots[event].load(std::memory_order_relaxed) != 0)
+            events |= 1 << event;
+    return events;
+}
+
+uint8_t ButtonSubscribers::getCount() const
+{
+    return __builtin_popcount(_used);
+}
+
+void ButtonSubscribers::dispatch(ButtonStateMachine::Event event)
+{
+    if (event == ButtonStateMachine::Event::NONE)
+        return;
+    std::atomic<uint32_t> &eventSlots = _eventSlots[uint8_t(event) - 1];
+    if (eventSlots.load(std::memory_order_relaxed) == 0)
+        return;
+
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    // Subscribers added by a callback wait for the next event, removed ones are skipped
+    _pending = eventSlots.load(std::memory_order_acquire);
+    while (_pending != 0)
+    {
+        uint8_t slot = __builtin_ctz(_pending);
+        _pending &= _pending - 1;
+        // Called from a copy, a callback may reuse its own slot
+        ButtonSubscriber callback = _slots[slot];
+        callback(event);
+    }
+    xSemaphoreGiveRecursive(_mutex);
+}
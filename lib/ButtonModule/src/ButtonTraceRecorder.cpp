@@ -0,0 +1,173 @@
+#include <Arduino.h>
+
+#include "ButtonTraceRecorder.hpp"
+
+ButtonTraceRecorder::ButtonTraceRecorder(uint8_t *buffer, uint32_t capacity, uint16_t button)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _button(button)
+{
+}
+
+bool ButtonTraceRecorder::beginRecord()
+{
+    // Pairs with dump(): either the dump waits for this record or the record sees the dump and is skipped
+    _writing.store(true);
+    if (!_dumping.load())
+        return true;
+    _writing.store(false, std::memory_order_release);
+    _droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void ButtonTraceRecorder::recordEdge(uint32_t now, bool level)
+{
+    if (!beginRecord())
+        return;
+    // The first edge starts the trace at the level before it
+    if (!_started)
+        sync(now, !level);
+    sync(now, level);
+    _writing.store(false, std::memory_order_release);
+}
+
+void ButtonTraceRecorder::recordEvent(uint32_t now, ButtonStateMachine::Event event, bool level, bool held)
+{
+    if (event == ButtonStateMachine::Event::NONE || !beginRecord())
+        return;
+    // An event held back by a chord may be older than the last record, it is recorded at that time
+    if (held && _started && int32_t(now - _lastTime) < 0)
+        now = _lastTime;
+    sync(now, level);
+    append(now, ButtonTrace::eventTag(event));
+    _writing.store(false, std::memory_order_release);
+}
+
+void ButtonTraceRecorder::sync(uint32_t now, bool level)
+{
+    if (!_started)
+    {
+        _started = true;
+        _startTime = now;
+        _startLevel = level;
+        _lastTime = now;
+        _level = level;
+        return;
+    }
+    // Also restores the level after an edge skipped during a dump
+    if (level != _level)
+        append(now, ButtonTrace::EDGE);
+}
+
+void ButtonTraceRecorder::append(uint32_t now, ButtonTrace::Tag tag)
+{
+    uint32_t delta = now - _lastTime;
+    _lastTime = now;
+    // Longer gaps are bridged by pairs of edges at the same time, which leave the level unchanged
+    while (delta > MAX_DELTA)
+    {
+        appendRecord(MAX_DELTA, ButtonTrace::EDGE);
+        appendRecord(0, ButtonTrace::EDGE);
+        delta -= MAX_DELTA;
+    }
+    appendRecord(delta, tag);
+    if (tag == ButtonTrace::EDGE)
+        _level = !_level;
+}
+
+void ButtonTraceRecorder::appendRecord(uint32_t delta, ButtonTrace::Tag tag)
+{
+    uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+    uint8_t size = ButtonTrace::encodeRecord(delta, tag, record);
+    while (_capacity - _used < size)
+        dropOldest();
+    for (uint8_t i = 0; i < size; i++)
+    {
+        _buffer[_head] = record[i];
+        _head = _head + 1 < _capacity ? _head + 1 : 0;
+    }
+    _used += size;
+}
+
+void ButtonTraceRecorder::dropOldest()
+{
+    uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+    uint8_t available = _used < ButtonTrace::MAX_RECORD_SIZE ? _used : ButtonTrace::MAX_RECORD_SIZE;
+    uint32_t position = _tail;
+    for (uint8_t i = 0; i < available; i++)
+    {
+        record[i] = _buffer[position];
+        position = position + 1 < _capacity ? position + 1 : 0;
+    }
+    uint8_t const *data = record;
+    uint32_t delta = 0;
+    ButtonTrace::Tag tag = ButtonTrace::EDGE;
+    ButtonTrace::decodeRecord(data, record + available, delta, tag);
+    uint32_t size = data - record;
+
+    // The next record now starts from the time and level after this one
+    _startTime += delta;
+    if (tag == ButtonTrace::EDGE)
+        _startLevel = !_startLevel;
+    _tail = _tail + size < _capacity ? _tail + size : _tail + size - _capacity;
+    _used -= size;
+    _overwritten++;
+}
+
+size_t ButtonTraceRecorder::dump(ButtonTraceWriter const &writer, bool fileHeader)
+{
+    // Wait for a record in progress, later ones are skipped until the dump is done
+    _dumping.store(true);
+    while (_writing.load())
+        vTaskDelay(1);
+
+    size_t written = 0;
+    if (fileHeader)
+    {
+        uint8_t header[ButtonTrace::FILE_HEADER_SIZE];
+        ButtonTrace::writeFileHeader(header);
+        writer(header, sizeof(header));
+        written += sizeof(header);
+    }
+    uint8_t header[ButtonTrace::BLOCK_HEADER_SIZE];
+    ButtonTrace::writeBlockHeader({_button, uint8_t(_startLevel ? ButtonTrace::INITIAL_PRESSED : 0), _startTime, _used}, header);
+    writer(header, sizeof(header));
+    written += sizeof(header);
+
+    // The records, in one or two chunks around the end of the storage
+    uint32_t first = _capacity - _tail < _used ? _capacity - _tail : _used;
+    if (first > 0)
+        writer(_buffer + _tail, first);
+    if (_used > first)
+        writer(_buffer, _used - first);
+    written += _used;
+
+    _dumping.store(false, std::memory_order_release);
+    return written;
+}
+
+void ButtonTraceRecorder::clear()
+{
+    _head = 0;
+    _tail = 0;
+    _used = 0;
+    _started = false;
+    _startLevel = false;
+    _overwritten = 0;
+    _droppedCount.store(0, std::memory_order_relaxed);
+}
+
+uint32_t ButtonTraceRecorder::getSize() const
+{
+    return _used;
+}
+
+uint32_t ButtonTraceRecorder::getOverwrittenCount() const
+{
+    return _overwritten;
+}
+
+uint32_t ButtonTraceRecorder::getDroppedCount() const
+{
+    return _droppedCount.load(std::memory_order_relaxed);
+}
@@ -7,14 +7,6 @@
 
 #define INCLUDE_uxTaskGetStackHighWaterMark 1 // TaskHandle_t
 
-void singlePressCallback(void *parameter)
-{
-    int *value = (int *)parameter;
-    Serial.printf("Single Press Callback, parameter: %d\n", *value);
-
-    Serial.printf("High watermark: %u\n", uxTaskGetStackHighWaterMark(NULL));
-}
-
 void setup()
 {
     Serial.begin(115200);
@@ -29,8 +21,14 @@ void setup()
 
     ButtonModule *buttonModule = new ButtonModule(5, true, logger);
 
-    int *parameter = new int(10);
-    buttonModule->onSinglePress(singlePressCallback, parameter);
+    // The captured value is stored inside the button, nothing is allocated for it
+    int parameter = 10;
+    buttonModule->onSinglePress([parameter]
+                                {
+                                    Serial.printf("Single Press Callback, parameter: %d\n", parameter);
+
+                                    Serial.printf("High watermark: %u\n", uxTaskGetStackHighWaterMark(NULL));
+                                });
 
     buttonModule->startListening(2000, nullptr, 30, 90, 1000, 500);
 
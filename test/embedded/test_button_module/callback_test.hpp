@@ -309,4 +309,47 @@ TEST_F(CallbackTest, OnLongPressByLamda_mock_callback)
     delay(1500);
     digitalWrite(buttonPin2, !onRaising2);
     delay(150);
-}
\ No newline at end of file
+}
+TEST_F(CallbackTest, OnSinglePressInterruptMode)
+{
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    pinMode(buttonPin1, OUTPUT);
+    digitalWrite(buttonPin1, !onRaising1);
+    buttonModule1->startListening();
+    delay(150);
+    digitalWrite(buttonPin1, onRaising1);
+    delay(150);
+    digitalWrite(buttonPin1, !onRaising1);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 1);
+}
+
+TEST_F(CallbackTest, OnDoubleAndLongPressInterruptMode)
+{
+    buttonModule2->onDoublePress(myCallback,
+                                 counterCheck);
+    buttonModule2->onLongPress(myCallback,
+                               counterCheck);
+    buttonModule2->setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    pinMode(buttonPin2, OUTPUT);
+    digitalWrite(buttonPin2, !onRaising2);
+    buttonModule2->startListening();
+    delay(150);
+    digitalWrite(buttonPin2, onRaising2);
+    delay(150);
+    digitalWrite(buttonPin2, !onRaising2);
+    delay(150);
+    digitalWrite(buttonPin2, onRaising2);
+    delay(150);
+    digitalWrite(buttonPin2, !onRaising2);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    digitalWrite(buttonPin2, onRaising2);
+    delay(1500);
+    digitalWrite(buttonPin2, !onRaising2);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
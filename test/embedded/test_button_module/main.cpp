@@ -4,6 +4,7 @@
 
 #include "isPressed_test.hpp"
 #include "callback_test.hpp"
+#include "scanner_test.hpp"
 // #include "startListening_test.hpp"
 // #include "stopListening_test.hpp"
 
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <Arduino.h>
+
+#include "ButtonModule.hpp"
+#include "ButtonScanner.hpp"
+
+void scannerCallback(void *parameter)
+{
+    int *myparam = (int *)(parameter);
+    (*myparam)++;
+}
+
+class ScannerTest : public ::testing::Test
+{
+protected:
+    int buttonPin1 = 5;
+    bool onRaising1 = true;
+    int buttonPin2 = 14;
+    bool onRaising2 = false;
+    int *counterCheck;
+
+    ButtonModule *buttonModule1;
+    ButtonModule *buttonModule2;
+    ButtonScanner *buttonScanner;
+
+    void SetUp() override
+    {
+        buttonModule1 = new ButtonModule(buttonPin1, onRaising1);
+        buttonModule2 = new ButtonModule(buttonPin2, onRaising2);
+        buttonScanner = new ButtonScanner();
+        counterCheck = new int(0);
+
+        pinMode(buttonPin1, OUTPUT);
+        pinMode(buttonPin2, OUTPUT);
+        digitalWrite(buttonPin1, !onRaising1);
+        digitalWrite(buttonPin2, !onRaising2);
+    }
+
+    void TearDown() override
+    {
+        delete buttonScanner;
+        delete buttonModule1;
+        delete buttonModule2;
+        delete counterCheck;
+    }
+};
+
+TEST_F(ScannerTest, AddAndRemoveButtons)
+{
+    EXPECT_FALSE(buttonScanner->addButton(nullptr));
+    EXPECT_TRUE(buttonScanner->addButton(buttonModule1));
+    EXPECT_TRUE(buttonScanner->addButton(buttonModule2));
+    EXPECT_TRUE(buttonScanner->addButton(buttonModule2));
+    EXPECT_EQ(buttonScanner->getButtonCount(), 2);
+
+    EXPECT_TRUE(buttonScanner->removeButton(buttonModule1));
+    EXPECT_FALSE(buttonScanner->removeButton(buttonModule1));
+    EXPECT_EQ(buttonScanner->getButtonCount(), 1);
+
+    // Listening on its own task takes the button out of the scanner
+    buttonModule2->startListening();
+    EXPECT_EQ(buttonScanner->getButtonCount(), 0);
+}
+
+TEST_F(ScannerTest, OnSinglePressFromSharedTask)
+{
+    buttonModule1->onSinglePress(scannerCallback, counterCheck);
+    buttonModule2->onSinglePress(scannerCallback, counterCheck);
+    buttonScanner->addButton(buttonModule1);
+    buttonScanner->addButton(buttonModule2);
+    buttonScanner->startScanning();
+
+    digitalWrite(buttonPin1, onRaising1);
+    delay(150);
+    digitalWrite(buttonPin1, !onRaising1);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    digitalWrite(buttonPin2, onRaising2);
+    delay(150);
+    digitalWrite(buttonPin2, !onRaising2);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(ScannerTest, OnLongPressFromSharedTask)
+{
+    buttonModule1->onLongPress(scannerCallback, counterCheck);
+    buttonScanner->addButton(buttonModule1);
+    buttonScanner->startScanning();
+
+    digitalWrite(buttonPin1, onRaising1);
+    delay(1500);
+    digitalWrite(buttonPin1, !onRaising1);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 1);
+}
+
+TEST_F(ScannerTest, RemovedButtonIsNotPolled)
+{
+    buttonModule1->onSinglePress(scannerCallback, counterCheck);
+    buttonScanner->addButton(buttonModule1);
+    buttonScanner->startScanning();
+    buttonScanner->removeButton(buttonModule1);
+
+    digitalWrite(buttonPin1, onRaising1);
+    delay(150);
+    digitalWrite(buttonPin1, !onRaising1);
+    delay(150);
+    EXPECT_EQ(*counterCheck, 0);
+}
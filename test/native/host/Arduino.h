@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino core and FreeRTOS used by the library
+ * @details Lets the library build for the native env. Tasks are never started: host tests
+ * drive ButtonModule::poll() themselves with a SimulatedButtonHal.
+ */
+
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define CHANGE 0x03
+
+#define digitalPinToInterrupt(p) (p)
+
+inline unsigned long millis()
+{
+    static auto const start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long micros()
+{
+    static auto const start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline void delayMicroseconds(unsigned int) {}
+
+inline uint8_t &hostPinLevel(uint8_t pin)
+{
+    static uint8_t levels[64] = {};
+    return levels[pin & 63];
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t pin) { return hostPinLevel(pin); }
+inline void digitalWrite(uint8_t pin, uint8_t level) { hostPinLevel(pin) = level; }
+inline void attachInterruptArg(uint8_t, void (*)(void *), void *, int) {}
+inline void detachInterrupt(uint8_t) {}
+
+// FreeRTOS
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+struct StaticSemaphore_t
+{
+    uint8_t storage[80];
+};
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+#define portYIELD_FROM_ISR() \
+    do                       \
+    {                        \
+    } while (0)
+
+inline void vTaskDelay(TickType_t) {}
+inline void taskYIELD() { std::this_thread::yield(); }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    static int mutex;
+    return &mutex;
+}
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buffer) { return buffer; }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}
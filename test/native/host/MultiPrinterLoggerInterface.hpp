@@ -0,0 +1,19 @@
+#pragma once
+
+/**
+ * @file MultiPrinterLoggerInterface.hpp
+ * @brief Host stand-in for MultiPrinterLogger
+ * @details Log calls are discarded.
+ */
+
+class MultiPrinterLoggerInterface
+{
+public:
+    virtual ~MultiPrinterLoggerInterface() = default;
+};
+
+#define Log_Error(logger, ...) ((void)(logger))
+#define Log_Warning(logger, ...) ((void)(logger))
+#define Log_Info(logger, ...) ((void)(logger))
+#define Log_Debug(logger, ...) ((void)(logger))
+#define Log_Verbose(logger, ...) ((void)(logger))
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * @file TaskTracker.hpp
+ * @brief Host stand-in for TaskTracker
+ * @details Tasks get a handle but never run.
+ */
+
+#include <Arduino.h>
+
+inline BaseType_t xTASK_CREATE_TRACKED(
+    void (*)(void *), char const *, uint32_t, void *, UBaseType_t, TaskHandle_t *handle)
+{
+    static int task;
+    *handle = &task;
+    return pdPASS;
+}
+
+inline void xTASK_DELETE_TRACKED(TaskHandle_t *handle)
+{
+    *handle = nullptr;
+}
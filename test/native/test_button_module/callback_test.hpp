@@ -0,0 +1,387 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+void myCallback(void *parameter)
+{
+    int *myparam = (int *)(parameter);
+    (*myparam)++;
+}
+
+class MyClass
+{
+public:
+    virtual ~MyClass() = default;
+
+    virtual void myCallback(void *parameter)
+    {
+        int *myparam = (int *)(parameter);
+        (*myparam)++;
+    }
+};
+
+class MockMyClass : public MyClass
+{
+public:
+    MOCK_METHOD(void, myCallback, (void *parameter), (override));
+};
+
+class CallbackTest : public ::testing::Test
+{
+protected:
+    int buttonPin1 = 5;
+    bool onRaising1 = true;
+    int buttonPin2 = 14;
+    bool onRaising2 = false;
+    uint32_t checkInterval = 30;
+    int *counterCheck;
+
+    SimulatedButtonHal hal;
+    ButtonModule *buttonModule1;
+    ButtonModule *buttonModule2;
+    MockMyClass *mockMyClass;
+
+    void SetUp() override
+    {
+        buttonModule1 = new ButtonModule(buttonPin1, onRaising1, nullptr, &hal);
+        buttonModule2 = new ButtonModule(buttonPin2, onRaising2, nullptr, &hal);
+        counterCheck = new int(0);
+        mockMyClass = new MockMyClass();
+
+        hal.setLevel(buttonPin1, !onRaising1);
+        hal.setLevel(buttonPin2, !onRaising2);
+    }
+
+    void TearDown() override
+    {
+        delete buttonModule1;
+        delete buttonModule2;
+        delete counterCheck;
+        delete mockMyClass;
+    }
+
+    // Advances virtual time, polling both buttons every check interval like their listening tasks
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            buttonModule1->poll();
+            buttonModule2->poll();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(CallbackTest, OnSinglePressByFunction)
+{
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnSinglePressByLamda)
+{
+    buttonModule1->onSinglePress([](void *parameter)
+                                 { ((int *)parameter)[0]++; },
+                                 counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onSinglePress([](void *parameter)
+                                 { ((int *)parameter)[0]++; },
+                                 counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnSinglePressByLamda_mock_callback)
+{
+    buttonModule1->onSinglePress([](void *parameter)
+                                 { ((MockMyClass *)parameter)->myCallback(parameter); },
+                                 mockMyClass);
+    buttonModule1->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+
+    buttonModule2->onSinglePress([](void *parameter)
+                                 { ((MockMyClass *)parameter)->myCallback(parameter); },
+                                 mockMyClass);
+    buttonModule2->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+}
+
+TEST_F(CallbackTest, OnDoublePressByFunction)
+{
+    buttonModule1->onDoublePress(myCallback,
+                                 counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onDoublePress(myCallback,
+                                 counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnDoublePressByLamda)
+{
+    buttonModule1->onDoublePress([](void *parameter)
+                                 { ((int *)parameter)[0]++; },
+                                 counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onDoublePress([](void *parameter)
+                                 { ((int *)parameter)[0]++; },
+                                 counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnDoublePressByLamda_mock_callback)
+{
+    buttonModule1->onDoublePress([](void *parameter)
+                                 { ((MockMyClass *)parameter)->myCallback(parameter); },
+                                 mockMyClass);
+    buttonModule1->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+
+    buttonModule2->onDoublePress([](void *parameter)
+                                 { ((MockMyClass *)parameter)->myCallback(parameter); },
+                                 mockMyClass);
+    buttonModule2->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(150);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+}
+
+TEST_F(CallbackTest, OnLongPressByFunction)
+{
+    buttonModule1->onLongPress(myCallback,
+                               counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(1500);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onLongPress(myCallback,
+                               counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(1500);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnLongPressByLamda)
+{
+    buttonModule1->onLongPress([](void *parameter)
+                               { ((int *)parameter)[0]++; },
+                               counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(1500);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+    EXPECT_EQ(*counterCheck, 1);
+
+    buttonModule2->onLongPress([](void *parameter)
+                               { ((int *)parameter)[0]++; },
+                               counterCheck);
+    buttonModule2->startListening();
+    hal.setLevel(buttonPin2, onRaising2);
+    run(1500);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+    EXPECT_EQ(*counterCheck, 2);
+}
+
+TEST_F(CallbackTest, OnLongPressByLamda_mock_callback)
+{
+    buttonModule1->onLongPress([](void *parameter)
+                               { ((MockMyClass *)parameter)->myCallback(parameter); },
+                               mockMyClass);
+    buttonModule1->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(1500);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(150);
+
+    buttonModule2->onLongPress([](void *parameter)
+                               { ((MockMyClass *)parameter)->myCallback(parameter); },
+                               mockMyClass);
+    buttonModule2->startListening();
+    EXPECT_CALL(*mockMyClass, myCallback(mockMyClass))
+        .Times(1);
+    hal.setLevel(buttonPin2, onRaising2);
+    run(1500);
+    hal.setLevel(buttonPin2, !onRaising2);
+    run(150);
+}
+
+TEST_F(CallbackTest, GlitchIsSinglePressWithTimestampDebounce)
+{
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->startListening();
+    hal.setLevel(buttonPin1, onRaising1);
+    run(30);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 1);
+}
+
+TEST_F(CallbackTest, GlitchIsIgnoredWithVerticalCounterDebounce)
+{
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->startListening(3000, nullptr, 30, 90, 1000, 500,
+                                  ButtonModule::DebounceMode::VERTICAL_COUNTER);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(60);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 0);
+
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 1);
+}
+
+TEST_F(CallbackTest, VerticalCounterDebounceOfMoreThan255Samples)
+{
+    // 260 samples at 1 ms are clamped to the longest filter, not truncated to 4
+    checkInterval = 1;
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->startListening(3000, nullptr, 1, 90, 1000, 500,
+                                  ButtonModule::DebounceMode::VERTICAL_COUNTER);
+    ButtonConfig config = buttonModule1->getConfig();
+    config.timings.debounceTime = 260;
+    buttonModule1->reconfigure(config);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(10);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 0);
+
+    hal.setLevel(buttonPin1, onRaising1);
+    run(100);
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 1);
+}
+
+TEST_F(CallbackTest, ReleaseChatterWithVerticalCounterDebounce)
+{
+    int doublePresses = 0;
+    buttonModule1->onSinglePress(myCallback,
+                                 counterCheck);
+    buttonModule1->onDoublePress(myCallback,
+                                 &doublePresses);
+    buttonModule1->startListening(3000, nullptr, 30, 90, 1000, 500,
+                                  ButtonModule::DebounceMode::VERTICAL_COUNTER);
+    hal.setLevel(buttonPin1, onRaising1);
+    run(150);
+    for (int i = 0; i < 3; i++)
+    {
+        hal.setLevel(buttonPin1, !onRaising1);
+        run(30);
+        hal.setLevel(buttonPin1, onRaising1);
+        run(30);
+    }
+    hal.setLevel(buttonPin1, !onRaising1);
+    run(900);
+    EXPECT_EQ(*counterCheck, 1);
+    EXPECT_EQ(doublePresses, 0);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonDelegate.hpp"
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class PressCounter
+{
+public:
+    int presses = 0;
+
+    void countPress() { presses++; }
+};
+
+class DelegateTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    int presses = 0;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+
+    void press()
+    {
+        hal.setLevel(buttonPin, true);
+        button.poll();
+        hal.advance(100);
+        button.poll();
+        hal.setLevel(buttonPin, false);
+        button.poll();
+        hal.advance(1000);
+        button.poll();
+    }
+};
+
+TEST_F(DelegateTest, EmptyUntilSet)
+{
+    EXPECT_FALSE(ButtonCallback());
+    EXPECT_FALSE(ButtonCallback(nullptr));
+    EXPECT_FALSE(ButtonCallback(nullptr, &presses));
+    EXPECT_TRUE(ButtonCallback([] {}));
+}
+
+TEST_F(DelegateTest, CapturingLambda)
+{
+    int step = 2;
+    button.onSinglePress([this, step]
+                         { presses += step; });
+    button.startListening();
+    press();
+    press();
+    EXPECT_EQ(presses, 4);
+}
+
+TEST_F(DelegateTest, BoundMemberFunction)
+{
+    PressCounter counter;
+    button.onSinglePress(ButtonCallback::bind<PressCounter, &PressCounter::countPress>(&counter));
+    button.startListening();
+    press();
+    EXPECT_EQ(counter.presses, 1);
+}
+
+TEST_F(DelegateTest, FunctionWithParameter)
+{
+    ButtonDelegate<uint8_t> delegate([](uint8_t gesture, void *parameter)
+                                     { *static_cast<int *>(parameter) += gesture; },
+                                     &presses);
+    delegate(3);
+    EXPECT_EQ(presses, 3);
+}
+
+TEST_F(DelegateTest, StoredInline)
+{
+    // The context lives in the delegate, next to one function pointer, nothing is allocated
+    EXPECT_EQ(sizeof(ButtonCallback), BUTTON_DELEGATE_CAPACITY + sizeof(void *));
+
+    ButtonCallback copy;
+    {
+        int *counter = &presses;
+        ButtonCallback original([counter]
+                                { (*counter)++; });
+        copy = original;
+    }
+    copy();
+    EXPECT_EQ(presses, 1);
+}
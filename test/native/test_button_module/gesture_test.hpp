@@ -0,0 +1,79 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class GestureTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    int singlePresses = 0;
+    std::vector<uint8_t> gestures;
+
+    GestureDefinition definitions[2] = {
+        {GestureDefinition::Type::TAPS, 3},
+        {GestureDefinition::Type::REPEAT_WHILE_HELD, 0},
+    };
+    GestureTable table{definitions, 2};
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+
+    static void count(void *counter) { (*static_cast<int *>(counter))++; }
+    static void record(uint8_t gesture, void *gestures) { static_cast<std::vector<uint8_t> *>(gestures)->push_back(gesture); }
+
+    void SetUp() override
+    {
+        button.onSinglePress(count, &singlePresses);
+        button.onGesture(&table, record, &gestures);
+        button.startListening();
+    }
+
+    void pressFor(uint32_t ms)
+    {
+        hal.setLevel(buttonPin, true);
+        button.poll();
+        hal.advance(ms);
+        button.poll();
+        hal.setLevel(buttonPin, false);
+        button.poll();
+        hal.advance(100);
+        button.poll();
+    }
+};
+
+TEST_F(GestureTest, GesturesReplaceSinglePress)
+{
+    pressFor(100);
+    pressFor(100);
+    pressFor(100);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({0}));
+    EXPECT_EQ(singlePresses, 0);
+}
+
+TEST_F(GestureTest, PollDelayFollowsGestureDeadlines)
+{
+    button.setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    EXPECT_EQ(button.getPollDelay(), ButtonStateMachine::NO_DEADLINE);
+
+    hal.setLevel(buttonPin, true);
+    button.poll();
+    EXPECT_EQ(button.getPollDelay(), table.getTimings().repeatDelay);
+    hal.advance(table.getTimings().repeatDelay);
+    button.poll();
+    EXPECT_EQ(gestures, std::vector<uint8_t>({1}));
+    EXPECT_EQ(button.getPollDelay(), table.getTimings().repeatInterval);
+}
+
+TEST_F(GestureTest, ClearingTableRestoresPressEvents)
+{
+    button.onGesture(nullptr, nullptr);
+    pressFor(100);
+    hal.advance(1000);
+    button.poll();
+    EXPECT_TRUE(gestures.empty());
+    EXPECT_EQ(singlePresses, 1);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "ButtonStats.hpp"
+#include "ButtonTrace.hpp"
+#include "ButtonTraceRecorder.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class GuardTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+    int presses = 0;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+    ButtonGuard guard;
+    ButtonGuardCounters counters;
+    std::vector<ButtonGuardReport> reports;
+
+    static void count(void *counter) { (*static_cast<int *>(counter))++; }
+
+    void SetUp() override
+    {
+        button.onSinglePress(count, &presses);
+        button.onLongPress(count, &presses);
+        button.setGuard(&guard);
+        std::vector<ButtonGuardReport> *received = &reports;
+        guard.onReport([received](ButtonGuardReport const &report)
+                       { received->push_back(report); });
+    }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            button.poll();
+            hal.advance(checkInterval);
+        }
+    }
+
+    void press(uint32_t pressedMs, uint32_t releasedMs)
+    {
+        hal.setLevel(buttonPin, true);
+        run(pressedMs);
+        hal.setLevel(buttonPin, false);
+        run(releasedMs);
+    }
+};
+
+TEST_F(GuardTest, RefillsTheBucketOverTime)
+{
+    ButtonGuard limit(10, 1, 0, 100);
+    EXPECT_TRUE(limit.admitEvent(1000));
+    // 100 ms at 10 events per second refill one event
+    EXPECT_TRUE(limit.admitEvent(1100));
+    EXPECT_FALSE(limit.admitEvent(1150));
+    EXPECT_TRUE(limit.isQuarantined());
+    limit.getCounters(counters);
+    EXPECT_EQ(counters.admittedEvents, 2u);
+    EXPECT_EQ(counters.suppressedEvents, 1u);
+    EXPECT_EQ(counters.storms, 1u);
+}
+
+TEST_F(GuardTest, CoalescesAStormUntilRecovery)
+{
+    guard.setLimits(2, 2, 0, 1000);
+    button.startListening();
+    // About four presses a second from a chattering switch
+    for (int i = 0; i < 10; i++)
+        press(120, 120);
+    EXPECT_TRUE(guard.isQuarantined());
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].reason, ButtonGuardReport::Reason::STORM);
+    EXPECT_TRUE(reports[0].quarantined);
+
+    run(1200);
+    EXPECT_FALSE(guard.isQuarantined());
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_FALSE(reports[1].quarantined);
+    guard.getCounters(counters);
+    EXPECT_EQ(counters.admittedEvents, uint32_t(presses));
+    EXPECT_EQ(counters.admittedEvents + counters.suppressedEvents, 10u);
+    EXPECT_EQ(reports[1].suppressedEvents, counters.suppressedEvents);
+    EXPECT_EQ(counters.storms, 1u);
+    EXPECT_EQ(counters.quarantineTime, reports[1].duration);
+
+    // Events pass again once recovered
+    int before = presses;
+    press(120, 300);
+    EXPECT_EQ(presses, before + 1);
+}
+
+TEST_F(GuardTest, QuarantinesAStuckInput)
+{
+    guard.setLimits(5, 10, 3000, 500);
+    button.setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    button.startListening();
+    hal.setLevel(buttonPin, true);
+    // The task wakes for the long press, then for the stuck input
+    run(2000);
+    EXPECT_EQ(presses, 1);
+    EXPECT_LE(button.getPollDelay(), 1000u);
+    run(1200);
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].reason, ButtonGuardReport::Reason::STUCK);
+
+    // The stuck press is forgotten, the task waits for the release
+    EXPECT_EQ(button.getPollDelay(), ButtonStateMachine::NO_DEADLINE);
+    run(5000);
+    EXPECT_EQ(presses, 1);
+
+    hal.setLevel(buttonPin, false);
+    run(30);
+    EXPECT_LE(button.getPollDelay(), 500u);
+    run(600);
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_FALSE(reports[1].quarantined);
+    guard.getCounters(counters);
+    EXPECT_EQ(counters.stuckInputs, 1u);
+    EXPECT_EQ(counters.suppressedEvents, 0u);
+
+    press(120, 600);
+    EXPECT_EQ(presses, 2);
+}
+
+TEST_F(GuardTest, StatisticsSeeSuppressedEvents)
+{
+    ButtonStats stats;
+    ButtonStatsSnapshot snapshot;
+    ButtonDiagnostics diagnostics;
+    diagnostics.stats = &stats;
+    button.setDiagnostics(&diagnostics);
+    guard.setLimits(2, 2, 0, 1000);
+    button.startListening();
+    for (int i = 0; i < 10; i++)
+        press(120, 120);
+
+    // Only delivery is limited, the storm is visible in the statistics
+    EXPECT_LT(presses, 10);
+    EXPECT_TRUE(stats.getSnapshot(snapshot));
+    EXPECT_EQ(snapshot.singlePresses, 10u);
+}
+
+TEST_F(GuardTest, StatisticsAndTraceSeeSuppressedGestures)
+{
+    GestureDefinition definitions[1] = {{GestureDefinition::Type::REPEAT_WHILE_HELD, 0}};
+    GestureTable table{definitions, 1};
+    int delivered = 0;
+    button.onGesture(&table, [](uint8_t, void *counter)
+                     { (*static_cast<int *>(counter))++; }, &delivered);
+    ButtonStats stats;
+    ButtonStatsSnapshot snapshot;
+    StaticButtonTraceRecorder<1024> recorder(buttonPin);
+    ButtonDiagnostics diagnostics;
+    diagnostics.stats = &stats;
+    diagnostics.traceRecorder = &recorder;
+    button.setDiagnostics(&diagnostics);
+    guard.setLimits(2, 2, 0, 1000);
+    button.startListening();
+    press(3000, 1200);
+
+    // Every repeat is counted, only a few are delivered, the trace keeps the press itself
+    EXPECT_TRUE(stats.getSnapshot(snapshot));
+    EXPECT_GT(snapshot.gestures, 10u);
+    EXPECT_LT(uint32_t(delivered), snapshot.gestures);
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> *out = &bytes;
+    recorder.dump([out](uint8_t const *data, size_t size)
+                  { out->insert(out->end(), data, data + size); },
+                  false);
+    uint8_t const *data = bytes.data() + ButtonTrace::BLOCK_HEADER_SIZE;
+    uint32_t delta;
+    ButtonTrace::Tag tag;
+    int edges = 0;
+    while (ButtonTrace::decodeRecord(data, bytes.data() + bytes.size(), delta, tag))
+        edges += tag == ButtonTrace::EDGE;
+    EXPECT_EQ(edges, 2);
+}
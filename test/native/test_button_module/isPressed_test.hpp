@@ -0,0 +1,52 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class ButtonModuleTest : public ::testing::Test
+{
+protected:
+    int buttonPin1 = 5;
+    bool onRaising1 = true;
+    int buttonPin2 = 14;
+    bool onRaising2 = false;
+
+    SimulatedButtonHal hal;
+    ButtonModule *buttonModule1;
+    ButtonModule *buttonModule2;
+
+    void SetUp() override
+    {
+        buttonModule1 = new ButtonModule(buttonPin1, onRaising1, nullptr, &hal);
+        buttonModule2 = new ButtonModule(buttonPin2, onRaising2, nullptr, &hal);
+
+        hal.setLevel(buttonPin1, !onRaising1);
+        hal.setLevel(buttonPin2, !onRaising2);
+    }
+
+    void TearDown() override
+    {
+        delete buttonModule1;
+        delete buttonModule2;
+    }
+};
+
+TEST_F(ButtonModuleTest, isPressed)
+{
+    EXPECT_FALSE(buttonModule1->isPressed());
+    EXPECT_FALSE(buttonModule2->isPressed());
+
+    hal.setLevel(buttonPin1, onRaising1);
+    hal.setLevel(buttonPin2, onRaising2);
+
+    EXPECT_TRUE(buttonModule1->isPressed());
+    EXPECT_TRUE(buttonModule2->isPressed());
+
+    hal.setLevel(buttonPin1, !onRaising1);
+    hal.setLevel(buttonPin2, !onRaising2);
+
+    EXPECT_FALSE(buttonModule1->isPressed());
+    EXPECT_FALSE(buttonModule2->isPressed());
+}
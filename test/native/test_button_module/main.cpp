@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "isPressed_test.hpp"
+#include "callback_test.hpp"
+#include "pollDelay_test.hpp"
+#include "timestamp_test.hpp"
+#include "stats_test.hpp"
+#include "gesture_test.hpp"
+#include "delegate_test.hpp"
+#include "subscribers_test.hpp"
+#include "reconfigure_test.hpp"
+#include "sleep_test.hpp"
+#include "guard_test.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class PollDelayTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+    int singlePresses = 0;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+
+    static void count(void *counter) { (*static_cast<int *>(counter))++; }
+
+    void SetUp() override
+    {
+        button.onSinglePress(count, &singlePresses);
+        button.onDoublePress(count, &singlePresses);
+    }
+
+    // Polls like the listening task, sleeping getPollDelay() between polls
+    uint32_t pollFor(uint32_t ms)
+    {
+        uint32_t end = hal.now() + ms;
+        uint32_t polls = 0;
+        while (hal.now() < end)
+        {
+            button.poll();
+            polls++;
+            uint32_t delay = button.getPollDelay();
+            hal.advance(delay == ButtonStateMachine::NO_DEADLINE || delay > end - hal.now() ? end - hal.now() : delay);
+        }
+        return polls;
+    }
+};
+
+TEST_F(PollDelayTest, FixedRateByDefault)
+{
+    button.startListening();
+    EXPECT_EQ(pollFor(3000), 3000 / checkInterval);
+}
+
+TEST_F(PollDelayTest, IdleCheckIntervalWhileIdle)
+{
+    button.startListening();
+    button.setIdleCheckInterval(500);
+    EXPECT_EQ(pollFor(3000), 6u);
+
+    // Fast while the press is in progress, then slow again
+    hal.setLevel(buttonPin, true);
+    pollFor(500);
+    hal.setLevel(buttonPin, false);
+    pollFor(1000);
+    EXPECT_EQ(singlePresses, 1);
+    EXPECT_EQ(button.getPollDelay(), 500u);
+}
+
+TEST_F(PollDelayTest, DeadlineShortensCheckInterval)
+{
+    button.startListening();
+    hal.setLevel(buttonPin, true);
+    pollFor(150);
+    hal.setLevel(buttonPin, false);
+    uint32_t releaseTime = hal.now();
+    button.poll();
+    hal.advance(490);
+    EXPECT_EQ(button.getPollDelay(), 11u);
+
+    hal.advance(11);
+    button.poll();
+    EXPECT_EQ(singlePresses, 1);
+    EXPECT_EQ(hal.now() - releaseTime, 501u);
+}
+
+TEST_F(PollDelayTest, InterruptModeWaitsForDeadlineOrEdge)
+{
+    button.setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    button.startListening();
+    button.poll();
+    EXPECT_EQ(button.getPollDelay(), ButtonStateMachine::NO_DEADLINE);
+
+    hal.setLevel(buttonPin, true);
+    button.poll();
+    hal.advance(150);
+    hal.setLevel(buttonPin, false);
+    button.poll();
+    EXPECT_EQ(button.getPollDelay(), 501u);
+}
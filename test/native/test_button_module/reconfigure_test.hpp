@@ -0,0 +1,105 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class ReconfigureTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+    std::vector<int> calls;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+
+    void SetUp() override
+    {
+        button.startListening();
+    }
+
+    // Advances virtual time, polling every check interval like the listening task
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            button.poll();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(ReconfigureTest, TimingsChangeDuringPress)
+{
+    std::vector<int> *log = &calls;
+    button.onLongPress([log]
+                       { log->push_back(1); });
+    hal.setLevel(buttonPin, true);
+    run(150);
+
+    // The press in progress is kept and completes with the new long press time
+    button.setTimings(90, 300, 500);
+    run(150);
+    EXPECT_TRUE(calls.empty());
+    run(60);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+    EXPECT_EQ(button.getConfig().timings.longPressTime, 300);
+}
+
+TEST_F(ReconfigureTest, CallbackSwappedBetweenPresses)
+{
+    std::vector<int> *log = &calls;
+    button.onSinglePress([log]
+                         { log->push_back(1); });
+    button.onDoublePress([log]
+                         { log->push_back(2); });
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(150);
+
+    // Within the double press window, the second press reaches the new callback
+    button.onDoublePress([log]
+                         { log->push_back(3); });
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(150);
+    EXPECT_EQ(calls, std::vector<int>({3}));
+}
+
+TEST_F(ReconfigureTest, ReconfigureFromCallback)
+{
+    struct Context
+    {
+        ButtonModule *button;
+        std::vector<int> *log;
+    } context{&button, &calls};
+    Context *pContext = &context;
+
+    // The first single press switches the button to long press only
+    button.onSinglePress([pContext]
+                         {
+                             pContext->log->push_back(1);
+                             ButtonConfig config = pContext->button->getConfig();
+                             config.singlePressCallback = nullptr;
+                             std::vector<int> *log = pContext->log;
+                             config.longPressCallback = [log]
+                             { log->push_back(2); };
+                             pContext->button->reconfigure(config);
+                         });
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(600);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+
+    hal.setLevel(buttonPin, true);
+    run(1200);
+    hal.setLevel(buttonPin, false);
+    run(600);
+    EXPECT_EQ(calls, std::vector<int>({1, 2}));
+}
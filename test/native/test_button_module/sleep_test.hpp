@@ -0,0 +1,119 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class SleepTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+    std::vector<int> calls;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+
+    void SetUp() override
+    {
+        std::vector<int> *log = &calls;
+        button.onSinglePress([log]
+                             { log->push_back(1); });
+        button.onLongPress([log]
+                           { log->push_back(3); });
+        button.startListening();
+    }
+
+    // Advances virtual time, polling every check interval like the listening task
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            button.poll();
+            hal.advance(checkInterval);
+        }
+    }
+
+    void press(uint32_t ms)
+    {
+        hal.setLevel(buttonPin, true);
+        run(ms);
+        hal.setLevel(buttonPin, false);
+        run(600);
+    }
+};
+
+TEST_F(SleepTest, PausedButtonIsIgnored)
+{
+    button.pauseListening();
+    EXPECT_TRUE(button.isPaused());
+    press(150);
+    EXPECT_TRUE(calls.empty());
+
+    button.resumeListening();
+    EXPECT_FALSE(button.isPaused());
+    press(150);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+}
+
+TEST_F(SleepTest, ResumeForgetsPressBeforePause)
+{
+    // A press held across the pause does not become a long press on resume
+    hal.setLevel(buttonPin, true);
+    run(300);
+    button.pauseListening();
+    hal.setLevel(buttonPin, false);
+    hal.advance(5000);
+    button.resumeListening();
+    run(1200);
+    EXPECT_TRUE(calls.empty());
+    press(150);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+}
+
+TEST_F(SleepTest, WakePressReleasedBeforeFirstSample)
+{
+    EXPECT_TRUE(button.enableWakeup(true));
+    EXPECT_TRUE(hal.isWakeupEnabled(buttonPin));
+
+    // The tap that woke the chip was over before the first poll
+    hal.setWakeupSource(buttonPin);
+    EXPECT_TRUE(button.handleWakeup());
+    run(600);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+}
+
+TEST_F(SleepTest, WakePressStillHeld)
+{
+    hal.setWakeupSource(buttonPin);
+    hal.setLevel(buttonPin, true);
+    EXPECT_TRUE(button.handleWakeup());
+    run(1200);
+    EXPECT_EQ(calls, std::vector<int>({3}));
+}
+
+TEST_F(SleepTest, OtherWakeupCause)
+{
+    hal.setWakeupSource(-1);
+    EXPECT_FALSE(button.handleWakeup());
+    run(600);
+    EXPECT_TRUE(calls.empty());
+}
+
+TEST_F(SleepTest, WakeupDisabledWithButton)
+{
+    EXPECT_TRUE(button.enableWakeup(true));
+    {
+        ButtonModule other{6, true, nullptr, &hal};
+        EXPECT_TRUE(other.enableWakeup(true));
+        EXPECT_TRUE(hal.isWakeupEnabled(6));
+    }
+    // Only the destroyed button stops waking the chip
+    EXPECT_FALSE(hal.isWakeupEnabled(6));
+    EXPECT_TRUE(hal.isWakeupEnabled(buttonPin));
+
+    button.stopListening();
+    EXPECT_FALSE(hal.isWakeupEnabled(buttonPin));
+}
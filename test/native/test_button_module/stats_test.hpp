@@ -0,0 +1,82 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class StatsTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+    int presses = 0;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+    ButtonStats stats;
+    ButtonStatsSnapshot snapshot;
+    ButtonDiagnostics diagnostics;
+
+    static void count(void *counter) { (*static_cast<int *>(counter))++; }
+
+    void SetUp() override
+    {
+        button.onSinglePress(count, &presses);
+        button.onDoublePress(count, &presses);
+        button.onLongPress(count, &presses);
+        diagnostics.stats = &stats;
+        button.setDiagnostics(&diagnostics);
+    }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            button.poll();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(StatsTest, CountsPollsEdgesAndEvents)
+{
+    button.startListening();
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(900);
+    hal.setLevel(buttonPin, true);
+    run(1500);
+    hal.setLevel(buttonPin, false);
+    run(300);
+    stats.getSnapshot(snapshot);
+
+    EXPECT_EQ(presses, 2);
+    EXPECT_EQ(snapshot.polls, 95u);
+    EXPECT_EQ(snapshot.edges, 4u);
+    EXPECT_EQ(snapshot.singlePresses, 1u);
+    EXPECT_EQ(snapshot.longPresses, 1u);
+    EXPECT_EQ(snapshot.bouncesRejected, 0u);
+    // 150 ms and 1500 ms presses
+    EXPECT_EQ(snapshot.pressDurations[3], 1u);
+    EXPECT_EQ(snapshot.pressDurations[6], 1u);
+    EXPECT_EQ(snapshot.callbackDurations[0], 2u);
+}
+
+TEST_F(StatsTest, CountsGlitchesRejectedByVerticalCounter)
+{
+    button.startListening(3000, nullptr, 30, 90, 1000, 500, ButtonModule::DebounceMode::VERTICAL_COUNTER);
+    for (int i = 0; i < 3; i++)
+    {
+        hal.setLevel(buttonPin, true);
+        run(30);
+        hal.setLevel(buttonPin, false);
+        run(300);
+    }
+    stats.getSnapshot(snapshot);
+
+    EXPECT_EQ(presses, 0);
+    EXPECT_EQ(snapshot.edges, 6u);
+    EXPECT_EQ(snapshot.bouncesRejected, 3u);
+}
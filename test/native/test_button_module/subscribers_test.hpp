@@ -0,0 +1,134 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "ButtonSubscribers.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class SubscribersTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    std::vector<int> calls;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+    StaticButtonSubscribers<3> subscribers;
+
+    void SetUp() override
+    {
+        button.setSubscribers(&subscribers);
+        button.startListening();
+    }
+
+    void pressFor(uint32_t ms)
+    {
+        hal.setLevel(buttonPin, true);
+        button.poll();
+        hal.advance(ms);
+        button.poll();
+        hal.setLevel(buttonPin, false);
+        button.poll();
+        hal.advance(1000);
+        button.poll();
+    }
+};
+
+TEST_F(SubscribersTest, FanOutAfterCallback)
+{
+    std::vector<int> *log = &calls;
+    button.onSinglePress([log]
+                         { log->push_back(0); });
+    subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [log](ButtonStateMachine::Event)
+                          { log->push_back(1); });
+    subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                          [log](ButtonStateMachine::Event event)
+                          { log->push_back(event == ButtonStateMachine::Event::LONG_PRESS ? 3 : 2); });
+    pressFor(100);
+    pressFor(1500);
+    EXPECT_EQ(calls, std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST_F(SubscribersTest, SubscribedEventsAreDetected)
+{
+    // No callback, the long press is detected for its subscriber only
+    std::vector<int> *log = &calls;
+    subscribers.subscribe(ButtonStateMachine::LONG_PRESS_ENABLED, [log](ButtonStateMachine::Event)
+                          { log->push_back(1); });
+    EXPECT_EQ(subscribers.subscribedEvents(), ButtonStateMachine::LONG_PRESS_ENABLED);
+    pressFor(1500);
+    EXPECT_EQ(calls, std::vector<int>({1}));
+}
+
+TEST_F(SubscribersTest, ChangesDuringDispatch)
+{
+    struct Context
+    {
+        ButtonSubscribers *subscribers;
+        std::vector<int> *log;
+        int8_t self;
+    } context{&subscribers, &calls, -1};
+    Context *pContext = &context;
+
+    // The first subscriber replaces itself, its successor starts with the next event
+    context.self = subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [pContext](ButtonStateMachine::Event)
+                                         {
+                                             pContext->log->push_back(1);
+                                             pContext->subscribers->unsubscribe(pContext->self);
+                                             std::vector<int> *log = pContext->log;
+                                             pContext->subscribers->subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [log](ButtonStateMachine::Event)
+                                                                              { log->push_back(2); });
+                                         });
+    pressFor(100);
+    pressFor(100);
+    EXPECT_EQ(calls, std::vector<int>({1, 2}));
+    EXPECT_EQ(subscribers.getCount(), 1);
+}
+
+TEST_F(SubscribersTest, ReusedSlotWaitsForNextEvent)
+{
+    struct Context
+    {
+        ButtonSubscribers *subscribers;
+        std::vector<int> *log;
+        int8_t next;
+        bool replaced;
+    } context{&subscribers, &calls, -1, false};
+    Context *pContext = &context;
+
+    // The first subscriber replaces the second one once, the new one lands in the same slot
+    subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [pContext](ButtonStateMachine::Event)
+                          {
+                              pContext->log->push_back(1);
+                              if (pContext->replaced)
+                                  return;
+                              pContext->replaced = true;
+                              pContext->subscribers->unsubscribe(pContext->next);
+                              std::vector<int> *log = pContext->log;
+                              pContext->next = pContext->subscribers->subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [log](ButtonStateMachine::Event)
+                                                                                { log->push_back(3); });
+                          });
+    context.next = subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, [pContext](ButtonStateMachine::Event)
+                                         { pContext->log->push_back(2); });
+    pressFor(100);
+    EXPECT_EQ(context.next, 1);
+    pressFor(100);
+    EXPECT_EQ(calls, std::vector<int>({1, 1, 3}));
+}
+
+TEST_F(SubscribersTest, FixedCapacity)
+{
+    auto ignore = [](ButtonStateMachine::Event) {};
+    EXPECT_EQ(subscribers.subscribe(0, ignore), -1);
+    EXPECT_EQ(subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, ignore), 0);
+    EXPECT_EQ(subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, ignore), 1);
+    EXPECT_EQ(subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, ignore), 2);
+    EXPECT_EQ(subscribers.subscribe(ButtonStateMachine::SINGLE_PRESS_ENABLED, ignore), -1);
+
+    EXPECT_TRUE(subscribers.unsubscribe(1));
+    EXPECT_FALSE(subscribers.unsubscribe(1));
+    EXPECT_EQ(subscribers.subscribe(ButtonStateMachine::DOUBLE_PRESS_ENABLED, ignore), 1);
+    EXPECT_EQ(subscribers.getCount(), 3);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+class TimestampTest : public ::testing::Test
+{
+protected:
+    uint8_t buttonPin = 5;
+    uint32_t checkInterval = 30;
+
+    SimulatedButtonHal hal;
+    ButtonModule button{buttonPin, true, nullptr, &hal};
+    StaticButtonEventQueue<4> queue;
+    LatencyHistogram histogram;
+    ButtonDiagnostics diagnostics;
+
+    void SetUp() override
+    {
+        button.setEventQueue(&queue, 1, ButtonStateMachine::LONG_PRESS_ENABLED);
+        diagnostics.latencyHistogram = &histogram;
+        button.setDiagnostics(&diagnostics);
+    }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            button.poll();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(TimestampTest, PollingCapturesSampleTime)
+{
+    button.startListening();
+    run(90);
+    hal.advanceMicros(12345);
+    hal.setLevel(buttonPin, true);
+    hal.advanceMicros(30000 - 12345);
+    uint32_t sampleMicros = hal.micros();
+    run(1200);
+
+    ButtonEvent event;
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.type, ButtonStateMachine::Event::LONG_PRESS);
+    EXPECT_EQ(event.captureMicros, sampleMicros);
+    EXPECT_EQ(event.dispatchMicros, sampleMicros + 1020000);
+    EXPECT_EQ(histogram.getCount(), 1u);
+    EXPECT_GE(histogram.getPercentile(50), 1020000u);
+}
+
+TEST_F(TimestampTest, InterruptCapturesEdgeTime)
+{
+    button.setListeningMode(ButtonModule::ListeningMode::INTERRUPT);
+    button.startListening();
+    run(90);
+    hal.advanceMicros(12345);
+    uint32_t edgeMicros = hal.micros();
+    hal.setLevel(buttonPin, true);
+    hal.advanceMicros(30000 - 12345);
+    run(1200);
+
+    ButtonEvent event;
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.captureMicros, edgeMicros);
+    EXPECT_EQ(event.dispatchMicros - event.captureMicros, 30000u - 12345u + 1020000u);
+    EXPECT_EQ(button.getLastCaptureMicros(), event.captureMicros);
+    EXPECT_EQ(button.getLastDispatchMicros(), event.dispatchMicros);
+}
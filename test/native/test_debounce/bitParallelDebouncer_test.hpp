@@ -0,0 +1,76 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "BitParallelDebouncer.hpp"
+
+TEST(BitParallelDebouncerTest, ChangesAfterEqualSamples)
+{
+    BitParallelDebouncer<uint32_t, 3> debouncer;
+
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.update(0x1), 0x1u);
+    EXPECT_EQ(debouncer.state(), 0x1u);
+
+    EXPECT_EQ(debouncer.update(0x0), 0u);
+    EXPECT_EQ(debouncer.update(0x0), 0u);
+    EXPECT_EQ(debouncer.update(0x0), 0x1u);
+    EXPECT_EQ(debouncer.state(), 0x0u);
+}
+
+TEST(BitParallelDebouncerTest, IgnoresGlitches)
+{
+    BitParallelDebouncer<uint32_t, 3> debouncer;
+
+    for (int i = 0; i < 10; i++)
+    {
+        debouncer.update(0x5);
+        debouncer.update(0x0);
+    }
+    EXPECT_EQ(debouncer.state(), 0x0u);
+
+    debouncer.reset(0x5);
+    for (int i = 0; i < 10; i++)
+    {
+        debouncer.update(0x0);
+        debouncer.update(0x5);
+    }
+    EXPECT_EQ(debouncer.state(), 0x5u);
+}
+
+TEST(BitParallelDebouncerTest, LanesAreIndependent)
+{
+    BitParallelDebouncer<uint64_t, 2> debouncer;
+    uint64_t const high = uint64_t(1) << 63;
+
+    debouncer.update(high | 0x1);
+    debouncer.update(high);
+    EXPECT_EQ(debouncer.state(), high);
+    debouncer.update(0x1);
+    debouncer.update(0x1);
+    EXPECT_EQ(debouncer.state(), 0x1u);
+}
+
+TEST(BitParallelDebouncerTest, SingleSampleIsPassThrough)
+{
+    BitParallelDebouncer<uint32_t, 1> debouncer;
+
+    EXPECT_EQ(debouncer.update(0xF0), 0xF0u);
+    EXPECT_EQ(debouncer.update(0x0F), 0xFFu);
+    EXPECT_EQ(debouncer.state(), 0x0Fu);
+}
+
+TEST(BitParallelDebouncerTest, MoveAndResetLane)
+{
+    BitParallelDebouncer<uint32_t, 2> debouncer(0x8);
+
+    debouncer.moveLane(3, 0);
+    EXPECT_EQ(debouncer.state(), 0x1u);
+    debouncer.resetLane(5, true);
+    EXPECT_EQ(debouncer.state(), 0x21u);
+    debouncer.resetLane(0, false);
+    EXPECT_EQ(debouncer.state(), 0x20u);
+    // The history moved with the lane, so a single sample does not change it
+    EXPECT_EQ(debouncer.update(0x0), 0u);
+}
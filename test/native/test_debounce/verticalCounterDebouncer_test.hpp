@@ -0,0 +1,60 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "VerticalCounterDebouncer.hpp"
+
+TEST(VerticalCounterDebouncerTest, ChangesAfterConsecutiveSamples)
+{
+    VerticalCounterDebouncer<uint32_t> debouncer(3);
+
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.update(0x1), 0x1u);
+    EXPECT_EQ(debouncer.state(), 0x1u);
+
+    EXPECT_EQ(debouncer.update(0x0), 0u);
+    EXPECT_EQ(debouncer.update(0x0), 0u);
+    EXPECT_EQ(debouncer.update(0x0), 0x1u);
+    EXPECT_EQ(debouncer.state(), 0x0u);
+}
+
+TEST(VerticalCounterDebouncerTest, GlitchRestartsCount)
+{
+    VerticalCounterDebouncer<uint32_t> debouncer(3);
+
+    debouncer.update(0x1);
+    debouncer.update(0x1);
+    debouncer.update(0x0);
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.update(0x1), 0u);
+    EXPECT_EQ(debouncer.state(), 0x0u);
+    EXPECT_EQ(debouncer.update(0x1), 0x1u);
+}
+
+TEST(VerticalCounterDebouncerTest, LanesCountIndependently)
+{
+    VerticalCounterDebouncer<uint64_t, 4> debouncer(15);
+    uint64_t const high = uint64_t(1) << 63;
+
+    for (int i = 0; i < 14; i++)
+        EXPECT_EQ(debouncer.update(high | (i >= 7 ? 0x1 : 0x0)), 0u);
+    EXPECT_EQ(debouncer.update(high | 0x1), high);
+    for (int i = 0; i < 7; i++)
+        debouncer.update(high | 0x1);
+    EXPECT_EQ(debouncer.state(), high | 0x1);
+}
+
+TEST(VerticalCounterDebouncerTest, SamplesAreClamped)
+{
+    VerticalCounterDebouncer<uint8_t, 2> debouncer(0);
+
+    EXPECT_EQ(debouncer.update(0xFF), 0xFFu);
+
+    EXPECT_TRUE(debouncer.setSamples(3));
+    EXPECT_FALSE(debouncer.setSamples(200));
+    debouncer.reset(0);
+    EXPECT_EQ(debouncer.update(0x0F), 0u);
+    EXPECT_EQ(debouncer.update(0x0F), 0u);
+    EXPECT_EQ(debouncer.update(0x0F), 0x0Fu);
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "ButtonEventQueue.hpp"
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+using Event = ButtonStateMachine::Event;
+
+TEST(EventQueueTest, PopsInPushOrder)
+{
+    StaticButtonEventQueue<4> queue;
+    ButtonEvent event;
+
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT_FALSE(queue.pop(event));
+
+    EXPECT_TRUE(queue.push({10, 1, Event::SINGLE_PRESS, 0, 0}));
+    EXPECT_TRUE(queue.push({20, 2, Event::LONG_PRESS, 0, 0}));
+    EXPECT_EQ(queue.size(), 2u);
+
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.timestamp, 10u);
+    EXPECT_EQ(event.buttonId, 1);
+    EXPECT_EQ(event.type, Event::SINGLE_PRESS);
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.buttonId, 2);
+    EXPECT_FALSE(queue.pop(event));
+}
+
+TEST(EventQueueTest, DropsWhenFull)
+{
+    StaticButtonEventQueue<2> queue;
+    ButtonEvent event;
+
+    EXPECT_TRUE(queue.push({1, 0, Event::SINGLE_PRESS, 0, 0}));
+    EXPECT_TRUE(queue.push({2, 0, Event::SINGLE_PRESS, 0, 0}));
+    EXPECT_FALSE(queue.push({3, 0, Event::SINGLE_PRESS, 0, 0}));
+    EXPECT_EQ(queue.getDroppedCount(), 1u);
+
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.timestamp, 1u);
+    EXPECT_TRUE(queue.push({4, 0, Event::SINGLE_PRESS, 0, 0}));
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.timestamp, 2u);
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.timestamp, 4u);
+}
+
+TEST(EventQueueTest, ProducerAndConsumerThreads)
+{
+    static StaticButtonEventQueue<8> queue;
+    uint32_t const count = 200000;
+
+    std::thread producer([&]()
+                         {
+                             for (uint32_t i = 0; i < count; i++)
+                                 while (!queue.push({i, uint8_t(i), Event::DOUBLE_PRESS, 0, 0}))
+                                     std::this_thread::yield(); });
+
+    uint32_t expected = 0;
+    ButtonEvent event;
+    while (expected < count)
+    {
+        if (!queue.pop(event))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(event.timestamp, expected);
+        ASSERT_EQ(event.buttonId, uint8_t(expected));
+        expected++;
+    }
+    producer.join();
+}
+
+class EventQueueButtonTest : public ::testing::Test
+{
+protected:
+    int buttonPin = 5;
+    uint32_t checkInterval = 30;
+    int callbackCount = 0;
+
+    SimulatedButtonHal hal;
+    ButtonModule buttonModule{5, true, nullptr, &hal};
+    StaticButtonEventQueue<8> queue;
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            buttonModule.poll();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(EventQueueButtonTest, QueuesEventsInsteadOfCallbacks)
+{
+    buttonModule.onSinglePress([](void *parameter)
+                               { (*(int *)parameter)++; },
+                               &callbackCount);
+    buttonModule.setEventQueue(&queue, 7);
+
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(1000);
+    hal.setLevel(buttonPin, true);
+    run(1500);
+    hal.setLevel(buttonPin, false);
+    run(150);
+
+    ButtonEvent event;
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.buttonId, 7);
+    EXPECT_EQ(event.type, Event::SINGLE_PRESS);
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.type, Event::LONG_PRESS);
+    EXPECT_GE(event.timestamp, 1150u + 1000u);
+    EXPECT_FALSE(queue.pop(event));
+    EXPECT_EQ(callbackCount, 0);
+}
+
+TEST_F(EventQueueButtonTest, QueuesOnlySelectedEvents)
+{
+    buttonModule.setEventQueue(&queue, 1, ButtonStateMachine::SINGLE_PRESS_ENABLED);
+
+    hal.setLevel(buttonPin, true);
+    run(1500);
+    hal.setLevel(buttonPin, false);
+    run(150);
+
+    ButtonEvent event;
+    ASSERT_TRUE(queue.pop(event));
+    EXPECT_EQ(event.type, Event::SINGLE_PRESS);
+    EXPECT_FALSE(queue.pop(event));
+}
+
+TEST_F(EventQueueButtonTest, BackToCallbacks)
+{
+    buttonModule.onSinglePress([](void *parameter)
+                               { (*(int *)parameter)++; },
+                               &callbackCount);
+    buttonModule.setEventQueue(&queue, 1);
+    buttonModule.setEventQueue(nullptr);
+
+    hal.setLevel(buttonPin, true);
+    run(150);
+    hal.setLevel(buttonPin, false);
+    run(150);
+
+    EXPECT_EQ(callbackCount, 1);
+    EXPECT_EQ(queue.size(), 0u);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "ButtonLogRing.hpp"
+#include "ButtonModule.hpp"
+#include "SimulatedButtonHal.hpp"
+
+TEST(LogRingTest, FormatsRecordsLater)
+{
+    StaticButtonLogRing<2> ring;
+    char text[96];
+
+    EXPECT_FALSE(ring.popFormatted(text, sizeof(text)));
+    EXPECT_TRUE(ring.push({1200, ButtonLogRecord::Id::LONG_PRESS, 5, 1000250}));
+    EXPECT_TRUE(ring.push({1300, ButtonLogRecord::Id::EVENT_DROPPED, 6, 3}));
+    EXPECT_FALSE(ring.push({1400, ButtonLogRecord::Id::SINGLE_PRESS, 5, 0}));
+    EXPECT_EQ(ring.getDroppedCount(), 1u);
+
+    ASSERT_TRUE(ring.popFormatted(text, sizeof(text)));
+    EXPECT_EQ(std::string(text), "[1200] Button 5: long press detected, latency 1000250 us");
+    ASSERT_TRUE(ring.popFormatted(text, sizeof(text)));
+    EXPECT_EQ(std::string(text), "[1300] Button 6: event queue full, 3 events dropped");
+}
+
+TEST_F(EventQueueButtonTest, RecordsEventsInLogRing)
+{
+    StaticButtonLogRing<8> ring;
+    StaticButtonEventQueue<1> smallQueue;
+    ButtonDiagnostics diagnostics;
+    diagnostics.logRing = &ring;
+    buttonModule.setDiagnostics(&diagnostics);
+    buttonModule.setEventQueue(&smallQueue, 1, ButtonStateMachine::SINGLE_PRESS_ENABLED);
+
+    for (int i = 0; i < 2; i++)
+    {
+        hal.setLevel(buttonPin, true);
+        run(150);
+        hal.setLevel(buttonPin, false);
+        run(150);
+    }
+
+    ButtonLogRecord record;
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ(record.id, ButtonLogRecord::Id::SINGLE_PRESS);
+    EXPECT_EQ(record.pin, buttonPin);
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ(record.id, ButtonLogRecord::Id::SINGLE_PRESS);
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ(record.id, ButtonLogRecord::Id::EVENT_DROPPED);
+    EXPECT_EQ(record.arg, 1u);
+    EXPECT_FALSE(ring.pop(record));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "LatencyHistogram.hpp"
+
+TEST(LatencyHistogramTest, EmptyHistogram)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(histogram.getCount(), 0u);
+    EXPECT_EQ(histogram.getPercentile(50), 0u);
+    EXPECT_EQ(histogram.getMax(), 0u);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+
+    for (uint32_t value = 0; value < 8; value++)
+        histogram.record(value);
+    EXPECT_EQ(histogram.getCount(), 8u);
+    EXPECT_EQ(histogram.getPercentile(50), 3u);
+    EXPECT_EQ(histogram.getPercentile(100), 7u);
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketError)
+{
+    LatencyHistogram histogram;
+
+    // 1 ms to 100 ms uniformly
+    for (uint32_t value = 1; value <= 100; value++)
+        histogram.record(value * 1000);
+
+    uint32_t p50 = histogram.getPercentile(50);
+    uint32_t p99 = histogram.getPercentile(99);
+    EXPECT_GE(p50, 50000u);
+    EXPECT_LE(p50, 50000u * 5 / 4);
+    EXPECT_GE(p99, 99000u);
+    EXPECT_LE(p99, 100000u);
+    EXPECT_EQ(histogram.getMax(), 100000u);
+}
+
+TEST(LatencyHistogramTest, FullRange)
+{
+    LatencyHistogram histogram;
+
+    histogram.record(UINT32_MAX);
+    EXPECT_EQ(histogram.getPercentile(99), UINT32_MAX);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.getCount(), 0u);
+    histogram.record(1u << 20);
+    EXPECT_EQ(histogram.getPercentile(50), 1u << 20);
+}
@@ -0,0 +1,10 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "matrix_test.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include "ButtonMatrix.hpp"
+#include "SimulatedKeypadHal.hpp"
+
+using KeyEvent = std::pair<uint8_t, ButtonStateMachine::Event>;
+
+void recordKeyEvent(uint8_t key, ButtonStateMachine::Event event, void *events)
+{
+    static_cast<std::vector<KeyEvent> *>(events)->push_back(KeyEvent(key, event));
+}
+
+class MatrixTest : public ::testing::Test
+{
+protected:
+    uint32_t checkInterval = 30;
+    uint8_t rowPins[4] = {12, 13, 14, 15};
+    uint8_t columnPins[4] = {32, 33, 25, 26};
+    std::vector<KeyEvent> events;
+
+    SimulatedKeypadHal hal{rowPins, 4, columnPins, 4};
+    ButtonMatrix matrix{rowPins, 4, columnPins, 4, nullptr, &hal};
+
+    void SetUp() override { matrix.onKeyEvent(recordKeyEvent, &events); }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            matrix.scan();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(MatrixTest, SingleDoubleAndLongPressPerKey)
+{
+    hal.setKey(0, 1, true);
+    run(150);
+    hal.setKey(0, 1, false);
+    run(1000);
+
+    hal.setKey(2, 3, true);
+    run(150);
+    hal.setKey(2, 3, false);
+    run(150);
+    hal.setKey(2, 3, true);
+    run(150);
+    hal.setKey(2, 3, false);
+    run(1000);
+
+    hal.setKey(3, 0, true);
+    run(1500);
+    hal.setKey(3, 0, false);
+    run(150);
+
+    EXPECT_EQ(events, std::vector<KeyEvent>({
+                          KeyEvent(1, ButtonStateMachine::Event::SINGLE_PRESS),
+                          KeyEvent(11, ButtonStateMachine::Event::DOUBLE_PRESS),
+                          KeyEvent(12, ButtonStateMachine::Event::LONG_PRESS),
+                      }));
+}
+
+TEST_F(MatrixTest, SimultaneousKeys)
+{
+    hal.setKey(1, 1, true);
+    hal.setKey(1, 2, true);
+    hal.setKey(2, 3, true);
+    run(150);
+    EXPECT_TRUE(matrix.isKeyPressed(5));
+    EXPECT_TRUE(matrix.isKeyPressed(6));
+    EXPECT_TRUE(matrix.isKeyPressed(11));
+    hal.setKey(1, 1, false);
+    hal.setKey(1, 2, false);
+    hal.setKey(2, 3, false);
+    run(1000);
+    EXPECT_EQ(events.size(), 3u);
+}
+
+TEST_F(MatrixTest, AntiGhostingBlocksGhostKey)
+{
+    // Two keys of a row first, then a third corner of the rectangle
+    hal.setKey(0, 0, true);
+    hal.setKey(0, 2, true);
+    run(150);
+    hal.setKey(3, 0, true);
+    run(1500);
+    EXPECT_FALSE(matrix.isKeyPressed(12));
+    EXPECT_FALSE(matrix.isKeyPressed(14));
+
+    // The third key reads once the rectangle is gone
+    hal.setKey(0, 2, false);
+    run(150);
+    EXPECT_TRUE(matrix.isKeyPressed(12));
+}
+
+TEST_F(MatrixTest, GhostKeyWithoutAntiGhosting)
+{
+    matrix.setAntiGhosting(false);
+    hal.setKey(0, 0, true);
+    hal.setKey(0, 2, true);
+    hal.setKey(3, 0, true);
+    run(150);
+    EXPECT_TRUE(matrix.isKeyPressed(14));
+}
+
+TEST_F(MatrixTest, DiodesNeedNoAntiGhosting)
+{
+    SimulatedKeypadHal diodeHal(rowPins, 4, columnPins, 4, true);
+    ButtonMatrix diodeMatrix(rowPins, 4, columnPins, 4, nullptr, &diodeHal);
+    diodeMatrix.setAntiGhosting(false);
+    diodeHal.setKey(0, 0, true);
+    diodeHal.setKey(0, 2, true);
+    diodeHal.setKey(3, 0, true);
+    for (int i = 0; i < 5; i++)
+        diodeMatrix.scan();
+    EXPECT_TRUE(diodeMatrix.isKeyPressed(0));
+    EXPECT_TRUE(diodeMatrix.isKeyPressed(2));
+    EXPECT_TRUE(diodeMatrix.isKeyPressed(12));
+    EXPECT_FALSE(diodeMatrix.isKeyPressed(14));
+}
+
+TEST_F(MatrixTest, PackedKeyState)
+{
+    EXPECT_EQ(sizeof(PackedButtonStateMachine), 4u);
+    EXPECT_EQ(matrix.getKeyCount(), 16u);
+}
+
+// Records the settle waits, each with the row driven low at the time
+class SettleRecordingHal : public SimulatedKeypadHal
+{
+public:
+    std::vector<std::pair<uint8_t, uint32_t>> waits;
+    uint8_t lowRow = 0xFF;
+
+    using SimulatedKeypadHal::SimulatedKeypadHal;
+
+    void writePin(uint8_t pin, bool level) override
+    {
+        SimulatedKeypadHal::writePin(pin, level);
+        lowRow = level ? 0xFF : pin;
+    }
+
+    void delayMicroseconds(uint32_t microseconds) override { waits.push_back({lowRow, microseconds}); }
+};
+
+TEST_F(MatrixTest, WaitsForTheColumnsToSettleAfterEachRow)
+{
+    SettleRecordingHal settleHal(rowPins, 4, columnPins, 4);
+    ButtonMatrix settleMatrix(rowPins, 4, columnPins, 4, nullptr, &settleHal);
+    settleMatrix.scan();
+    ASSERT_EQ(settleHal.waits.size(), 4u);
+    for (uint8_t row = 0; row < 4; row++)
+        EXPECT_EQ(settleHal.waits[row], std::make_pair(rowPins[row], uint32_t(BUTTON_MATRIX_SETTLE_MICROS)));
+
+    settleHal.waits.clear();
+    settleMatrix.setSettleTime(0);
+    settleMatrix.scan();
+    EXPECT_TRUE(settleHal.waits.empty());
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonChordDetector.hpp"
+#include "scanner_test.hpp"
+
+class ChordTest : public ScannerTest
+{
+protected:
+    int chordCount = 0;
+    int sequenceCount = 0;
+    ButtonChordDetector *chordDetector;
+
+    void SetUp() override
+    {
+        ScannerTest::SetUp();
+        chordDetector = new ButtonChordDetector(nullptr, 80, 1000);
+        for (int i = 0; i < 3; i++)
+            chordDetector->addMember(buttonModules[i]);
+        buttonScanner->setChordDetector(chordDetector);
+    }
+
+    void TearDown() override
+    {
+        buttonScanner->setChordDetector(nullptr);
+        delete chordDetector;
+        ScannerTest::TearDown();
+    }
+
+    void tap(int button)
+    {
+        press(button, true);
+        run(150);
+        press(button, false);
+        run(150);
+    }
+};
+
+TEST_F(ChordTest, HeldChordReplacesMemberEvents)
+{
+    EXPECT_EQ(chordDetector->addChord(0b011, 3000, scannerCallback, &chordCount), 0);
+    press(0, true);
+    run(checkInterval);
+    press(1, true);
+    run(3000 + 2 * checkInterval);
+    EXPECT_EQ(chordCount, 1);
+    press(0, false);
+    press(1, false);
+    run(1000);
+    EXPECT_EQ(chordCount, 1);
+    EXPECT_EQ(singleCount + doubleCount + longCount, 0);
+}
+
+TEST_F(ChordTest, ChordReleasedEarlyReportsNothing)
+{
+    chordDetector->addChord(0b011, 3000, scannerCallback, &chordCount);
+    press(0, true);
+    press(1, true);
+    run(1500);
+    press(0, false);
+    press(1, false);
+    run(1000);
+    EXPECT_EQ(chordCount, 0);
+    EXPECT_EQ(singleCount + doubleCount + longCount, 0);
+
+    // The members are back to normal afterwards
+    tap(0);
+    run(1000);
+    EXPECT_EQ(singleCount, 1);
+}
+
+TEST_F(ChordTest, PressesOutsideWindowAreNotAChord)
+{
+    chordDetector->addChord(0b011, 0, scannerCallback, &chordCount);
+    press(0, true);
+    run(300);
+    press(1, true);
+    run(1500);
+    press(0, false);
+    press(1, false);
+    run(150);
+    EXPECT_EQ(chordCount, 0);
+    EXPECT_EQ(longCount, 2);
+}
+
+TEST_F(ChordTest, LargestChordWins)
+{
+    int largeChordCount = 0;
+    chordDetector->addChord(0b011, 0, scannerCallback, &chordCount);
+    chordDetector->addChord(0b111, 0, scannerCallback, &largeChordCount);
+    buttonScanner->setScanMode(ButtonScanner::ScanMode::BATCHED);
+    press(0, true);
+    press(1, true);
+    run(checkInterval);
+    press(2, true);
+    run(300);
+    press(0, false);
+    press(1, false);
+    press(2, false);
+    run(1000);
+    EXPECT_EQ(largeChordCount, 1);
+    EXPECT_EQ(chordCount, 0);
+    EXPECT_EQ(singleCount + doubleCount + longCount, 0);
+}
+
+TEST_F(ChordTest, SequenceDropsHeldEvents)
+{
+    uint8_t const steps[] = {0, 1, 0};
+    EXPECT_EQ(chordDetector->addSequence(steps, 3, scannerCallback, &sequenceCount), 0);
+    tap(0);
+    tap(1);
+    tap(0);
+    run(1500);
+    EXPECT_EQ(sequenceCount, 1);
+    EXPECT_EQ(singleCount + doubleCount + longCount, 0);
+}
+
+TEST_F(ChordTest, UnmatchedSequenceReleasesHeldEvents)
+{
+    uint8_t const steps[] = {0, 1};
+    chordDetector->addSequence(steps, 2, scannerCallback, &sequenceCount);
+    tap(0);
+    run(600);
+    // Held back while the sequence window is open
+    EXPECT_EQ(singleCount, 0);
+    run(600);
+    EXPECT_EQ(singleCount, 1);
+    EXPECT_EQ(sequenceCount, 0);
+}
+
+TEST_F(ChordTest, SequenceRestartsWithinRepeatedSteps)
+{
+    // The third press of 0 still leaves the last two as the start of the sequence
+    uint8_t const steps[] = {0, 0, 1};
+    chordDetector->addSequence(steps, 3, scannerCallback, &sequenceCount);
+    tap(0);
+    tap(0);
+    tap(0);
+    tap(1);
+    run(1500);
+    EXPECT_EQ(sequenceCount, 1);
+}
+
+TEST_F(ChordTest, RemovedMemberIndexIsReused)
+{
+    for (int cycle = 0; cycle < 2 * BUTTON_CHORD_MAX_MEMBERS; cycle++)
+    {
+        EXPECT_TRUE(chordDetector->removeMember(buttonModules[2]));
+        EXPECT_EQ(chordDetector->addMember(buttonModules[2]), 2);
+    }
+
+    // The chord of the first and the re-added button still matches
+    chordDetector->addChord(0b101, 0, scannerCallback, &chordCount);
+    press(0, true);
+    press(2, true);
+    run(300);
+    press(0, false);
+    press(2, false);
+    run(1000);
+    EXPECT_EQ(chordCount, 1);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "ButtonGroup.hpp"
+#include "SimulatedButtonHal.hpp"
+
+using GroupEvent = std::pair<uint16_t, ButtonStateMachine::Event>;
+
+class GroupTest : public ::testing::Test
+{
+protected:
+    uint32_t checkInterval = 30;
+    std::vector<GroupEvent> events;
+
+    SimulatedButtonHal hal;
+    StaticButtonGroup<100> group{nullptr, &hal};
+
+    void SetUp() override
+    {
+        std::vector<GroupEvent> *recorded = &events;
+        group.onEvent([recorded](uint16_t button, ButtonStateMachine::Event event)
+                      { recorded->push_back(GroupEvent(button, event)); });
+    }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            group.scan();
+            hal.advance(checkInterval);
+        }
+    }
+};
+
+TEST_F(GroupTest, SameEventsAsButtonStateMachinePerButton)
+{
+    ButtonStateMachine reference[100];
+    ButtonTimings timings;
+    std::mt19937 random(21);
+    std::uniform_int_distribution<uint32_t> length(1, 1500);
+    uint32_t segmentEnd[100] = {};
+    uint32_t pressed[4] = {};
+    std::vector<GroupEvent> expected;
+
+    // Start close to the 16 bit and 32 bit wraps
+    uint32_t now = 0xFFFFFFFF - 100000;
+    for (uint16_t button = 0; button < 100; button++)
+        segmentEnd[button] = now + length(random);
+
+    for (int sample = 0; sample < 20000; sample++, now += 10)
+    {
+        for (uint16_t button = 0; button < 100; button++)
+        {
+            if (int32_t(segmentEnd[button] - now) <= 0)
+            {
+                pressed[button / 32] ^= uint32_t(1) << (button % 32);
+                segmentEnd[button] = now + length(random);
+            }
+            ButtonStateMachine::Event event = reference[button].update(now, (pressed[button / 32] >> (button % 32)) & 1, timings, 0x07);
+            if (event != ButtonStateMachine::Event::NONE)
+                expected.push_back(GroupEvent(button, event));
+        }
+        group.update(now, pressed);
+        ASSERT_EQ(events.size(), expected.size()) << "at " << now;
+    }
+    EXPECT_EQ(events, expected);
+    EXPECT_GT(events.size(), 1000u);
+}
+
+TEST_F(GroupTest, ScansActiveHighAndActiveLowPins)
+{
+    hal.setLevel(5, true);
+    group.setPin(3, 4);
+    group.setPin(70, 5, false);
+    run(60);
+
+    hal.setLevel(4, true);
+    hal.setLevel(5, false);
+    run(150);
+    EXPECT_TRUE(group.isActive(3));
+    EXPECT_TRUE(group.isActive(70));
+    hal.setLevel(4, false);
+    run(1000);
+    hal.setLevel(5, true);
+    run(1000);
+
+    EXPECT_EQ(events, std::vector<GroupEvent>({
+                          GroupEvent(3, ButtonStateMachine::Event::SINGLE_PRESS),
+                          GroupEvent(70, ButtonStateMachine::Event::LONG_PRESS),
+                      }));
+    EXPECT_FALSE(group.isActive(3));
+    EXPECT_FALSE(group.isActive(70));
+}
+
+TEST_F(GroupTest, IgnoresBitsPastTheLastButton)
+{
+    uint32_t pressed[4] = {0, 0, 0, 0xFFFFFFF0};
+    group.update(0, pressed);
+    group.update(2000, pressed);
+    EXPECT_TRUE(events.empty());
+    for (uint16_t button = 96; button < 100; button++)
+        EXPECT_FALSE(group.isActive(button));
+}
+
+TEST_F(GroupTest, NoEventsWithoutCallback)
+{
+    group.onEvent(nullptr);
+    group.setPin(0, 4);
+    hal.setLevel(4, true);
+    run(1500);
+    hal.setLevel(4, false);
+    run(1000);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST(GroupSizeTest, FiveBytesPerButton)
+{
+    EXPECT_EQ(sizeof(StaticButtonGroup<1024>) - sizeof(ButtonGroup), 1024u * 5 + 1024 / 8);
+}
@@ -0,0 +1,12 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "scanner_test.hpp"
+#include "chord_test.hpp"
+#include "group_test.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
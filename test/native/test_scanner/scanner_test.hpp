@@ -0,0 +1,166 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "ButtonChordDetector.hpp"
+#include "ButtonModule.hpp"
+#include "ButtonScanner.hpp"
+#include "SimulatedButtonHal.hpp"
+
+void scannerCallback(void *parameter)
+{
+    (*(int *)parameter)++;
+}
+
+class ScannerTest : public ::testing::Test
+{
+protected:
+    uint32_t checkInterval = 30;
+    int singleCount = 0;
+    int doubleCount = 0;
+    int longCount = 0;
+
+    SimulatedButtonHal hal;
+    ButtonScanner *buttonScanner;
+    ButtonModule *buttonModules[3];
+    uint8_t pins[3] = {5, 14, 33};
+    bool onRaising[3] = {true, false, true};
+
+    void SetUp() override
+    {
+        buttonScanner = new ButtonScanner(nullptr, &hal);
+        for (int i = 0; i < 3; i++)
+        {
+            buttonModules[i] = new ButtonModule(pins[i], onRaising[i], nullptr, &hal);
+            buttonModules[i]->onSinglePress(scannerCallback, &singleCount);
+            buttonModules[i]->onDoublePress(scannerCallback, &doubleCount);
+            buttonModules[i]->onLongPress(scannerCallback, &longCount);
+            hal.setLevel(pins[i], !onRaising[i]);
+            buttonScanner->addButton(buttonModules[i]);
+        }
+    }
+
+    void TearDown() override
+    {
+        delete buttonScanner;
+        for (int i = 0; i < 3; i++)
+            delete buttonModules[i];
+    }
+
+    void press(int button, bool pressed)
+    {
+        hal.setLevel(pins[button], pressed == onRaising[button]);
+    }
+
+    void run(uint32_t ms)
+    {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += checkInterval)
+        {
+            buttonScanner->scan();
+            hal.advance(checkInterval);
+        }
+    }
+
+    void singleDoubleAndLongPress()
+    {
+        press(0, true);
+        run(150);
+        press(0, false);
+        run(1000);
+
+        press(1, true);
+        run(150);
+        press(1, false);
+        run(150);
+        press(1, true);
+        run(150);
+        press(1, false);
+        run(1000);
+
+        press(2, true);
+        run(1500);
+        press(2, false);
+        run(150);
+    }
+};
+
+TEST_F(ScannerTest, PerButtonScan)
+{
+    singleDoubleAndLongPress();
+    EXPECT_EQ(singleCount, 1);
+    EXPECT_EQ(doubleCount, 1);
+    EXPECT_EQ(longCount, 1);
+}
+
+TEST_F(ScannerTest, BatchedScan)
+{
+    buttonScanner->setScanMode(ButtonScanner::ScanMode::BATCHED);
+    singleDoubleAndLongPress();
+    EXPECT_EQ(singleCount, 1);
+    EXPECT_EQ(doubleCount, 1);
+    EXPECT_EQ(longCount, 1);
+}
+
+TEST_F(ScannerTest, BatchedScanFiltersSingleSampleGlitches)
+{
+    buttonScanner->setScanMode(ButtonScanner::ScanMode::BATCHED);
+    for (int i = 0; i < 10; i++)
+    {
+        press(0, true);
+        run(checkInterval);
+        press(0, false);
+        run(checkInterval);
+    }
+    run(1000);
+    EXPECT_EQ(singleCount, 0);
+}
+
+TEST_F(ScannerTest, BatchedScanAfterRemovingButton)
+{
+    buttonScanner->setScanMode(ButtonScanner::ScanMode::BATCHED);
+    // The last button takes the slot of the removed one and keeps its press in progress
+    press(2, true);
+    run(150);
+    EXPECT_TRUE(buttonScanner->removeButton(buttonModules[0]));
+    run(1500);
+    press(2, false);
+    run(150);
+    EXPECT_EQ(longCount, 1);
+
+    press(0, true);
+    run(150);
+    press(0, false);
+    run(1000);
+    EXPECT_EQ(singleCount, 0);
+}
+
+TEST_F(ScannerTest, BatchedScanWithChord)
+{
+    int chordCount = 0;
+    ButtonChordDetector chords(nullptr, 80, 1000);
+    chords.addMember(buttonModules[0]);
+    chords.addMember(buttonModules[1]);
+    chords.addChord(0b011, 0, scannerCallback, &chordCount);
+    buttonScanner->setScanMode(ButtonScanner::ScanMode::BATCHED);
+    buttonScanner->setChordDetector(&chords);
+
+    press(0, true);
+    press(1, true);
+    run(300);
+    press(0, false);
+    press(1, false);
+    run(1000);
+    EXPECT_EQ(chordCount, 1);
+    EXPECT_EQ(singleCount + doubleCount + longCount, 0);
+
+    // The members see their release and report their next presses
+    for (int i = 0; i < 3; i++)
+    {
+        press(0, true);
+        run(150);
+        press(0, false);
+        run(1000);
+    }
+    EXPECT_EQ(singleCount, 3);
+    buttonScanner->setChordDetector(nullptr);
+}
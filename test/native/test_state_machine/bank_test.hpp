@@ -0,0 +1,107 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "ButtonBank.hpp"
+#include "ButtonStateMachine.hpp"
+
+using BankEvent = std::pair<uint16_t, ButtonStateMachine::Event>;
+
+#define BANK_TEST_BUTTONS 75
+
+// Every button toggles after random lengths, sampled every check interval
+class BankTest : public ::testing::TestWithParam<uint8_t>
+{
+protected:
+    StaticButtonBank<BANK_TEST_BUTTONS> bank;
+    ButtonStateMachine reference[BANK_TEST_BUTTONS];
+    ButtonTimings timings;
+    std::vector<BankEvent> events;
+
+    void SetUp() override
+    {
+        std::vector<BankEvent> *recorded = &events;
+        bank.onEvent([recorded](uint16_t button, ButtonStateMachine::Event event)
+                     { recorded->push_back(BankEvent(button, event)); });
+    }
+};
+
+TEST_P(BankTest, SameEventsAsButtonStateMachine)
+{
+    uint8_t enabledEvents = GetParam();
+    bank.setEnabledEvents(enabledEvents);
+    std::mt19937 random(enabledEvents);
+    // Short lengths produce bounces, long ones long presses and expired double press windows
+    std::uniform_int_distribution<uint32_t> length(1, 1500);
+    uint32_t segmentEnd[BANK_TEST_BUTTONS];
+    uint32_t pressed[(BANK_TEST_BUTTONS + 31) / 32] = {};
+    std::vector<BankEvent> expected;
+
+    // Start close to the 32 bit wrap
+    uint32_t now = 0xFFFFFFFF - 100000;
+    for (uint16_t button = 0; button < BANK_TEST_BUTTONS; button++)
+        segmentEnd[button] = now + length(random);
+
+    for (int sample = 0; sample < 20000; sample++, now += 10)
+    {
+        for (uint16_t button = 0; button < BANK_TEST_BUTTONS; button++)
+        {
+            if (int32_t(segmentEnd[button] - now) <= 0)
+            {
+                pressed[button / 32] ^= uint32_t(1) << (button % 32);
+                segmentEnd[button] = now + length(random);
+            }
+            ButtonStateMachine::Event event = reference[button].update(now, (pressed[button / 32] >> (button % 32)) & 1, timings, enabledEvents);
+            if (event != ButtonStateMachine::Event::NONE)
+                expected.push_back(BankEvent(button, event));
+        }
+        bank.update(now, pressed);
+        ASSERT_EQ(events.size(), expected.size()) << "at " << now;
+        for (uint16_t button = 0; button < BANK_TEST_BUTTONS; button++)
+            ASSERT_EQ(bank.isIdle(button), reference[button].isIdle()) << "button " << button << " at " << now;
+    }
+    EXPECT_EQ(events, expected);
+    EXPECT_GT(events.size(), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    EnabledEvents, BankTest,
+    ::testing::Values(ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::DOUBLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::SINGLE_PRESS_ENABLED,
+                      ButtonStateMachine::LONG_PRESS_ENABLED));
+
+TEST(BankCountTest, PressCountWrapsLikeButtonStateMachine)
+{
+    // With single and double press disabled the count of short presses wraps after 255
+    StaticButtonBank<1> bank;
+    ButtonStateMachine reference;
+    ButtonTimings timings;
+    bank.setEnabledEvents(ButtonStateMachine::LONG_PRESS_ENABLED);
+    uint32_t events = 0;
+    uint32_t expected = 0;
+    bank.onEvent([&events](uint16_t, ButtonStateMachine::Event)
+                 { events++; });
+
+    uint32_t now = 1;
+    for (int press = 0; press < 300; press++)
+    {
+        // 200 ms presses, then 2 s holds once the count wrapped
+        uint32_t const levels[2] = {1, 0};
+        uint32_t const durations[2] = {press >= 256 ? 2000u : 200u, 200};
+        for (int phase = 0; phase < 2; phase++)
+        {
+            for (uint32_t end = now + durations[phase]; now < end; now += 10)
+            {
+                bank.update(now, &levels[phase]);
+                expected += reference.update(now, levels[phase], timings, ButtonStateMachine::LONG_PRESS_ENABLED) != ButtonStateMachine::Event::NONE;
+            }
+        }
+    }
+    EXPECT_EQ(events, expected);
+    EXPECT_GT(events, 0u);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "GestureEngine.hpp"
+
+class GestureEngineTest : public ::testing::Test
+{
+protected:
+    enum : uint8_t
+    {
+        TAP,
+        DOUBLE_TAP,
+        TRIPLE_TAP,
+        HOLD,
+        TAP_THEN_HOLD,
+        REPEAT,
+    };
+
+    GestureDefinition definitions[6] = {
+        {GestureDefinition::Type::TAPS, 1},
+        {GestureDefinition::Type::TAPS, 2},
+        {GestureDefinition::Type::TAPS, 3},
+        {GestureDefinition::Type::TAPS_THEN_HOLD, 0},
+        {GestureDefinition::Type::TAPS_THEN_HOLD, 1},
+        {GestureDefinition::Type::REPEAT_WHILE_HELD, 2},
+    };
+    GestureTable table{definitions, 6};
+    GestureEngine engine;
+    uint32_t now = 1000;
+    uint32_t checkInterval = 10;
+    std::vector<uint8_t> gestures;
+
+    // Samples the given level every check interval for the given duration
+    void hold(bool pressed, uint32_t duration)
+    {
+        for (uint32_t elapsed = 0; elapsed < duration; elapsed += checkInterval)
+        {
+            uint8_t gesture = engine.update(now, pressed, table);
+            if (gesture != GestureTable::NO_GESTURE)
+                gestures.push_back(gesture);
+            now += checkInterval;
+        }
+    }
+
+    void tap()
+    {
+        hold(true, 100);
+        hold(false, 100);
+    }
+};
+
+TEST_F(GestureEngineTest, SingleTapAfterTapWindow)
+{
+    tap();
+    EXPECT_TRUE(gestures.empty());
+    hold(false, 400);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({TAP}));
+    EXPECT_TRUE(engine.isIdle());
+}
+
+TEST_F(GestureEngineTest, TripleTapWithoutWaiting)
+{
+    // No gesture counts more than three taps, so the third completes at once
+    tap();
+    tap();
+    hold(true, 100);
+    hold(false, checkInterval);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({TRIPLE_TAP}));
+    EXPECT_TRUE(engine.isIdle());
+}
+
+TEST_F(GestureEngineTest, HoldAndTapThenHold)
+{
+    hold(true, 1000);
+    hold(false, 100);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({HOLD}));
+
+    gestures.clear();
+    tap();
+    hold(true, 1000);
+    hold(false, 500);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({TAP_THEN_HOLD}));
+}
+
+TEST_F(GestureEngineTest, RepeatWhileHeld)
+{
+    tap();
+    tap();
+    hold(true, table.getTimings().repeatDelay + 10 * table.getTimings().repeatInterval + checkInterval);
+    hold(false, 500);
+    EXPECT_EQ(gestures, std::vector<uint8_t>(11, REPEAT));
+}
+
+TEST_F(GestureEngineTest, ShortPressesAreIgnored)
+{
+    hold(true, 20);
+    hold(false, 500);
+    EXPECT_TRUE(gestures.empty());
+    EXPECT_TRUE(engine.isIdle());
+
+    // A glitch between taps does not count as a tap
+    tap();
+    hold(true, 20);
+    hold(false, 500);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({TAP}));
+}
+
+TEST_F(GestureEngineTest, GlitchDoesNotExtendTapWindow)
+{
+    // The tap window still closes 400 ms after the release of the tap
+    tap();
+    hold(false, 200);
+    hold(true, 20);
+    hold(false, 120);
+    EXPECT_EQ(gestures, std::vector<uint8_t>({TAP}));
+    EXPECT_TRUE(engine.isIdle());
+}
+
+TEST_F(GestureEngineTest, TimeToDeadline)
+{
+    EXPECT_EQ(engine.timeToDeadline(now, table), GestureEngine::NO_DEADLINE);
+
+    engine.update(now, true, table);
+    EXPECT_EQ(engine.timeToDeadline(now + 300, table), table.getTimings().holdTime - 300u);
+    engine.update(now + 100, false, table);
+    EXPECT_EQ(engine.timeToDeadline(now + 100, table), table.getTimings().tapWindow + 1u);
+    EXPECT_EQ(engine.timeToDeadline(now + 1000, table), 0u);
+    EXPECT_EQ(engine.update(now + 100 + table.getTimings().tapWindow + 1, false, table), TAP);
+    EXPECT_EQ(engine.timeToDeadline(now + 1000, table), GestureEngine::NO_DEADLINE);
+}
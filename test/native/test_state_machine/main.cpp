@@ -0,0 +1,14 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "bank_test.hpp"
+#include "gestureEngine_test.hpp"
+#include "packedStateMachine_test.hpp"
+#include "stateMachine_test.hpp"
+#include "staticButton_test.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
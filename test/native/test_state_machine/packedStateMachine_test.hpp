@@ -0,0 +1,83 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "ButtonStateMachine.hpp"
+#include "PackedButtonStateMachine.hpp"
+
+// Random presses and releases of random lengths, sampled every check interval
+class PackedStateMachineTest : public ::testing::TestWithParam<uint8_t>
+{
+protected:
+    ButtonStateMachine reference;
+    PackedButtonStateMachine packed;
+    ButtonTimings timings;
+};
+
+TEST_P(PackedStateMachineTest, SameEventsAndDeadlinesAsButtonStateMachine)
+{
+    uint8_t enabledEvents = GetParam();
+    std::mt19937 random(enabledEvents);
+    std::uniform_int_distribution<uint32_t> length(1, 1500);
+    // Start close to the 16 bit and 32 bit wraps
+    uint32_t now = 0xFFFFFFFF - 200000;
+    bool pressed = false;
+    uint32_t events = 0;
+
+    for (int segment = 0; segment < 4000; segment++)
+    {
+        pressed = !pressed;
+        uint32_t end = now + length(random);
+        for (; int32_t(end - now) > 0; now += 10)
+        {
+            ButtonStateMachine::Event expected = reference.update(now, pressed, timings, enabledEvents);
+            ASSERT_EQ(packed.update(now, pressed, timings, enabledEvents), expected) << "at " << now;
+            ASSERT_EQ(packed.isIdle(), reference.isIdle());
+            ASSERT_EQ(packed.timeToDeadline(now + 5, timings, enabledEvents), reference.timeToDeadline(now + 5, timings, enabledEvents));
+            events += expected != ButtonStateMachine::Event::NONE;
+        }
+    }
+    EXPECT_GT(events, 0u);
+}
+
+TEST_P(PackedStateMachineTest, PressesLongerThanTheTimestampRange)
+{
+    uint8_t enabledEvents = GetParam();
+    // Held alone and as the second press of a double press, around and past the 16 bit wrap
+    uint32_t const holds[] = {65440, 65450, 65500, 65530, 65540, 70000, 200000};
+    uint32_t now = 0;
+    uint32_t events = 0;
+
+    for (uint32_t hold : holds)
+        for (bool afterTap : {false, true})
+        {
+            uint32_t const segments[] = {afterTap ? 100u : 0u, afterTap ? 100u : 0u, hold, 1000};
+            bool pressed = false;
+            for (uint32_t length : segments)
+            {
+                pressed = !pressed;
+                for (uint32_t end = now + length; int32_t(end - now) > 0; now += 10)
+                {
+                    ButtonStateMachine::Event expected = reference.update(now, pressed, timings, enabledEvents);
+                    ASSERT_EQ(packed.update(now, pressed, timings, enabledEvents), expected) << "hold " << hold << " at " << now;
+                    events += expected != ButtonStateMachine::Event::NONE;
+                }
+            }
+        }
+    EXPECT_GT(events, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    EnabledEvents, PackedStateMachineTest,
+    ::testing::Values(ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::DOUBLE_PRESS_ENABLED | ButtonStateMachine::LONG_PRESS_ENABLED,
+                      ButtonStateMachine::SINGLE_PRESS_ENABLED | ButtonStateMachine::DOUBLE_PRESS_ENABLED,
+                      ButtonStateMachine::SINGLE_PRESS_ENABLED));
+
+TEST(PackedStateMachineSizeTest, FourBytes)
+{
+    EXPECT_EQ(sizeof(PackedButtonStateMachine), 4u);
+    EXPECT_LT(sizeof(PackedButtonStateMachine), sizeof(ButtonStateMachine));
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ButtonStateMachine.hpp"
+
+using Event = ButtonStateMachine::Event;
+
+class StateMachineTest : public ::testing::Test
+{
+protected:
+    ButtonStateMachine stateMachine;
+    ButtonTimings timings;
+    uint8_t enabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED |
+                            ButtonStateMachine::DOUBLE_PRESS_ENABLED |
+                            ButtonStateMachine::LONG_PRESS_ENABLED;
+    uint32_t now = 1000;
+    uint32_t checkInterval = 30;
+    std::vector<Event> events;
+
+    // Samples the given level every check interval for the given duration
+    void hold(bool pressed, uint32_t duration)
+    {
+        for (uint32_t elapsed = 0; elapsed < duration; elapsed += checkInterval)
+        {
+            Event event = stateMachine.update(now, pressed, timings, enabledEvents);
+            if (event != Event::NONE)
+                events.push_back(event);
+            now += checkInterval;
+        }
+    }
+};
+
+TEST_F(StateMachineTest, IdleWithoutPress)
+{
+    hold(false, 5000);
+    EXPECT_TRUE(events.empty());
+    EXPECT_TRUE(stateMachine.isIdle());
+}
+
+TEST_F(StateMachineTest, SinglePress)
+{
+    hold(true, 150);
+    EXPECT_FALSE(stateMachine.isIdle());
+    hold(false, 1000);
+    EXPECT_EQ(events, std::vector<Event>({Event::SINGLE_PRESS}));
+    EXPECT_TRUE(stateMachine.isIdle());
+}
+
+TEST_F(StateMachineTest, SinglePressWaitsForDoublePressWindow)
+{
+    hold(true, 150);
+    hold(false, timings.timeBetweenDoublePress - checkInterval);
+    EXPECT_TRUE(events.empty());
+    hold(false, 2 * checkInterval);
+    EXPECT_EQ(events, std::vector<Event>({Event::SINGLE_PRESS}));
+}
+
+TEST_F(StateMachineTest, SinglePressOnReleaseWithoutDoublePress)
+{
+    enabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED;
+    hold(true, 150);
+    hold(false, checkInterval);
+    EXPECT_EQ(events, std::vector<Event>({Event::SINGLE_PRESS}));
+}
+
+TEST_F(StateMachineTest, DoublePress)
+{
+    hold(true, 150);
+    hold(false, 150);
+    hold(true, 150);
+    hold(false, 1000);
+    EXPECT_EQ(events, std::vector<Event>({Event::DOUBLE_PRESS}));
+}
+
+TEST_F(StateMachineTest, LongPress)
+{
+    hold(true, 1500);
+    EXPECT_EQ(events, std::vector<Event>({Event::LONG_PRESS}));
+    hold(false, 1000);
+    EXPECT_EQ(events, std::vector<Event>({Event::LONG_PRESS}));
+}
+
+TEST_F(StateMachineTest, LongPressDisabled)
+{
+    enabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED;
+    hold(true, 1500);
+    EXPECT_TRUE(events.empty());
+    hold(false, checkInterval);
+    EXPECT_EQ(events, std::vector<Event>({Event::SINGLE_PRESS}));
+}
+
+TEST_F(StateMachineTest, NoEventsWhenNothingEnabled)
+{
+    enabledEvents = 0;
+    hold(true, 1500);
+    hold(false, 1000);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST_F(StateMachineTest, ReleaseInSameMillisecondIsDebounced)
+{
+    enabledEvents = ButtonStateMachine::SINGLE_PRESS_ENABLED;
+    EXPECT_EQ(stateMachine.update(now, true, timings, enabledEvents), Event::NONE);
+    EXPECT_EQ(stateMachine.update(now, false, timings, enabledEvents), Event::NONE);
+    EXPECT_TRUE(stateMachine.isIdle());
+}
+
+TEST_F(StateMachineTest, LongPressAcrossMillisWraparound)
+{
+    now = UINT32_MAX - 500;
+    hold(true, 1500);
+    EXPECT_EQ(events, std::vector<Event>({Event::LONG_PRESS}));
+}
+
+TEST_F(StateMachineTest, ResetForgetsPressInProgress)
+{
+    hold(true, 150);
+    stateMachine.reset();
+    EXPECT_TRUE(stateMachine.isIdle());
+    hold(false, 1000);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST_F(StateMachineTest, NoDeadlineWhileIdleOrWaitingForRelease)
+{
+    EXPECT_EQ(stateMachine.timeToDeadline(now, timings, enabledEvents), ButtonStateMachine::NO_DEADLINE);
+    hold(true, 1500);
+    EXPECT_EQ(events, std::vector<Event>({Event::LONG_PRESS}));
+    EXPECT_EQ(stateMachine.timeToDeadline(now, timings, enabledEvents), ButtonStateMachine::NO_DEADLINE);
+}
+
+TEST_F(StateMachineTest, LongPressDeadline)
+{
+    uint32_t pressTime = now;
+    hold(true, 300);
+    EXPECT_EQ(stateMachine.timeToDeadline(now, timings, enabledEvents), pressTime + timings.longPressTime - now);
+
+    now = pressTime + timings.longPressTime;
+    EXPECT_EQ(stateMachine.timeToDeadline(now, timings, enabledEvents), 0u);
+    EXPECT_EQ(stateMachine.update(now, true, timings, enabledEvents), Event::LONG_PRESS);
+}
+
+TEST_F(StateMachineTest, DoublePressWindowDeadline)
+{
+    hold(true, 150);
+    uint32_t releaseTime = now;
+    hold(false, 60);
+    uint32_t deadline = stateMachine.timeToDeadline(now, timings, enabledEvents);
+    EXPECT_EQ(deadline, releaseTime + timings.timeBetweenDoublePress + 1 - now);
+
+    // Sampling just before the deadline reports nothing, at the deadline the single press
+    EXPECT_EQ(stateMachine.update(now + deadline - 1, false, timings, enabledEvents), Event::NONE);
+    EXPECT_EQ(stateMachine.update(now + deadline, false, timings, enabledEvents), Event::SINGLE_PRESS);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "StaticButton.hpp"
+
+struct RecordingHandler
+{
+    std::vector<ButtonStateMachine::Event> *events;
+
+    void operator()(ButtonStateMachine::Event event) { events->push_back(event); }
+};
+
+struct FastTimings
+{
+    static constexpr uint16_t debounceTime = 10;
+    static constexpr uint16_t longPressTime = 300;
+    static constexpr uint16_t timeBetweenDoublePress = 100;
+};
+
+class StaticButtonTest : public ::testing::Test
+{
+protected:
+    std::vector<ButtonStateMachine::Event> events;
+    uint32_t now = 0;
+
+    template <typename Button>
+    void hold(Button &button, bool level, uint32_t duration)
+    {
+        for (uint32_t elapsed = 0; elapsed < duration; elapsed += 10, now += 10)
+            button.sample(now, level);
+    }
+};
+
+TEST_F(StaticButtonTest, DefaultTimingsMatchButtonModule)
+{
+    StaticButton<5, true, DefaultStaticButtonTimings, RecordingHandler> button(RecordingHandler{&events});
+
+    hold(button, true, 150);
+    hold(button, false, 150);
+    hold(button, true, 150);
+    hold(button, false, 600);
+    hold(button, true, 1100);
+    hold(button, false, 100);
+    EXPECT_EQ(events, std::vector<ButtonStateMachine::Event>({ButtonStateMachine::Event::DOUBLE_PRESS,
+                                                              ButtonStateMachine::Event::LONG_PRESS}));
+}
+
+TEST_F(StaticButtonTest, ActiveLowWithCustomTimings)
+{
+    StaticButton<14, false, FastTimings, RecordingHandler> button(RecordingHandler{&events});
+
+    hold(button, true, 500);
+    EXPECT_TRUE(events.empty());
+    hold(button, false, 350);
+    EXPECT_EQ(events, std::vector<ButtonStateMachine::Event>({ButtonStateMachine::Event::LONG_PRESS}));
+    hold(button, true, 200);
+    hold(button, false, 50);
+    hold(button, true, 200);
+    EXPECT_EQ(events.back(), ButtonStateMachine::Event::SINGLE_PRESS);
+}
+
+TEST_F(StaticButtonTest, OnlyEnabledEvents)
+{
+    StaticButton<5, true, FastTimings, RecordingHandler, ButtonStateMachine::SINGLE_PRESS_ENABLED>
+        button(RecordingHandler{&events});
+
+    hold(button, true, 500);
+    hold(button, false, 10);
+    EXPECT_EQ(events, std::vector<ButtonStateMachine::Event>({ButtonStateMachine::Event::SINGLE_PRESS}));
+}
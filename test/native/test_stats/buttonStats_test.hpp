@@ -0,0 +1,77 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "ButtonStats.hpp"
+
+TEST(ButtonStatsTest, CountsEvents)
+{
+    ButtonStats stats;
+    ButtonStatsSnapshot snapshot;
+
+    stats.addPoll();
+    stats.addPoll();
+    stats.addEdge();
+    stats.addBounceRejected();
+    stats.addEvent(ButtonStateMachine::Event::SINGLE_PRESS);
+    stats.addEvent(ButtonStateMachine::Event::LONG_PRESS);
+    stats.addEvent(ButtonStateMachine::Event::LONG_PRESS);
+    stats.getSnapshot(snapshot);
+
+    EXPECT_EQ(snapshot.polls, 2u);
+    EXPECT_EQ(snapshot.edges, 1u);
+    EXPECT_EQ(snapshot.bouncesRejected, 1u);
+    EXPECT_EQ(snapshot.singlePresses, 1u);
+    EXPECT_EQ(snapshot.doublePresses, 0u);
+    EXPECT_EQ(snapshot.longPresses, 2u);
+
+    stats.reset();
+    stats.getSnapshot(snapshot);
+    EXPECT_EQ(snapshot.polls, 0u);
+}
+
+TEST(ButtonStatsTest, DurationBuckets)
+{
+    ButtonStats stats;
+    ButtonStatsSnapshot snapshot;
+
+    stats.addPressDuration(0);
+    stats.addPressDuration(BUTTON_STATS_PRESS_BUCKET_MS - 1);
+    stats.addPressDuration(BUTTON_STATS_PRESS_BUCKET_MS);
+    stats.addPressDuration(BUTTON_STATS_PRESS_BUCKET_MS * 4 + 1);
+    stats.addPressDuration(UINT32_MAX);
+    stats.addCallbackDuration(BUTTON_STATS_CALLBACK_BUCKET_US * 2);
+    stats.getSnapshot(snapshot);
+
+    EXPECT_EQ(snapshot.pressDurations[0], 2u);
+    EXPECT_EQ(snapshot.pressDurations[1], 1u);
+    EXPECT_EQ(snapshot.pressDurations[3], 1u);
+    EXPECT_EQ(snapshot.pressDurations[BUTTON_STATS_BUCKETS - 1], 1u);
+    EXPECT_EQ(snapshot.callbackDurations[2], 1u);
+}
+
+TEST(ButtonStatsTest, SnapshotIsConsistentWhileUpdating)
+{
+    static ButtonStats stats;
+    uint32_t const count = 200000;
+
+    // Every poll is followed by an edge, so a consistent snapshot never has more edges than polls
+    std::thread writer([&]()
+                       {
+                           for (uint32_t i = 0; i < count; i++)
+                           {
+                               stats.addPoll();
+                               stats.addEdge();
+                           } });
+
+    ButtonStatsSnapshot snapshot;
+    do
+    {
+        if (!stats.getSnapshot(snapshot))
+            continue;
+        ASSERT_LE(snapshot.edges, snapshot.polls);
+        ASSERT_LE(snapshot.polls, snapshot.edges + 1);
+    } while (snapshot.edges < count);
+    writer.join();
+}
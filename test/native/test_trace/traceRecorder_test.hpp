@@ -0,0 +1,197 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "ButtonTrace.hpp"
+#include "ButtonTraceRecorder.hpp"
+#include "SimulatedButtonHal.hpp"
+#include "TraceReplay.hpp"
+
+// A record of a dump, with its absolute time and the level after it
+struct DecodedRecord
+{
+    uint64_t time;
+    ButtonTrace::Tag tag;
+    bool pressed;
+};
+
+inline std::vector<uint8_t> dumpRecorder(ButtonTraceRecorder &recorder)
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> *out = &bytes;
+    size_t written = recorder.dump([out](uint8_t const *data, size_t size)
+                                   { out->insert(out->end(), data, data + size); });
+    EXPECT_EQ(written, bytes.size());
+    return bytes;
+}
+
+inline std::vector<DecodedRecord> decodeDump(std::vector<uint8_t> const &bytes)
+{
+    std::vector<DecodedRecord> records;
+    EXPECT_TRUE(ButtonTrace::checkFileHeader(bytes.data(), bytes.size()));
+    ButtonTrace::BlockHeader header = ButtonTrace::readBlockHeader(&bytes[ButtonTrace::FILE_HEADER_SIZE]);
+    uint8_t const *data = &bytes[ButtonTrace::FILE_HEADER_SIZE + ButtonTrace::BLOCK_HEADER_SIZE];
+    uint8_t const *end = bytes.data() + bytes.size();
+    EXPECT_EQ(size_t(end - data), header.payloadBytes);
+
+    uint64_t time = header.startTime;
+    bool pressed = header.flags & ButtonTrace::INITIAL_PRESSED;
+    uint32_t delta;
+    ButtonTrace::Tag tag;
+    while (ButtonTrace::decodeRecord(data, end, delta, tag))
+    {
+        time += delta;
+        if (tag == ButtonTrace::EDGE)
+            pressed = !pressed;
+        records.push_back(DecodedRecord{time, tag, pressed});
+    }
+    EXPECT_EQ(data, end);
+    return records;
+}
+
+TEST(ButtonTraceRecorderTest, ReplaysToTheEventsOfTheButton)
+{
+    SimulatedButtonHal hal;
+    ButtonModule button(4, true, nullptr, &hal);
+    StaticButtonTraceRecorder<4096> recorder(4);
+    ButtonDiagnostics diagnostics;
+    diagnostics.traceRecorder = &recorder;
+    button.setDiagnostics(&diagnostics);
+    std::vector<ReplayEvent> events;
+    std::vector<ReplayEvent> *dispatched = &events;
+    SimulatedButtonHal *clock = &hal;
+    button.onSinglePress([dispatched, clock]()
+                         { dispatched->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::SINGLE_PRESS}); });
+    button.onDoublePress([dispatched, clock]()
+                         { dispatched->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::DOUBLE_PRESS}); });
+    button.onLongPress([dispatched, clock]()
+                       { dispatched->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::LONG_PRESS}); });
+    ButtonConfig config = button.getConfig();
+    config.timings.debounceTime = 60;
+    button.reconfigure(config);
+
+    std::mt19937 random(24);
+    std::vector<uint32_t> edges = randomEdges(random, 1000, 120000);
+    size_t next = 0;
+    for (uint32_t now = 0; now <= 125000; now += 30)
+    {
+        for (; next < edges.size() && edges[next] <= now; next++)
+            hal.setLevel(4, next % 2 == 0);
+        hal.setTime(now);
+        button.poll();
+    }
+    ASSERT_GT(events.size(), 20u);
+    EXPECT_EQ(recorder.getOverwrittenCount(), 0u);
+
+    std::vector<uint8_t> bytes = dumpRecorder(recorder);
+    EXPECT_EQ(bytes.size(), ButtonTrace::FILE_HEADER_SIZE + ButtonTrace::BLOCK_HEADER_SIZE + recorder.getSize());
+    TraceReplay replay;
+    ASSERT_TRUE(replay.addFile(bytes.data(), bytes.size()));
+    ReplayConfig replayConfig;
+    replayConfig.timings = config.timings;
+    std::vector<ReplayEvent> replayed;
+    TraceReplay::ButtonResult result;
+    replay.replayButton(0, replayConfig, replayed, result, 0);
+
+    // Replayed times count from the start of the block
+    ButtonTrace::BlockHeader header = ButtonTrace::readBlockHeader(&bytes[ButtonTrace::FILE_HEADER_SIZE]);
+    EXPECT_EQ(header.button, 4u);
+    for (ReplayEvent &event : replayed)
+        event.time += header.startTime;
+    EXPECT_EQ(replayed, events);
+    EXPECT_EQ(result.recorded[0] + result.recorded[1] + result.recorded[2], events.size());
+}
+
+TEST(ButtonTraceRecorderTest, KeepsTheNewestRecords)
+{
+    StaticButtonTraceRecorder<32> recorder(1);
+    std::vector<uint32_t> times;
+    for (uint32_t i = 0, time = 500; i < 100; i++, time += 7 + (i * 13) % 200)
+    {
+        recorder.recordEdge(time, i % 2 == 0);
+        times.push_back(time);
+    }
+    recorder.recordEvent(times.back() + 40, ButtonStateMachine::Event::DOUBLE_PRESS, false);
+    EXPECT_LE(recorder.getSize(), 32u);
+    EXPECT_GT(recorder.getOverwrittenCount(), 0u);
+
+    std::vector<DecodedRecord> records = decodeDump(dumpRecorder(recorder));
+    ASSERT_GT(records.size(), 10u);
+    EXPECT_EQ(records.back().tag, ButtonTrace::DOUBLE_PRESS);
+    EXPECT_EQ(records.back().time, times.back() + 40);
+    EXPECT_EQ(records.size() + recorder.getOverwrittenCount(), times.size() + 1);
+    // The edges left are the newest ones, with their times and levels
+    for (size_t i = 0; i + 1 < records.size(); i++)
+    {
+        size_t edge = times.size() - (records.size() - 1) + i;
+        EXPECT_EQ(records[i].tag, ButtonTrace::EDGE);
+        EXPECT_EQ(records[i].time, times[edge]);
+        EXPECT_EQ(records[i].pressed, edge % 2 == 0);
+    }
+}
+
+TEST(ButtonTraceRecorderTest, BridgesLongGaps)
+{
+    StaticButtonTraceRecorder<64> recorder;
+    recorder.recordEdge(100, true);
+    recorder.recordEdge(100 + 2000000000u, false);
+
+    std::vector<DecodedRecord> records = decodeDump(dumpRecorder(recorder));
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].time, 100u);
+    EXPECT_TRUE(records[0].pressed);
+    // A pair of edges at the same time leaves the level unchanged
+    EXPECT_EQ(records[1].time, records[2].time);
+    EXPECT_TRUE(records[2].pressed);
+    EXPECT_EQ(records[3].time, 100 + 2000000000u);
+    EXPECT_FALSE(records[3].pressed);
+}
+
+TEST(ButtonTraceRecorderTest, BridgesGapsOverHalfTheClock)
+{
+    StaticButtonTraceRecorder<64> recorder;
+    recorder.recordEdge(100, true);
+    recorder.recordEdge(100 + 3000000000u, false);
+
+    std::vector<DecodedRecord> records = decodeDump(dumpRecorder(recorder));
+    ASSERT_EQ(records.size(), 6u);
+    EXPECT_EQ(records[5].time, 100 + 3000000000u);
+    EXPECT_FALSE(records[5].pressed);
+}
+
+TEST(ButtonTraceRecorderTest, HeldEventIsNotOlderThanTheLastRecord)
+{
+    StaticButtonTraceRecorder<64> recorder;
+    recorder.recordEdge(100, true);
+    recorder.recordEdge(200, false);
+    recorder.recordEvent(150, ButtonStateMachine::Event::SINGLE_PRESS, false, true);
+
+    std::vector<DecodedRecord> records = decodeDump(dumpRecorder(recorder));
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[2].tag, ButtonTrace::SINGLE_PRESS);
+    EXPECT_EQ(records[2].time, 200u);
+}
+
+TEST(ButtonTraceRecorderTest, SkipsRecordsDuringADump)
+{
+    StaticButtonTraceRecorder<64> recorder;
+    recorder.recordEdge(10, true);
+
+    // The polling task records while the dump writes
+    ButtonTraceRecorder *polling = &recorder;
+    recorder.dump([polling](uint8_t const *, size_t)
+                  { polling->recordEdge(50, false); });
+    EXPECT_GT(recorder.getDroppedCount(), 0u);
+
+    // The next record restores the level the dump missed
+    recorder.recordEvent(80, ButtonStateMachine::Event::SINGLE_PRESS, false);
+    std::vector<DecodedRecord> records = decodeDump(dumpRecorder(recorder));
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[1].tag, ButtonTrace::EDGE);
+    EXPECT_EQ(records[1].time, 80u);
+    EXPECT_FALSE(records[1].pressed);
+    EXPECT_EQ(records[2].tag, ButtonTrace::SINGLE_PRESS);
+}
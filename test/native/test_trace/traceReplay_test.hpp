@@ -0,0 +1,218 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "ButtonModule.hpp"
+#include "ButtonTrace.hpp"
+#include "SimulatedButtonHal.hpp"
+#include "TraceReplay.hpp"
+
+// Builds a trace file in memory
+class TraceBuilder
+{
+public:
+    std::vector<uint8_t> bytes;
+
+    TraceBuilder() : bytes(ButtonTrace::FILE_HEADER_SIZE) { ButtonTrace::writeFileHeader(bytes.data()); }
+
+    // Edges at absolute times, then events, each list in time order
+    void addBlock(uint16_t button, uint32_t startTime, bool pressed, std::vector<uint32_t> const &edges,
+                  std::vector<std::pair<uint32_t, ButtonStateMachine::Event>> const &events = {})
+    {
+        std::vector<uint8_t> payload;
+        uint32_t last = startTime;
+        size_t e = 0;
+        for (size_t i = 0; i <= edges.size(); i++)
+        {
+            for (; e < events.size() && (i == edges.size() || events[e].first <= edges[i]); e++)
+                append(payload, events[e].first, last, ButtonTrace::eventTag(events[e].second));
+            if (i < edges.size())
+                append(payload, edges[i], last, ButtonTrace::EDGE);
+        }
+        size_t offset = bytes.size();
+        bytes.resize(offset + ButtonTrace::BLOCK_HEADER_SIZE);
+        ButtonTrace::writeBlockHeader({button, uint8_t(pressed ? ButtonTrace::INITIAL_PRESSED : 0), startTime, uint32_t(payload.size())},
+                                      &bytes[offset]);
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+    }
+
+private:
+    static void append(std::vector<uint8_t> &payload, uint32_t time, uint32_t &last, ButtonTrace::Tag tag)
+    {
+        uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+        payload.insert(payload.end(), record, record + ButtonTrace::encodeRecord(time - last, tag, record));
+        last = time;
+    }
+};
+
+// Random edges with bounces, short, double and long presses
+inline std::vector<uint32_t> randomEdges(std::mt19937 &random, uint32_t start, uint32_t end)
+{
+    std::uniform_int_distribution<uint32_t> length(1, 1500);
+    std::vector<uint32_t> edges;
+    for (uint32_t time = start + length(random); time < end; time += length(random))
+        edges.push_back(time);
+    return edges;
+}
+
+TEST(ButtonTraceTest, RecordsRoundTrip)
+{
+    uint32_t const deltas[] = {0, 1, 31, 32, 4095, 4096, 1000000, (uint32_t(1) << 30) - 1};
+    for (uint32_t delta : deltas)
+    {
+        for (uint8_t tag = 0; tag < 4; tag++)
+        {
+            uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+            uint8_t size = ButtonTrace::encodeRecord(delta, ButtonTrace::Tag(tag), record);
+            uint8_t const *data = record;
+            uint32_t decodedDelta;
+            ButtonTrace::Tag decodedTag;
+            ASSERT_TRUE(ButtonTrace::decodeRecord(data, record + size, decodedDelta, decodedTag));
+            EXPECT_EQ(decodedDelta, delta);
+            EXPECT_EQ(decodedTag, tag);
+            EXPECT_EQ(data, record + size);
+
+            // A truncated record is not decoded
+            data = record;
+            EXPECT_EQ(ButtonTrace::decodeRecord(data, record + size - 1, decodedDelta, decodedTag), false);
+        }
+    }
+    // Edges up to 31 ms apart take 1 byte, up to 8 s 2 bytes
+    uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+    EXPECT_EQ(ButtonTrace::encodeRecord(31, ButtonTrace::EDGE, record), 1);
+    EXPECT_EQ(ButtonTrace::encodeRecord(4095, ButtonTrace::EDGE, record), 2);
+}
+
+TEST(ButtonTraceTest, RejectsIncompleteFiles)
+{
+    TraceBuilder trace;
+    trace.addBlock(1, 0, false, {100, 200});
+    TraceReplay complete;
+    EXPECT_TRUE(complete.addFile(trace.bytes.data(), trace.bytes.size()));
+    EXPECT_EQ(complete.getButtonCount(), 1u);
+
+    TraceReplay truncated;
+    EXPECT_FALSE(truncated.addFile(trace.bytes.data(), trace.bytes.size() - 1));
+    trace.bytes[0] = 'X';
+    TraceReplay wrongMagic;
+    EXPECT_FALSE(wrongMagic.addFile(trace.bytes.data(), trace.bytes.size()));
+}
+
+// The replay must find the events a ButtonModule polling the same levels reports, at the same times
+class TraceReplayTest : public ::testing::TestWithParam<ButtonModuleInterface::DebounceMode>
+{
+protected:
+    struct Level
+    {
+        uint32_t time;
+        bool pressed;
+    };
+
+    std::vector<ReplayEvent> pollButtonModule(std::vector<Level> const &levels, ReplayConfig const &config, uint32_t end)
+    {
+        SimulatedButtonHal hal;
+        ButtonModule button(4, true, nullptr, &hal);
+        std::vector<ReplayEvent> events;
+        std::vector<ReplayEvent> *recorded = &events;
+        SimulatedButtonHal *clock = &hal;
+        button.onSinglePress([recorded, clock]()
+                             { recorded->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::SINGLE_PRESS}); });
+        button.onDoublePress([recorded, clock]()
+                             { recorded->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::DOUBLE_PRESS}); });
+        button.onLongPress([recorded, clock]()
+                           { recorded->push_back(ReplayEvent{clock->now(), ButtonStateMachine::Event::LONG_PRESS}); });
+        ButtonConfig buttonConfig = button.getConfig();
+        buttonConfig.timings = config.timings;
+        buttonConfig.checkInterval = config.checkInterval;
+        buttonConfig.debounceMode = config.debounceMode;
+        button.reconfigure(buttonConfig);
+
+        size_t next = 0;
+        for (uint32_t now = 0; now <= end; now += config.checkInterval)
+        {
+            for (; next < levels.size() && levels[next].time <= now; next++)
+                hal.setLevel(4, levels[next].pressed);
+            hal.setTime(now);
+            button.poll();
+        }
+        return events;
+    }
+};
+
+TEST_P(TraceReplayTest, SameEventsAsButtonModule)
+{
+    ReplayConfig config;
+    config.debounceMode = GetParam();
+    config.timings.debounceTime = 60;
+    std::mt19937 random(23);
+
+    // Two blocks, the second one starting pressed after a gap
+    std::vector<uint32_t> first = randomEdges(random, 0, 300000);
+    std::vector<uint32_t> second = randomEdges(random, 400000, 700000);
+    TraceBuilder trace;
+    trace.addBlock(7, 0, false, first, {{5000, ButtonStateMachine::Event::LONG_PRESS}});
+    trace.addBlock(7, 400000, true, second);
+
+    std::vector<Level> levels;
+    for (size_t i = 0; i < first.size(); i++)
+        levels.push_back(Level{first[i], i % 2 == 0});
+    levels.push_back(Level{400000, true});
+    for (size_t i = 0; i < second.size(); i++)
+        levels.push_back(Level{second[i], i % 2 == 1});
+
+    TraceReplay replay;
+    ASSERT_TRUE(replay.addFile(trace.bytes.data(), trace.bytes.size()));
+    std::vector<ReplayEvent> events;
+    TraceReplay::ButtonResult result;
+    replay.replayButton(0, config, events, result, 0);
+
+    std::vector<ReplayEvent> expected = pollButtonModule(levels, config, 710000);
+    ASSERT_GT(expected.size(), 100u);
+    EXPECT_EQ(events, expected);
+    EXPECT_EQ(result.edges, levels.size());
+    EXPECT_EQ(result.recorded[2], 1u);
+    // Most samples are skipped
+    EXPECT_LT(result.updates[0] * 2, result.samples[0]);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DebounceModes, TraceReplayTest,
+    ::testing::Values(ButtonModuleInterface::DebounceMode::TIMESTAMP, ButtonModuleInterface::DebounceMode::VERTICAL_COUNTER));
+
+TEST(TraceReplayRunTest, ComparesConfigurationsOnAnyNumberOfThreads)
+{
+    std::mt19937 random(5);
+    TraceBuilder trace;
+    for (uint32_t day = 0; day < 3; day++)
+        for (uint16_t button = 0; button < 20; button++)
+            trace.addBlock(button, day * 86400000u, false, randomEdges(random, day * 86400000u, day * 86400000u + 200000));
+    TraceReplay replay;
+    ASSERT_TRUE(replay.addFile(trace.bytes.data(), trace.bytes.size()));
+    ASSERT_EQ(replay.getButtonCount(), 20u);
+
+    ReplayConfig configs[2];
+    configs[1].timings.longPressTime = 700;
+    std::vector<TraceReplay::ButtonResult> single = replay.run(configs, 1, 1000);
+    std::vector<TraceReplay::ButtonResult> parallel = replay.run(configs, 4, 1000);
+
+    uint64_t unmatched = 0;
+    for (size_t i = 0; i < single.size(); i++)
+    {
+        EXPECT_EQ(parallel[i].button, single[i].button);
+        for (uint8_t slot = 0; slot < 2; slot++)
+            for (uint8_t event = 0; event < 3; event++)
+            {
+                EXPECT_EQ(parallel[i].counts[slot][event], single[i].counts[slot][event]);
+                EXPECT_EQ(parallel[i].unmatched[slot][event], single[i].unmatched[slot][event]);
+                unmatched += single[i].unmatched[slot][event];
+            }
+    }
+    // A shorter long press turns some single and double presses into long presses
+    EXPECT_GT(unmatched, 0u);
+
+    configs[1] = configs[0];
+    for (TraceReplay::ButtonResult const &result : replay.run(configs, 3, 0))
+        EXPECT_FALSE(result.differs);
+}
@@ -0,0 +1,411 @@
+#pragma once
+
+/**
+ * @file TraceReplay.hpp
+ * @brief Defines the TraceReplay class
+ * @details Host-only replay of recorded button traces through the ButtonModule classification
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <atomic>
+#include <fcntl.h>    // open
+#include <stdint.h>   // uint8_t, uint16_t, uint32_t, uint64_t
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <thread>
+#include <unistd.h> // close
+#include <unordered_map>
+#include <vector>
+
+#include "ButtonModuleInterface.hpp"
+#include "ButtonStateMachine.hpp"
+#include "ButtonTrace.hpp"
+#include "VerticalCounterDebouncer.hpp"
+
+/**
+ * @brief Detection parameters of one replay, as passed to ButtonModule::startListening().
+ */
+struct ReplayConfig
+{
+    ButtonTimings timings;                                                                             // Debounce, long press and double press timings
+    uint8_t checkInterval = 30;                                                                        // Milliseconds between two samples of the polling task
+    ButtonModuleInterface::DebounceMode debounceMode = ButtonModuleInterface::DebounceMode::TIMESTAMP; // How the raw level is debounced
+    uint8_t enabledEvents = 0x07;                                                                      // Mask of ButtonStateMachine::EnabledEvent bits
+};
+
+/**
+ * @brief An event found by a replay.
+ */
+struct ReplayEvent
+{
+    uint64_t time;                   // Time of the sample completing the event, in milliseconds since the first block of the button
+    ButtonStateMachine::Event event; // The event
+
+    bool operator==(ReplayEvent const &other) const { return time == other.time && event == other.event; }
+    bool operator!=(ReplayEvent const &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Read-only memory map of a trace file.
+ */
+class TraceFile
+{
+private:
+    uint8_t const *_data = nullptr; // Mapped content, nullptr if the file could not be mapped
+    size_t _size = 0;               // Bytes mapped
+
+public:
+    /**
+     * @brief Maps a file.
+     *
+     * @param path Path of the file.
+     */
+    explicit TraceFile(char const *path)
+    {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                _data = static_cast<uint8_t const *>(data);
+                _size = size_t(info.st_size);
+                // Records are read once, front to back
+                madvise(data, _size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+
+    ~TraceFile()
+    {
+        if (_data != nullptr)
+            munmap(const_cast<uint8_t *>(_data), _size);
+    }
+
+    TraceFile(TraceFile const &) = delete;
+    TraceFile &operator=(TraceFile const &) = delete;
+
+    uint8_t const *data() const { return _data; }
+    size_t size() const { return _size; }
+};
+
+/**
+ * @brief Replays the blocks of trace files button by button, on several threads.
+ *
+ * @details The blocks of every button are collected across files in order, and the buttons
+ * are shared by the worker threads, so one button always runs on one thread in time order.
+ * Each button is replayed like a ButtonModule polling its pin every check interval: the raw
+ * level is read at every sample, filtered for DebounceMode::VERTICAL_COUNTER, and fed to the
+ * ButtonStateMachine the device runs. Samples that cannot change anything, because the level
+ * is steady and no deadline of the state machine falls before them, are skipped; the events
+ * and their times are the same as with every sample fed.
+ */
+class TraceReplay
+{
+public:
+    /**
+     * @brief Replay of one button with two configurations.
+     */
+    struct ButtonResult
+    {
+        uint16_t button = 0;                 // The button
+        uint64_t edges = 0;                  // Raw edges in the trace
+        uint64_t samples[2] = {};            // Samples covered by the replay with each configuration
+        uint64_t updates[2] = {};            // Samples actually fed to the state machine
+        uint64_t counts[2][3] = {};          // Single, double and long presses with each configuration
+        uint64_t recorded[3] = {};           // Single, double and long presses reported by the device
+        uint64_t unmatched[2][3] = {};       // Single, double and long presses of each configuration not found in the other
+        ReplayEvent firstDifference[2] = {}; // First unmatched event of each configuration, Event::NONE if there is none
+        bool differs = false;                // The event lists differ
+    };
+
+private:
+    /**
+     * @brief The blocks of one button.
+     */
+    struct Stream
+    {
+        uint16_t button;                     // The button
+        std::vector<uint8_t const *> blocks; // Block headers, in time order
+    };
+
+    std::vector<Stream> _streams;                // Every button seen
+    std::unordered_map<uint16_t, size_t> _index; // Stream of every button
+    uint64_t _bytes = 0;                         // Bytes of blocks added
+
+    /**
+     * @brief Cursor over the raw level changes of a stream.
+     */
+    class EdgeCursor
+    {
+    private:
+        Stream const &_stream;            // Stream read
+        size_t _block = 0;                // Next block to open
+        uint8_t const *_record = nullptr; // Next record of the current block
+        uint8_t const *_end = nullptr;    // End of the current block
+        uint64_t _time = 0;               // Time of the previous record
+        uint64_t _origin = 0;             // Start time of the current block, since the first block start
+        uint32_t _lastStart = 0;          // Start time of the current block as recorded
+        bool _level = false;              // Level after the previous record
+        uint64_t *_recorded;              // Device events counted while reading
+
+    public:
+        EdgeCursor(Stream const &stream, uint64_t *recorded) : _stream(stream), _recorded(recorded) {}
+
+        /**
+         * @brief Gets the next level change.
+         *
+         * @param time Time of the change, in milliseconds since the first block start.
+         * @param level Level after the change.
+         * @return true if there is one, false at the end of the stream.
+         */
+        bool next(uint64_t &time, bool &level)
+        {
+            while (true)
+            {
+                uint32_t delta;
+                ButtonTrace::Tag tag;
+                while (_record != nullptr && ButtonTrace::decodeRecord(_record, _end, delta, tag))
+                {
+                    _time += delta;
+                    if (tag != ButtonTrace::EDGE)
+                    {
+                        _recorded[tag - 1]++;
+                        continue;
+                    }
+                    _level = !_level;
+                    time = _time;
+                    level = _level;
+                    return true;
+                }
+                if (_block == _stream.blocks.size())
+                    return false;
+
+                // Block start times wrap like millis(), blocks of a button are in time order
+                ButtonTrace::BlockHeader header = ButtonTrace::readBlockHeader(_stream.blocks[_block]);
+                if (_block > 0)
+                    _origin += uint32_t(header.startTime - _lastStart);
+                _time = _origin;
+                _lastStart = header.startTime;
+                _record = _stream.blocks[_block] + ButtonTrace::BLOCK_HEADER_SIZE;
+                _end = _record + header.payloadBytes;
+                _block++;
+
+                // A block starting at another level than the previous one ended with is an edge
+                bool initial = header.flags & ButtonTrace::INITIAL_PRESSED;
+                if (initial != _level)
+                {
+                    _level = initial;
+                    time = _time;
+                    level = _level;
+                    return true;
+                }
+            }
+        }
+    };
+
+public:
+    /**
+     * @brief Adds the blocks of a mapped trace file.
+     *
+     * @param data Content of the file.
+     * @param size Bytes of the file.
+     * @return true if the file is a trace and every block is complete, false otherwise.
+     */
+    bool addFile(uint8_t const *data, size_t size)
+    {
+        if (!ButtonTrace::checkFileHeader(data, size))
+            return false;
+        size_t offset = ButtonTrace::FILE_HEADER_SIZE;
+        while (offset + ButtonTrace::BLOCK_HEADER_SIZE <= size)
+        {
+            ButtonTrace::BlockHeader header = ButtonTrace::readBlockHeader(data + offset);
+            if (header.payloadBytes > size - offset - ButtonTrace::BLOCK_HEADER_SIZE)
+                return false;
+            auto found = _index.find(header.button);
+            if (found == _index.end())
+            {
+                found = _index.emplace(header.button, _streams.size()).first;
+                _streams.push_back(Stream{header.button, {}});
+            }
+            _streams[found->second].blocks.push_back(data + offset);
+            offset += ButtonTrace::BLOCK_HEADER_SIZE + header.payloadBytes;
+        }
+        _bytes += size;
+        return offset == size;
+    }
+
+    /**
+     * @brief Gets the number of buttons.
+     *
+     * @return The number of buttons with at least one block.
+     */
+    size_t getButtonCount() const { return _streams.size(); }
+
+    /**
+     * @brief Gets the bytes of the files added.
+     *
+     * @return The bytes.
+     */
+    uint64_t getBytes() const { return _bytes; }
+
+    /**
+     * @brief Replays one button with one configuration.
+     *
+     * @param stream Index of the button, below getButtonCount().
+     * @param config The configuration.
+     * @param events Receives the events found.
+     * @param result Receives the edges, samples, updates and recorded events.
+     * @param slot 0 or 1, the configuration slot of the result.
+     */
+    void replayButton(size_t stream, ReplayConfig const &config, std::vector<ReplayEvent> &events, ButtonResult &result, uint8_t slot) const
+    {
+        uint64_t recorded[3] = {};
+        EdgeCursor cursor(_streams[stream], recorded);
+        ButtonStateMachine stateMachine;
+        bool counter = config.debounceMode == ButtonModuleInterface::DebounceMode::VERTICAL_COUNTER;
+        uint32_t const interval = config.checkInterval > 0 ? config.checkInterval : 1;
+        VerticalCounterDebouncer<uint8_t> filter;
+        // Enough consecutive samples to cover the debounce time, like ButtonModule
+        filter.setSamples((config.timings.debounceTime + interval - 1) / interval);
+
+        uint64_t const NEVER = ~uint64_t(0);
+        uint64_t edgeTime = 0;
+        bool edgeLevel = false;
+        uint64_t nextEdge = cursor.next(edgeTime, edgeLevel) ? edgeTime : NEVER;
+        bool level = false;
+        uint64_t edges = 0;
+        uint64_t now = 0;
+
+        while (true)
+        {
+            // Apply the edges up to this sample
+            while (nextEdge <= now)
+            {
+                level = edgeLevel;
+                edges++;
+                nextEdge = cursor.next(edgeTime, edgeLevel) ? edgeTime : NEVER;
+            }
+
+            bool pressed = level;
+            if (counter)
+            {
+                filter.update(level);
+                pressed = filter.state() != 0;
+            }
+            result.updates[slot]++;
+            ButtonStateMachine::Event event = stateMachine.update(uint32_t(now), pressed, config.timings, config.enabledEvents);
+            if (event != ButtonStateMachine::Event::NONE)
+                events.push_back(ReplayEvent{now, event});
+
+            // The next sample that may change anything: the filter is still counting, a deadline, or an edge
+            uint64_t next = NEVER;
+            if (counter && level != pressed)
+                next = now + interval;
+            else
+            {
+                uint32_t deadline = stateMachine.timeToDeadline(uint32_t(now), config.timings, config.enabledEvents);
+                if (deadline != ButtonStateMachine::NO_DEADLINE)
+                    next = now + (deadline == 0 ? interval : (deadline + interval - 1) / interval * interval);
+            }
+            if (nextEdge != NEVER)
+            {
+                uint64_t edgeSample = (nextEdge + interval - 1) / interval * interval;
+                if (edgeSample < next)
+                    next = edgeSample;
+            }
+            if (next == NEVER)
+            {
+                result.samples[slot] = now / interval + 1;
+                break;
+            }
+            now = next;
+        }
+        result.edges = edges;
+        for (uint8_t i = 0; i < 3; i++)
+            result.recorded[i] = recorded[i];
+    }
+
+    /**
+     * @brief Replays every button with two configurations and compares their events.
+     *
+     * @details Events of the two configurations match when they are of the same kind and at
+     * most tolerance apart, since new thresholds shift the time an event completes.
+     *
+     * @param configs The two configurations.
+     * @param threads Number of worker threads, at least 1.
+     * @param tolerance Milliseconds between matching events.
+     * @return The result of every button, in the order buttons were first seen.
+     */
+    std::vector<ButtonResult> run(ReplayConfig const configs[2], unsigned threads, uint32_t tolerance) const
+    {
+        std::vector<ButtonResult> results(_streams.size());
+        std::atomic<size_t> nextStream{0};
+
+        auto worker = [&]()
+        {
+            std::vector<ReplayEvent> events[2];
+            for (size_t stream = nextStream++; stream < _streams.size(); stream = nextStream++)
+            {
+                ButtonResult &result = results[stream];
+                result.button = _streams[stream].button;
+                for (uint8_t slot = 0; slot < 2; slot++)
+                {
+                    events[slot].clear();
+                    replayButton(stream, configs[slot], events[slot], result, slot);
+                    for (ReplayEvent const &event : events[slot])
+                        result.counts[slot][uint8_t(event.event) - 1]++;
+                }
+                compare(events, tolerance, result);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; i++)
+            workers.emplace_back(worker);
+        worker();
+        for (std::thread &thread : workers)
+            thread.join();
+        return results;
+    }
+
+private:
+    static void compare(std::vector<ReplayEvent> const events[2], uint32_t tolerance, ButtonResult &result)
+    {
+        // Both lists in time order, an event that does not match the head of the other list is unmatched
+        size_t next[2] = {0, 0};
+        while (next[0] < events[0].size() || next[1] < events[1].size())
+        {
+            if (next[0] < events[0].size() && next[1] < events[1].size())
+            {
+                ReplayEvent const &a = events[0][next[0]];
+                ReplayEvent const &b = events[1][next[1]];
+                uint64_t distance = a.time > b.time ? a.time - b.time : b.time - a.time;
+                if (a.event == b.event && distance <= tolerance)
+                {
+                    next[0]++;
+                    next[1]++;
+                    continue;
+                }
+            }
+            uint8_t slot = next[1] == events[1].size() ||
+                                   (next[0] < events[0].size() && events[0][next[0]].time <= events[1][next[1]].time)
+                               ? 0
+                               : 1;
+            ReplayEvent const &event = events[slot][next[slot]++];
+            if (!result.differs)
+            {
+                result.differs = true;
+                result.firstDifference[slot] = event;
+            }
+            else if (result.firstDifference[slot].event == ButtonStateMachine::Event::NONE)
+                result.firstDifference[slot] = event;
+            result.unmatched[slot][uint8_t(event.event) - 1]++;
+        }
+    }
+};
@@ -0,0 +1,297 @@
+/**
+ * @file main.cpp
+ * @brief Trace replay tool
+ * @details Replays recorded button traces with two configurations and reports their differences.
+ * Build and run with `pio run -e native_replay -t exec -a "<arguments>"`, see usage().
+ * @author Ronny Antoon
+ * @copyright MetaHouse LTD.
+ */
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TraceReplay.hpp"
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: replay [--a CONFIG] [--b CONFIG] [--threads N] [--tolerance MS] [--diffs N] TRACE...\n"
+            "       replay --print TRACE...\n"
+            "       replay --synthesize TRACE [--buttons N] [--hours N] [--seed N]\n"
+            "\n"
+            "CONFIG is debounce,longPress,doublePress[,checkInterval[,counter]] in milliseconds,\n"
+            "90,1000,500,30 by default; counter selects DebounceMode::VERTICAL_COUNTER.\n"
+            "Events of a and b of the same kind at most MS apart match, by default the longest\n"
+            "long press or double press time plus two check intervals. --print lists the records.\n");
+}
+
+static bool parseConfig(char const *text, ReplayConfig &config)
+{
+    unsigned values[4] = {config.timings.debounceTime, config.timings.longPressTime,
+                          config.timings.timeBetweenDoublePress, config.checkInterval};
+    char mode[16] = "";
+    int fields = sscanf(text, "%u,%u,%u,%u,%15s", &values[0], &values[1], &values[2], &values[3], mode);
+    if (fields < 3 || values[0] > 0xFFFF || values[1] > 0xFFFF || values[2] > 0xFFFF || values[3] == 0 || values[3] > 0xFF)
+        return false;
+    config.timings.debounceTime = values[0];
+    config.timings.longPressTime = values[1];
+    config.timings.timeBetweenDoublePress = values[2];
+    config.checkInterval = values[3];
+    if (fields == 5 && strcmp(mode, "counter") != 0)
+        return false;
+    config.debounceMode = fields == 5 ? ButtonModuleInterface::DebounceMode::VERTICAL_COUNTER
+                                      : ButtonModuleInterface::DebounceMode::TIMESTAMP;
+    return true;
+}
+
+// Presses of every kind with contact bounce, and long idle periods, one block per button and hour
+static int synthesize(char const *path, unsigned buttons, unsigned hours, unsigned seed)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    uint8_t header[ButtonTrace::FILE_HEADER_SIZE];
+    ButtonTrace::writeFileHeader(header);
+    fwrite(header, 1, sizeof(header), file);
+
+    std::mt19937 random(seed);
+    std::vector<uint8_t> payload;
+    uint64_t edges = 0;
+    for (unsigned hour = 0; hour < hours; hour++)
+    {
+        for (unsigned button = 0; button < buttons; button++)
+        {
+            payload.clear();
+            uint32_t time = 0;
+            uint32_t last = 0;
+            auto edge = [&](uint32_t at)
+            {
+                uint8_t record[ButtonTrace::MAX_RECORD_SIZE];
+                payload.insert(payload.end(), record, record + ButtonTrace::encodeRecord(at - last, ButtonTrace::EDGE, record));
+                last = at;
+                edges++;
+            };
+            while (true)
+            {
+                time += std::uniform_int_distribution<uint32_t>(2000, 120000)(random);
+                uint32_t taps = std::uniform_int_distribution<uint32_t>(1, 3)(random);
+                uint32_t hold = std::uniform_int_distribution<uint32_t>(0, 3)(random) == 0 ? 1500 : 120;
+                if (time + taps * 2000 + hold >= 3600000)
+                    break;
+                for (uint32_t tap = 0; tap < taps; tap++)
+                {
+                    // Contact bounce on press and release
+                    for (uint32_t bounce = std::uniform_int_distribution<uint32_t>(0, 3)(random); bounce > 0; bounce--)
+                    {
+                        edge(time);
+                        edge(time + 1);
+                        time += 2;
+                    }
+                    edge(time);
+                    time += std::uniform_int_distribution<uint32_t>(hold - hold / 4, hold + hold / 4)(random);
+                    edge(time);
+                    time += std::uniform_int_distribution<uint32_t>(150, 450)(random);
+                }
+            }
+            uint8_t block[ButtonTrace::BLOCK_HEADER_SIZE];
+            ButtonTrace::writeBlockHeader({uint16_t(button), 0, hour * 3600000, uint32_t(payload.size())}, block);
+            fwrite(block, 1, sizeof(block), file);
+            fwrite(payload.data(), 1, payload.size(), file);
+        }
+    }
+    fclose(file);
+    printf("%s: %u buttons, %u hours, %llu edges\n", path, buttons, hours, (unsigned long long)edges);
+    return 0;
+}
+
+static char const *eventName(ButtonStateMachine::Event event)
+{
+    static char const *const names[] = {"none", "single", "double", "long"};
+    return names[uint8_t(event)];
+}
+
+// One line per record, e.g. of a ButtonTraceRecorder dump
+static bool print(char const *path, uint8_t const *data, size_t size)
+{
+    if (!ButtonTrace::checkFileHeader(data, size))
+        return false;
+    size_t offset = ButtonTrace::FILE_HEADER_SIZE;
+    while (offset < size)
+    {
+        if (size - offset < ButtonTrace::BLOCK_HEADER_SIZE)
+            return false;
+        ButtonTrace::BlockHeader header = ButtonTrace::readBlockHeader(data + offset);
+        offset += ButtonTrace::BLOCK_HEADER_SIZE;
+        if (size - offset < header.payloadBytes)
+            return false;
+        bool pressed = header.flags & ButtonTrace::INITIAL_PRESSED;
+        printf("%s: button %u from %lu ms, %s, %lu bytes\n", path, header.button, (unsigned long)header.startTime,
+               pressed ? "pressed" : "released", (unsigned long)header.payloadBytes);
+
+        uint8_t const *record = data + offset;
+        uint8_t const *end = record + header.payloadBytes;
+        uint64_t time = header.startTime;
+        uint32_t delta;
+        ButtonTrace::Tag tag;
+        while (ButtonTrace::decodeRecord(record, end, delta, tag))
+        {
+            time += delta;
+            if (tag == ButtonTrace::EDGE)
+                pressed = !pressed;
+            printf("%12llu %10lu  %s\n", (unsigned long long)time, (unsigned long)delta,
+                   tag != ButtonTrace::EDGE ? eventName(ButtonTrace::tagEvent(tag)) : pressed ? "pressed" : "released");
+        }
+        if (record != end)
+            return false;
+        offset += header.payloadBytes;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    ReplayConfig configs[2];
+    bool compare = false;
+    bool printRecords = false;
+    unsigned threads = std::thread::hardware_concurrency();
+    unsigned diffs = 10;
+    int tolerance = -1;
+    char const *synthesizePath = nullptr;
+    unsigned buttons = 16;
+    unsigned hours = 24;
+    unsigned seed = 1;
+    std::vector<char const *> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--a") == 0 && hasValue && parseConfig(argv[i + 1], configs[0]))
+            i++;
+        else if (strcmp(argv[i], "--b") == 0 && hasValue && parseConfig(argv[i + 1], configs[1]))
+            compare = true, i++;
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue)
+            tolerance = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--diffs") == 0 && hasValue)
+            diffs = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--print") == 0)
+            printRecords = true;
+        else if (strcmp(argv[i], "--synthesize") == 0 && hasValue)
+            synthesizePath = argv[++i];
+        else if (strcmp(argv[i], "--buttons") == 0 && hasValue)
+            buttons = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--hours") == 0 && hasValue)
+            hours = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+            seed = strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-')
+            paths.push_back(argv[i]);
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (synthesizePath != nullptr)
+        return synthesize(synthesizePath, buttons, hours, seed);
+    if (paths.empty())
+    {
+        usage();
+        return 2;
+    }
+    if (!compare)
+        configs[1] = configs[0];
+    if (tolerance < 0)
+    {
+        for (ReplayConfig const &config : configs)
+        {
+            int longest = config.timings.longPressTime > config.timings.timeBetweenDoublePress ? config.timings.longPressTime
+                                                                                               : config.timings.timeBetweenDoublePress;
+            if (longest + 2 * config.checkInterval > tolerance)
+                tolerance = longest + 2 * config.checkInterval;
+        }
+    }
+
+    // The files stay mapped while the replay reads them
+    std::vector<std::unique_ptr<TraceFile>> files;
+    TraceReplay replay;
+    for (char const *path : paths)
+    {
+        files.emplace_back(new TraceFile(path));
+        if (printRecords && files.back()->data() != nullptr && print(path, files.back()->data(), files.back()->size()))
+            continue;
+        if (printRecords || files.back()->data() == nullptr || !replay.addFile(files.back()->data(), files.back()->size()))
+        {
+            fprintf(stderr, "%s: not a complete trace file\n", path);
+            return 1;
+        }
+    }
+
+    if (printRecords)
+        return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TraceReplay::ButtonResult> results = replay.run(configs, threads > 0 ? threads : 1, tolerance);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t edges = 0;
+    uint64_t samples = 0;
+    uint64_t updates = 0;
+    uint64_t counts[2][3] = {};
+    uint64_t recorded[3] = {};
+    uint64_t unmatched[2][3] = {};
+    size_t differing = 0;
+    for (TraceReplay::ButtonResult const &result : results)
+    {
+        edges += result.edges;
+        samples += result.samples[0] + (compare ? result.samples[1] : 0);
+        updates += result.updates[0] + (compare ? result.updates[1] : 0);
+        for (uint8_t event = 0; event < 3; event++)
+        {
+            counts[0][event] += result.counts[0][event];
+            counts[1][event] += result.counts[1][event];
+            recorded[event] += result.recorded[event];
+            unmatched[0][event] += result.unmatched[0][event];
+            unmatched[1][event] += result.unmatched[1][event];
+        }
+        differing += result.differs;
+    }
+
+    printf("%zu buttons, %llu edges, %.1f MB in %.3f s on %u threads\n", results.size(), (unsigned long long)edges,
+           replay.getBytes() / 1e6, seconds, threads);
+    printf("%llu samples (%.0f Msample/s), %llu fed to the state machine\n", (unsigned long long)samples,
+           samples / seconds / 1e6, (unsigned long long)updates);
+    printf("\n%-12s %12s %12s %12s\n", "", "single", "double", "long");
+    if (recorded[0] + recorded[1] + recorded[2] > 0)
+        printf("%-12s %12llu %12llu %12llu\n", "recorded", (unsigned long long)recorded[0],
+               (unsigned long long)recorded[1], (unsigned long long)recorded[2]);
+    for (uint8_t slot = 0; slot < (compare ? 2 : 1); slot++)
+        printf("%-12s %12llu %12llu %12llu\n", slot == 0 ? "a" : "b", (unsigned long long)counts[slot][0],
+               (unsigned long long)counts[slot][1], (unsigned long long)counts[slot][2]);
+    if (!compare)
+        return 0;
+
+    for (uint8_t slot = 0; slot < 2; slot++)
+        printf("%-12s %12llu %12llu %12llu\n", slot == 0 ? "a only" : "b only", (unsigned long long)unmatched[slot][0],
+               (unsigned long long)unmatched[slot][1], (unsigned long long)unmatched[slot][2]);
+
+    printf("\n%zu of %zu buttons differ, events matched within %d ms\n", differing, results.size(), tolerance);
+    for (TraceReplay::ButtonResult const &result : results)
+    {
+        if (!result.differs || diffs == 0)
+            continue;
+        diffs--;
+        printf("button %u: first a only %s at %llu ms, b only %s at %llu ms\n", result.button,
+               eventName(result.firstDifference[0].event), (unsigned long long)result.firstDifference[0].time,
+               eventName(result.firstDifference[1].event), (unsigned long long)result.firstDifference[1].time);
+    }
+    return 0;
+}